@@ -0,0 +1,95 @@
+# QCalc - Extensible programming calculator
+# Copyright (C) 2023  Julian Zampiccoli
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+# You should have received a copy of the GNU General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+# Measures the cost of obtaining the code objects of the python system libraries and bundled addons
+# with and without precompiled bytecode.
+#
+# The code objects are loaded through the import system loader without executing the modules,
+# so the measurement does not require PySide2 or the native qcalc modules.
+# Run with the interpreter which qcalculator links against:
+#
+#   python3 bench/bytecode.py [iterations]
+
+import importlib.machinery
+import importlib.util
+import os
+import py_compile
+import shutil
+import sys
+import tempfile
+import time
+
+root = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "python")
+
+def collect_sources(directory):
+    ret = []
+    for base, dirs, files in os.walk(directory):
+        dirs[:] = [d for d in dirs if d != "__pycache__"]
+        for f in files:
+            if f.endswith(".py"):
+                ret.append(os.path.join(base, f))
+    return sorted(ret)
+
+def get_code_all(sources):
+    for source in sources:
+        name = os.path.splitext(os.path.basename(source))[0]
+        importlib.machinery.SourceFileLoader(name, source).get_code(name)
+
+def remove_bytecode(sources):
+    for source in sources:
+        cache = importlib.util.cache_from_source(source)
+        if os.path.exists(cache):
+            os.remove(cache)
+
+def measure(sources, iterations, mode):
+    best = None
+    for _ in range(iterations):
+        remove_bytecode(sources)
+        if mode is not None:
+            for source in sources:
+                py_compile.compile(source, invalidation_mode=mode, doraise=True)
+        # Disable writing so that the uncached run compiles every iteration
+        sys.dont_write_bytecode = True
+        begin = time.perf_counter()
+        get_code_all(sources)
+        elapsed = time.perf_counter() - begin
+        sys.dont_write_bytecode = False
+        best = elapsed if best is None else min(best, elapsed)
+    return best
+
+def main():
+    iterations = int(sys.argv[1]) if len(sys.argv) > 1 else 20
+
+    work = tempfile.mkdtemp()
+    try:
+        for d in ("lib", "addon"):
+            shutil.copytree(os.path.join(root, d), os.path.join(work, d),
+                            ignore=shutil.ignore_patterns("__pycache__"))
+        sources = collect_sources(work)
+
+        print("python " + sys.version.split()[0] + ", " + str(len(sources)) + " files, best of " + str(iterations))
+        modes = [("source only", None),
+                 ("timestamp", py_compile.PycInvalidationMode.TIMESTAMP),
+                 ("checked-hash", py_compile.PycInvalidationMode.CHECKED_HASH),
+                 ("unchecked-hash", py_compile.PycInvalidationMode.UNCHECKED_HASH)]
+        for label, mode in modes:
+            print("%-16s %8.3f ms" % (label, measure(sources, iterations, mode) * 1000))
+    finally:
+        shutil.rmtree(work)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,104 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/**
+ * Measures Archive::save of a tar with each compression filter,
+ * once for incompressible data and once for repetitive text.
+ *
+ * Usage: bench_compression [directory] [megabytes]
+ *
+ * The input files and archives are written to the directory, which defaults to the working directory.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+
+#include "io/archive.hpp"
+
+static const char *COMPRESSION_NAMES[] = {"tar", "gzip", "bzip2", "xz", "zstd"};
+
+static double millisecondsSince(const std::chrono::steady_clock::time_point &start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void writeInput(const std::filesystem::path &path, size_t size, bool random) {
+    std::string data;
+    data.reserve(size);
+    if (random) {
+        std::mt19937_64 generator(42);
+        while (data.size() < size) {
+            uint64_t value = generator();
+            data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+    } else {
+        for (size_t line = 0; data.size() < size; line++) {
+            data += "result_" + std::to_string(line) + " = " + std::to_string(line * 7 % 1000) + "\n";
+        }
+    }
+    data.resize(size);
+
+    std::ofstream stream(path, std::ios::binary);
+    stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!stream) {
+        throw std::runtime_error("Failed to write " + path.string());
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::filesystem::path directory = argc > 1 ? argv[1] : ".";
+    size_t size = (argc > 2 ? std::stoul(argv[2]) : 3) * 1024 * 1024;
+
+    try {
+        for (bool random: {true, false}) {
+            auto input = directory / (random ? "bench_random.bin" : "bench_text.txt");
+            writeInput(input, size, random);
+            printf("%s, %zu bytes\n", random ? "incompressible data" : "repetitive text", size);
+
+            for (int compression = Archive::COMPRESSION_NONE; compression <= Archive::COMPRESSION_ZSTD; compression++) {
+                Archive::CompressionOptions options;
+                options.compression = static_cast<Archive::Compression>(compression);
+
+                auto output = directory / "bench_archive.tar";
+                Archive archive;
+                archive.addFile(input.filename().string(), input.string());
+
+                auto start = std::chrono::steady_clock::now();
+                archive.save(output.string(), Archive::ARCHIVE_FORMAT_TAR_PAX_RESTRICTED, options);
+                double elapsed = millisecondsSince(start);
+
+                printf("%8s %10.1f ms %12ju bytes\n",
+                       COMPRESSION_NAMES[compression],
+                       elapsed,
+                       static_cast<uintmax_t>(std::filesystem::file_size(output)));
+                std::filesystem::remove(output);
+            }
+            std::filesystem::remove(input);
+        }
+    } catch (const std::exception &e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/**
+ * Measures the conversion of decimals to python decimal.Decimal objects and back,
+ * with DecimalUtil and with the scientific string representation that was used before.
+ *
+ * Usage: bench_decimalutil [values]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "python/pythoninclude.hpp"
+#include "python/interpreter.hpp"
+#include "python/decimalutil.hpp"
+
+static double millisecondsSince(const std::chrono::steady_clock::time_point &start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// DecimalUtil only needs the error message, which avoids linking the interpreter and its native modules.
+std::string Interpreter::getError() {
+    PyObject *type, *value, *traceback;
+    PyErr_Fetch(&type, &value, &traceback);
+    std::string ret = "Unknown error";
+    if (value != NULL) {
+        PyObject *str = PyObject_Str(value);
+        if (str != NULL) {
+            ret = PyUnicode_AsUTF8(str);
+            Py_DECREF(str);
+        }
+    }
+    Py_XDECREF(type);
+    Py_XDECREF(value);
+    Py_XDECREF(traceback);
+    return ret;
+}
+
+static PyObject *newFromString(PyObject *type, const decimal::Decimal &value) {
+    PyObject *ret = PyObject_CallFunction(type, "s", value.to_sci().c_str());
+    if (ret == NULL)
+        throw std::runtime_error(Interpreter::getError());
+    return ret;
+}
+
+static decimal::Decimal convertFromString(PyObject *o) {
+    PyObject *str = PyObject_Str(o);
+    if (str == NULL)
+        throw std::runtime_error(Interpreter::getError());
+    decimal::Decimal ret(PyUnicode_AsUTF8(str));
+    Py_DECREF(str);
+    return ret;
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 200000;
+
+    std::vector<decimal::Decimal> values;
+    for (size_t i = 0; i < count; i++) {
+        auto digits = std::to_string(i);
+        values.emplace_back(decimal::Decimal::exact("-" + digits + ".1234567890123" + digits, decimal::context));
+    }
+
+    Py_Initialize();
+
+    int ret = 0;
+    try {
+        PyObject *module = PyImport_ImportModule("decimal");
+        if (module == NULL)
+            throw std::runtime_error(Interpreter::getError());
+        PyObject *type = PyObject_GetAttrString(module, "Decimal");
+        Py_DECREF(module);
+
+        printf("python %s, %zu values\n", PY_VERSION, count);
+
+        std::vector<PyObject *> objects(count);
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++) {
+            objects[i] = newFromString(type, values[i]);
+        }
+        double newString = millisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++) {
+            if (convertFromString(objects[i]) != values[i])
+                throw std::runtime_error("The string conversion changed a value");
+        }
+        double convertString = millisecondsSince(start);
+
+        for (auto *object: objects) {
+            Py_DECREF(object);
+        }
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++) {
+            objects[i] = DecimalUtil::New(values[i]);
+        }
+        double newNative = millisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++) {
+            if (DecimalUtil::Convert(objects[i]) != values[i])
+                throw std::runtime_error("DecimalUtil changed a value");
+        }
+        double convertNative = millisecondsSince(start);
+
+        // The objects created by DecimalUtil must also be equal for python
+        for (size_t i = 0; i < count; i++) {
+            PyObject *expected = newFromString(type, values[i]);
+            int equal = PyObject_RichCompareBool(objects[i], expected, Py_EQ);
+            Py_DECREF(expected);
+            if (equal != 1)
+                throw std::runtime_error("Python compares a converted value as different");
+            Py_DECREF(objects[i]);
+        }
+
+        printf("%-12s %10.1f ms to python %10.1f ms from python\n", "string", newString, convertString);
+        printf("%-12s %10.1f ms to python %10.1f ms from python\n", "DecimalUtil", newNative, convertNative);
+
+        Py_DECREF(type);
+    } catch (const std::exception &e) {
+        fprintf(stderr, "%s\n", e.what());
+        ret = 1;
+    }
+
+    DecimalUtil::Reset();
+    Py_Finalize();
+
+    return ret;
+}
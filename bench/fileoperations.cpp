@@ -0,0 +1,93 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/**
+ * Measures reading and writing a file with FileOperations and with an ifstream for comparison.
+ *
+ * Usage: bench_fileoperations [directory] [megabytes]
+ *
+ * The file is written to the directory, which defaults to the working directory.
+ * The reads are served from the page cache because the file was just written.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+
+#include "io/fileoperations.hpp"
+
+static double millisecondsSince(const std::chrono::steady_clock::time_point &start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    std::filesystem::path directory = argc > 1 ? argv[1] : ".";
+    size_t size = (argc > 2 ? std::stoul(argv[2]) : 100) * 1024 * 1024;
+    auto path = (directory / "bench_file.bin").string();
+
+    std::string contents(size, '\0');
+    for (size_t i = 0; i < size; i++) {
+        contents[i] = static_cast<char>(i * 31 % 251);
+    }
+
+    try {
+        printf("%zu bytes\n", size);
+
+        auto start = std::chrono::steady_clock::now();
+        FileOperations::fileWriteAll(path, contents);
+        printf("%-26s %8.1f ms\n", "fileWriteAll", millisecondsSince(start));
+
+        start = std::chrono::steady_clock::now();
+        {
+            FileOperations::MappedFile file(path);
+            // Touch every page so that the mapping is not measured without its page faults
+            unsigned char sum = 0;
+            for (size_t i = 0; i < file.size(); i += 4096) {
+                sum += static_cast<unsigned char>(file.data()[i]);
+            }
+            printf("%-26s %8.1f ms (%u)\n", "MappedFile", millisecondsSince(start), sum);
+        }
+
+        start = std::chrono::steady_clock::now();
+        auto data = FileOperations::fileReadAll(path);
+        printf("%-26s %8.1f ms\n", "fileReadAll", millisecondsSince(start));
+        if (data != contents)
+            throw std::runtime_error("fileReadAll returned different data");
+
+        start = std::chrono::steady_clock::now();
+        {
+            std::ifstream stream(path, std::ios::binary);
+            std::stringstream buffer;
+            buffer << stream.rdbuf();
+            data = buffer.str();
+        }
+        printf("%-26s %8.1f ms\n", "ifstream and stringstream", millisecondsSince(start));
+    } catch (const std::exception &e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    std::filesystem::remove(path);
+
+    return 0;
+}
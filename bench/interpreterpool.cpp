@@ -0,0 +1,189 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/**
+ * Measures batched calls of the nilakantha addon in the main interpreter
+ * and in the interpreter pool with an increasing number of workers.
+ *
+ * Usage: bench_interpreterpool [directory] [calls] [iterations] [max workers]
+ *
+ * The addon is imported from the python/addon directory of the source tree.
+ * A module which measures the cpu time of each chunk of a batch is written to the directory,
+ * which defaults to the working directory.
+ *
+ * The wall time only improves with more workers if there are enough hardware threads.
+ * The longest chunk is the wall time of the pool when every worker has its own hardware thread.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <thread>
+
+#include "python/pythoninclude.hpp"
+#include "python/interpreter.hpp"
+#include "python/interpreterpool.hpp"
+
+static const char *ADDON_MODULE = "nilakantha.nilakantha";
+
+static const char *TIMING_MODULE = "qcalc_bench_timing";
+
+static const char *TIMING = "import time\n"
+                            "from nilakantha import nilakantha\n"
+                            "\n"
+                            "def work(batch):\n"
+                            "    start = time.thread_time()\n"
+                            "    nilakantha.callback(batch)\n"
+                            "    return [time.thread_time() - start] * len(batch)\n";
+
+static double millisecondsSince(const std::chrono::steady_clock::time_point &start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static PyObject *importCallback(const char *moduleName, const char *name) {
+    PyObject *module = PyImport_ImportModule(moduleName);
+    if (module == NULL) {
+        return NULL;
+    }
+    PyObject *ret = PyObject_GetAttrString(module, name);
+    Py_DECREF(module);
+    return ret;
+}
+
+// The pool only needs the module directories of the main interpreter, which avoids linking the native modules.
+std::vector<std::string> Interpreter::getModuleDirs() {
+    std::vector<std::string> ret;
+    PyObject *sysPath = PySys_GetObject("path"); //Borrowed
+    for (Py_ssize_t i = 0; i < PyList_Size(sysPath); i++) {
+        ret.emplace_back(PyUnicode_AsUTF8(PyList_GetItem(sysPath, i)));
+    }
+    return ret;
+}
+
+int main(int argc, char *argv[]) {
+    std::string directory = argc > 1 ? argv[1] : ".";
+    size_t calls = argc > 2 ? std::stoul(argv[2]) : 16;
+    std::string iterations = argc > 3 ? argv[3] : "20000";
+    int maxWorkers = argc > 4 ? std::stoi(argv[4]) : 8;
+
+    FILE *file = fopen((directory + "/" + TIMING_MODULE + ".py").c_str(), "w");
+    if (file == nullptr) {
+        fprintf(stderr, "Failed to write the timing module to %s\n", directory.c_str());
+        return 1;
+    }
+    fputs(TIMING, file);
+    fclose(file);
+
+    Py_Initialize();
+
+    for (auto &path: {std::string(QCALC_ADDON_DIRECTORY), directory}) {
+        PyObject *dir = PyUnicode_FromString(path.c_str());
+        PyList_Append(PySys_GetObject("path"), dir);
+        Py_DECREF(dir);
+    }
+
+    PyObject *callback = importCallback(ADDON_MODULE, "callback");
+    PyObject *timing = importCallback(TIMING_MODULE, "work");
+    if (callback == NULL || timing == NULL) {
+        PyErr_Print();
+        return 1;
+    }
+
+    std::vector<std::vector<decimal::Decimal>> args;
+    for (size_t i = 0; i < calls; i++) {
+        args.push_back({decimal::Decimal(iterations)});
+    }
+
+    printf("python %s\n%zu calls of %s iterations, %u hardware threads\n",
+           PY_VERSION,
+           calls,
+           iterations.c_str(),
+           std::thread::hardware_concurrency());
+
+    auto start = std::chrono::steady_clock::now();
+    PyObject *batch = PyList_New(static_cast<Py_ssize_t>(args.size()));
+    for (size_t i = 0; i < args.size(); i++) {
+        PyList_SET_ITEM(batch, i, Py_BuildValue("(s)", args.at(i).at(0).to_sci().c_str()));
+    }
+    PyObject *ret = PyObject_CallOneArg(callback, batch);
+    Py_DECREF(batch);
+    if (ret == NULL) {
+        PyErr_Print();
+        return 1;
+    }
+    std::string expected = PyUnicode_AsUTF8(PyList_GetItem(ret, 0));
+    Py_DECREF(ret);
+    printf("main interpreter %10.1f ms\n", millisecondsSince(start));
+
+    printf("%11s %15s %15s\n", "", "wall", "longest chunk");
+
+    PyThreadState *state = PyEval_SaveThread();
+    for (int workers = 1; workers <= maxWorkers; workers *= 2) {
+        PyEval_RestoreThread(state);
+        InterpreterPool::start(workers);
+        state = PyEval_SaveThread();
+
+        try {
+            std::vector<decimal::Decimal> results;
+            start = std::chrono::steady_clock::now();
+            if (!InterpreterPool::runBatch(callback, "nilakantha", args, results)) {
+                printf("%3d workers: the pool is not available\n", workers);
+                InterpreterPool::stop();
+                continue;
+            }
+            auto wall = millisecondsSince(start);
+
+            for (auto &result: results) {
+                if (result.to_sci() != expected) {
+                    printf("%3d workers: the result %s differs from %s\n",
+                           workers,
+                           result.to_sci().c_str(),
+                           expected.c_str());
+                }
+            }
+
+            // Every chunk of the batch returns its cpu time for each of its calls.
+            std::vector<decimal::Decimal> times;
+            if (!InterpreterPool::runBatch(timing, "timing", args, times)) {
+                printf("%3d workers: the pool is not available\n", workers);
+                InterpreterPool::stop();
+                continue;
+            }
+            double longest = 0;
+            for (auto &time: times) {
+                longest = std::max(longest, std::stod(time.to_sci()) * 1000);
+            }
+
+            printf("%3d workers %12.1f ms %12.1f ms\n", workers, wall, longest);
+        } catch (const std::exception &e) {
+            printf("%3d workers: %s\n", workers, e.what());
+        }
+
+        InterpreterPool::stop();
+    }
+    PyEval_RestoreThread(state);
+
+    Py_DECREF(timing);
+    Py_DECREF(callback);
+    Py_Finalize();
+
+    return 0;
+}
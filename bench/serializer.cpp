@@ -0,0 +1,71 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/**
+ * Measures writing and reading a symbol table of constants in the json and in the binary format.
+ *
+ * Usage: bench_serializer [constants]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <stdexcept>
+
+#include "io/serializer.hpp"
+
+static double millisecondsSince(const std::chrono::steady_clock::time_point &start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void measure(const char *name, const SymbolTable &table, bool binary) {
+    auto start = std::chrono::steady_clock::now();
+    auto data = binary ? Serializer::serializeTableBinary(table) : Serializer::serializeTable(table);
+    double write = millisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    auto ret = Serializer::deserializeTable(data);
+    double read = millisecondsSince(start);
+
+    if (ret.getConstants().size() != table.getConstants().size())
+        throw std::runtime_error(std::string(name) + " returned a different number of constants");
+
+    printf("%-8s %12zu bytes %10.1f ms write %10.1f ms read\n", name, data.size(), write, read);
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 100000;
+
+    SymbolTable table;
+    for (size_t i = 0; i < count; i++) {
+        auto digits = std::to_string(i);
+        table.setConstant("c" + digits, decimal::Decimal(digits + ".1234567890123456789" + digits));
+    }
+
+    try {
+        printf("%zu constants\n", count);
+        measure("json", table, false);
+        measure("binary", table, true);
+    } catch (const std::exception &e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
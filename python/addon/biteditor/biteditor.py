@@ -1,7 +1,10 @@
 """
 {
   "displayName": "Bit Editor",
-  "description": "Edit binary representations of numbers with toggleable bits."
+  "description": "Edit binary representations of numbers with toggleable bits.",
+  "activation": {
+    "footer": true
+  }
 }
 """
 
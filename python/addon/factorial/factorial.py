@@ -1,7 +1,10 @@
 """
 {
   "displayName": "Factorial",
-  "description": "This addon adds the factorial function as a script function."
+  "description": "This addon adds the factorial function as a script function.",
+  "activation": {
+    "scripts": ["factorial"]
+  }
 }
 """
 
@@ -22,20 +25,23 @@
 # 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
 import math
-import exprtk
 
 
-def callback(*args):
-    return math.factorial(int(args[0]))
+def callback(batch):
+    return [math.factorial(int(args[0])) for args in batch]
 
 
+# exprtk is imported by load and unload because the module is also imported by the worker interpreters
+# of the interpreter pool, which do not provide the exprtk module.
 def load():
+    import exprtk
     sym = exprtk.get_global_symtable()
-    sym.set_script("factorial", exprtk.ScriptFunction(callback, ["n"]))
+    sym.set_script("factorial", exprtk.ScriptFunction(callback, ["n"], pure=True, batch=True))
     exprtk.set_global_symtable(sym)
 
 
 def unload():
+    import exprtk
     sym = exprtk.get_global_symtable()
     sym.remove("factorial")
     exprtk.set_global_symtable(sym)
@@ -1,7 +1,10 @@
 """
 {
   "displayName": "Keypad",
-  "description": "This addon adds a simple keypad to the gui."
+  "description": "This addon adds a simple keypad to the gui.",
+  "activation": {
+    "footer": true
+  }
 }
 """
 
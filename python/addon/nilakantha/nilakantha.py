@@ -1,7 +1,10 @@
 """
 {
   "displayName": "Nilakantha Series",
-  "description": "Provides nilakantha series pi calculation script function"
+  "description": "Provides nilakantha series pi calculation script function",
+  "activation": {
+    "scripts": ["nilakantha"]
+  }
 }
 """
 
@@ -22,7 +25,6 @@
 # 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
 import math
-import exprtk
 import decimal
 
 # Run the nilakantha series for the specified number of iterations and return the value.
@@ -36,16 +38,20 @@ def nilakantha(iterations):
             ret -= v
     return str(ret)
 
-def callback(*args):
-    return nilakantha(int(args[0]))
+def callback(batch):
+    return [nilakantha(int(args[0])) for args in batch]
 
+# exprtk is imported by load and unload because the module is also imported by the worker interpreters
+# of the interpreter pool, which do not provide the exprtk module.
 def load():
+    import exprtk
     sym = exprtk.get_global_symtable()
-    sym.set_script("nilakantha", exprtk.ScriptFunction(callback, ["iterations"]))
+    sym.set_script("nilakantha", exprtk.ScriptFunction(callback, ["iterations"], pure=True, batch=True))
     exprtk.set_global_symtable(sym)
 
 
 def unload():
+    import exprtk
     sym = exprtk.get_global_symtable()
     sym.remove("nilakantha")
     exprtk.set_global_symtable(sym)
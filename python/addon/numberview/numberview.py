@@ -1,7 +1,10 @@
 """
 {
   "displayName": "Number View",
-  "description": "This addon adds gui for converting values between various numeral systems."
+  "description": "This addon adds gui for converting values between various numeral systems.",
+  "activation": {
+    "footer": true
+  }
 }
 """
 
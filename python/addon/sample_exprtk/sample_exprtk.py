@@ -30,8 +30,8 @@ class CustomCallbacks:
 
     # Our script function callback which is invoked by the expression parser
     # when it encounters the defined symbol name in a expression.
-    # The arguments are a tuple of mpreal instances.
-    # Allowed return values are: float, long and mpreal
+    # The arguments are a tuple of decimal.Decimal instances.
+    # Allowed return values are: decimal.Decimal, str, float and int
     def evaluate(self):
         return 422
 
@@ -73,6 +73,12 @@ def load():
 
     print("Variable: " + str(result[1].get_variable("pyVar")))
 
+    # Compile an expression once and evaluate it repeatedly with different variable values
+    compiled = exprtk.compile("pyVar * 2 + pyFuncArgs(1)", sym)
+    for i in range(3):
+        compiled["pyVar"] = i
+        print("Compiled: " + str(compiled.value()))
+
 
 def unload():
     print("Unloading exprtk sample addon")
@@ -14,20 +14,30 @@
 # with this program; if not, write to the Free Software Foundation, Inc.,
 # 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
-import _exprtk
+try:
+    import _exprtk
+except ImportError:
+    # The native module cannot be imported in the worker interpreters which run pure script functions in parallel,
+    # the classes of this module remain usable so that addon modules can be imported by the workers.
+    _exprtk = None
 
 class Function:
-    def __init__(self, expression="", arguments=[]):
+    def __init__(self, expression="", arguments=[], pure=False):
         if arguments is None:
             arguments = []
         self.expression = expression
         self.arguments = arguments
+        self.pure = pure
 
 
 class ScriptFunction:
-    def __init__(self, callback=None, arguments=[]):
+    # If batch is True the callback receives a list of argument tuples and must return a list of results.
+    # A batch is evaluated by passing an output vector after the arguments, eg. f(x, y) stores f(x[i]) in y[i].
+    def __init__(self, callback=None, arguments=[], pure=False, batch=False):
         self.callback = callback
         self.arguments = arguments
+        self.pure = pure
+        self.batch = batch
 
 
 class SymbolTable:
@@ -104,9 +114,43 @@ def evaluate_with_side_effects(expression, symtable):
     return _exprtk.evaluate(expression, symtable)
 
 
+# Returns a compiled expression handle, variables of the symbol table can be assigned with handle["name"] = value
+# and handle.value() evaluates the expression without parsing it again.
+def compile(expression, symtable=None):
+    if symtable is None:
+        symtable = SymbolTable()
+    return _exprtk.compile(expression, symtable)
+
+
+# Returns a live view of the global symbol table which provides the same methods as SymbolTable.
+# Changes made through the view are applied when passing it to set_global_symtable, calling commit()
+# or when leaving a with block without an exception.
 def get_global_symtable():
     return _exprtk.get_global_symtable()
 
 
 def set_global_symtable(sym):
     return _exprtk.set_global_symtable(sym)
+
+
+def get_memo_statistics():
+    return _exprtk.get_memo_statistics()
+
+
+def clear_memo_cache():
+    return _exprtk.clear_memo_cache()
+
+
+# Returns a list of dictionaries with the runtime statistics of script calls (kind "script")
+# and addon callbacks (kind "load", "unload" or "reload").
+# If names is passed only the entries of the given script names or addon module names are returned,
+# eg. an addon can query its own numbers with get_runtime_statistics(["myscript", "myaddon"]).
+def get_runtime_statistics(names=None):
+    ret = _exprtk.get_runtime_statistics()
+    if names is not None:
+        ret = [entry for entry in ret if entry["name"] in names]
+    return ret
+
+
+def reset_runtime_statistics():
+    return _exprtk.reset_runtime_statistics()
@@ -24,21 +24,47 @@ def find_widget(object_name):
 
 app = QtWidgets.QApplication.instance()
 
-wnd = find_widget("MainWindow")
-menubar = find_widget("menubar")
-statusbar = find_widget("statusbar")
-
-root = find_widget("widget_root")
-history = find_widget("widget_history")
-input_line_edit = find_widget("lineEdit_input")
-
-footer_widget = find_widget("footerWidget")
+# Widgets are looked up on first access because addon modules may be imported
+# by the interpreter thread before the main window has been constructed.
+_widget_names = {
+    "wnd": "MainWindow",
+    "menubar": "menubar",
+    "statusbar": "statusbar",
+    "root": "widget_root",
+    "history": "widget_history",
+    "input_line_edit": "lineEdit_input",
+}
+
+def _get_widget(name):
+    widget = globals().get(name)
+    if widget is None:
+        widget = find_widget(_widget_names[name])
+        if widget is not None:
+            globals()[name] = widget
+    return widget
+
+def __getattr__(name):
+    if name in _widget_names:
+        return _get_widget(name)
+    raise AttributeError("module 'qcalc' has no attribute '" + name + "'")
 
 footer_rows = {}
 widget_row_mapping = {}
 
-def insert_widget_footer(widget, column, row):
+# The footer container is created when the first footer widget is inserted.
+footer_widget = None
+
+def _get_footer_widget():
     global footer_widget
+    if footer_widget is None:
+        footer_widget = QtWidgets.QWidget()
+        footer_widget.setLayout(QtWidgets.QVBoxLayout())
+        footer_widget.setObjectName("footerWidget")
+        footer_widget.hide()
+        _get_widget("root").layout().addWidget(footer_widget)
+    return footer_widget
+
+def insert_widget_footer(widget, column, row):
     global footer_rows
     global widget_row_mapping
 
@@ -47,7 +73,7 @@ def insert_widget_footer(widget, column, row):
         row_widget.setLayout(QtWidgets.QHBoxLayout()) # The layout that contains the row widgets
         row_widget.layout().setMargin(0)
         footer_rows[row] = row_widget
-        footer_widget.layout().insertWidget(row, row_widget)
+        _get_footer_widget().layout().insertWidget(row, row_widget)
     else:
         row_widget = footer_rows[row]
 
@@ -55,7 +81,7 @@ def insert_widget_footer(widget, column, row):
 
     widget_row_mapping[widget] = row
 
-    footer_widget.show()
+    _get_footer_widget().show()
 
 def remove_widget_footer(widget):
     global widget_row_mapping
@@ -66,10 +92,10 @@ def remove_widget_footer(widget):
     row_widget.layout().removeWidget(widget)
 
     if row_widget.layout().count() == 0:
-        footer_widget.layout().removeWidget(row_widget)
+        _get_footer_widget().layout().removeWidget(row_widget)
         del footer_rows[row]
 
     del widget_row_mapping[widget]
 
     if len(widget_row_mapping) == 0:
-        footer_widget.hide()
\ No newline at end of file
+        _get_footer_widget().hide()
\ No newline at end of file
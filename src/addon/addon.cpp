@@ -21,16 +21,86 @@
 
 #include <utility>
 #include <stdexcept>
+#include <chrono>
 
 #include "python/interpreter.hpp"
 
 #include "python/interpreterhandler.hpp"
 
-Addon::Addon(std::string moduleName, std::string displayName, std::string description)
+#include "calculator/runtimestatistics.hpp"
+
+static double millisecondsSince(const std::chrono::steady_clock::time_point &start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void recordCallback(RuntimeStatistics::Kind kind,
+                           const std::string &moduleName,
+                           const std::chrono::steady_clock::time_point &start,
+                           bool failed) {
+    RuntimeStatistics::Sample sample;
+    sample.time = millisecondsSince(start);
+    sample.failed = failed;
+    RuntimeStatistics::record(kind, moduleName, sample);
+}
+
+Addon::Addon(std::string moduleName,
+             std::string displayName,
+             std::string description,
+             AddonActivation activation)
         : loaded(false),
           moduleName(std::move(moduleName)),
           displayName(std::move(displayName)),
-          description(std::move(description)) {}
+          description(std::move(description)),
+          activation(std::move(activation)) {}
+
+void Addon::load() {
+    if (!InterpreterHandler::waitForInitialization()) {
+        throw std::runtime_error("Python is not initialized");
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    try {
+        loadModule();
+    } catch (const std::exception &e) {
+        recordCallback(RuntimeStatistics::ADDON_LOAD, moduleName, start, true);
+        throw;
+    }
+    recordCallback(RuntimeStatistics::ADDON_LOAD, moduleName, start, false);
+
+    loaded = true;
+    activationPending = false;
+}
+
+void Addon::unload() {
+    auto start = std::chrono::steady_clock::now();
+    try {
+        callFunctionNoArgs("unload");
+    } catch (const std::exception &e) {
+        recordCallback(RuntimeStatistics::ADDON_UNLOAD, moduleName, start, true);
+        throw;
+    }
+    recordCallback(RuntimeStatistics::ADDON_UNLOAD, moduleName, start, false);
+    loaded = false;
+}
+
+void Addon::loadModule() {
+    if (!moduleLoaded && Interpreter::isInitialized()) {
+        // Use the import time of the module if it was prefetched by the interpreter thread
+        auto prefetched = InterpreterHandler::getPrefetchTimes();
+        auto it = prefetched.find(getImportName());
+        if (it != prefetched.end()) {
+            importTime = it->second;
+        } else {
+            auto start = std::chrono::steady_clock::now();
+            Interpreter::importModule(getImportName());
+            importTime = millisecondsSince(start);
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    callFunctionNoArgs("load");
+    loadTime = millisecondsSince(start);
+}
 
 void Addon::callFunctionNoArgs(const std::string &name) {
     if (!InterpreterHandler::waitForInitialization()) {
@@ -38,7 +108,7 @@ void Addon::callFunctionNoArgs(const std::string &name) {
     }
     moduleLoaded = true;
     if (Interpreter::isInitialized()) {
-        Interpreter::callFunctionNoArgs(moduleName + "." + moduleName, name);
+        Interpreter::callFunctionNoArgs(getImportName(), name);
     } else {
         throw std::runtime_error(
                 "Python is not initialized (The console contains the error message), ensure that the correct path is configured in the settings.");
@@ -46,18 +116,37 @@ void Addon::callFunctionNoArgs(const std::string &name) {
 }
 
 void Addon::reload() {
+    auto start = std::chrono::steady_clock::now();
+    try {
+        reloadModule();
+    } catch (const std::exception &e) {
+        recordCallback(RuntimeStatistics::ADDON_RELOAD, moduleName, start, true);
+        throw;
+    }
+    recordCallback(RuntimeStatistics::ADDON_RELOAD, moduleName, start, false);
+}
+
+void Addon::reloadModule() {
+    // The nested unload and load are part of the recorded reload and are not recorded on their own
     bool l = loaded;
-    if (l)
-        unload();
+    if (l) {
+        callFunctionNoArgs("unload");
+        loaded = false;
+    }
 
     if (!InterpreterHandler::waitForInitialization()) {
         throw std::runtime_error("Python is not initialized");
     }
 
     if (Interpreter::isInitialized()) {
-        Interpreter::reloadModule(moduleName + "." + moduleName);
+        auto start = std::chrono::steady_clock::now();
+        Interpreter::reloadModule(getImportName());
+        importTime = millisecondsSince(start);
     }
 
-    if (l)
-        load();
+    if (l) {
+        loadModule();
+        loaded = true;
+        activationPending = false;
+    }
 }
@@ -21,22 +21,38 @@
 #define QCALC_ADDON_HPP
 
 #include <string>
+#include <set>
+
+/**
+ * Declares when a lazy addon is loaded.
+ * Addons without any activation trigger are loaded as soon as they are enabled.
+ */
+struct AddonActivation {
+    /**
+     * Load the addon when an evaluated expression references one of these script names.
+     */
+    std::set<std::string> scripts;
+
+    /**
+     * Load the addon after the calculator window has been shown, used by addons which insert footer widgets.
+     */
+    bool footer = false;
+
+    bool isLazy() const { return !scripts.empty() || footer; }
+};
 
 class Addon {
 public:
     Addon() = default;
 
-    Addon(std::string moduleName, std::string displayName, std::string description);
+    Addon(std::string moduleName,
+          std::string displayName,
+          std::string description,
+          AddonActivation activation = {});
 
-    void load() {
-        callFunctionNoArgs("load");
-        loaded = true;
-    }
+    void load();
 
-    void unload() {
-        callFunctionNoArgs("unload");
-        loaded = false;
-    }
+    void unload();
 
     void reload();
 
@@ -48,18 +64,55 @@ public:
 
     void setModuleLoaded() { moduleLoaded = true; }
 
+    /**
+     * @return True if the addon is enabled but waits for one of its activation triggers.
+     */
+    bool isActivationPending() const { return activationPending; }
+
+    void setActivationPending(bool pending) { activationPending = pending; }
+
+    const AddonActivation &getActivation() const { return activation; }
+
     const std::string &getModuleName() const { return moduleName; }
 
     const std::string &getDisplayName() const { return displayName; }
 
     const std::string &getDescription() const { return description; }
 
+    /**
+     * @return The name of the python module containing the load() / unload() callbacks.
+     */
+    std::string getImportName() const { return moduleName + "." + moduleName; }
+
+    /**
+     * @return The time in milliseconds spent importing the addon module or a negative value if not measured yet.
+     */
+    double getImportTime() const { return importTime; }
+
+    /**
+     * @return The time in milliseconds spent in the load() callback or a negative value if not measured yet.
+     */
+    double getLoadTime() const { return loadTime; }
+
+    void setImportTime(double time) { importTime = time; }
+
 private:
+    /**
+     * Import the module if necessary and invoke the load() callback.
+     */
+    void loadModule();
+
+    void reloadModule();
+
     bool loaded = false;
     bool moduleLoaded = false;
+    bool activationPending = false;
     std::string moduleName;
     std::string displayName;
     std::string description;
+    AddonActivation activation;
+    double importTime = -1;
+    double loadTime = -1;
 };
 
 #endif //QCALC_ADDON_HPP
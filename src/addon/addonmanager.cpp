@@ -21,7 +21,11 @@
 
 #include <utility>
 #include <filesystem>
-#include <fstream>
+#include <cctype>
+#include <future>
+#include <thread>
+#include <atomic>
+#include <algorithm>
 
 #include "io/fileoperations.hpp"
 
@@ -30,10 +34,12 @@
 #include "json.hpp"
 
 #include "io/archive.hpp"
+#include "io/archivereader.hpp"
 
 struct AddonMetadata {
     std::string displayName;
     std::string description;
+    AddonActivation activation;
 };
 
 static std::string concatPath(const std::string &target,
@@ -51,54 +57,198 @@ AddonMetadata deserializeMetadata(const std::string &text) {
     AddonMetadata ret;
     ret.displayName = j["displayName"];
     ret.description = j["description"];
+    if (j.find("activation") != j.end()) {
+        auto activation = j["activation"];
+        ret.activation.scripts = activation.value("scripts", std::set<std::string>());
+        ret.activation.footer = activation.value("footer", false);
+    }
     return ret;
 }
 
-static std::map<std::string, AddonMetadata> readAvailableAddons(const std::string &addonsDirectory) {
-    std::map<std::string, AddonMetadata> ret;
+static nlohmann::json serializeMetadata(const AddonMetadata &metadata) {
+    nlohmann::json j;
+    j["displayName"] = metadata.displayName;
+    j["description"] = metadata.description;
+    j["activation"]["scripts"] = metadata.activation.scripts;
+    j["activation"]["footer"] = metadata.activation.footer;
+    return j;
+}
+
+/**
+ * Read the metadata docstring of the addon module.
+ * The module file is mapped so only the pages up to the end of the docstring are loaded.
+ */
+static AddonMetadata readMetadata(const std::string &filePath, const std::string &moduleName) {
+    const std::string_view n = R"(""")";
+
+    std::string json;
+    try {
+        FileOperations::MappedFile file(filePath);
+        auto contents = file.view();
+        auto start = contents.find(n);
+        if (start != std::string_view::npos) {
+            auto end = contents.find(n, start + n.length());
+            if (end != std::string_view::npos)
+                json = contents.substr(start + n.length(), end - start - n.length());
+        }
+    } catch (const std::exception &e) {
+        // Unreadable module, use the default metadata
+    }
+
+    AddonMetadata metadata;
+    if (!json.empty()) {
+        //Has metadata file
+        try {
+            metadata = deserializeMetadata(json);
+        } catch (const std::exception &e) {
+            //Ignore exception and set default metadata
+            metadata.displayName = moduleName;
+            metadata.description = "No Description";
+        }
+    } else {
+        //No metadata file
+        metadata.displayName = moduleName;
+        metadata.description = "No Description";
+    }
+    return metadata;
+}
+
+struct AddonIndexEntry {
+    std::string moduleName;
+    std::string filePath;
+    std::uintmax_t size = 0;
+    long long modified = 0;
+    AddonMetadata metadata;
+};
+
+static std::map<std::string, AddonIndexEntry> readAddonIndex(const std::string &indexFile) {
+    std::map<std::string, AddonIndexEntry> ret;
+    if (!std::filesystem::exists(indexFile))
+        return ret;
+    try {
+        FileOperations::MappedFile file(indexFile);
+        auto j = nlohmann::json::parse(file.data(), file.data() + file.size());
+        for (auto &item: j["addons"].items()) {
+            auto &v = item.value();
+            AddonIndexEntry entry;
+            entry.filePath = item.key();
+            entry.moduleName = v["moduleName"];
+            entry.size = v["size"];
+            entry.modified = v["modified"];
+            entry.metadata = deserializeMetadata(v["metadata"].dump());
+            ret[entry.filePath] = entry;
+        }
+    } catch (const std::exception &e) {
+        // Corrupt index, all addons are parsed again and the index is rewritten.
+        ret.clear();
+    }
+    return ret;
+}
+
+static void writeAddonIndex(const std::string &indexFile, const std::vector<AddonIndexEntry> &entries) {
+    nlohmann::json j;
+    j["version"] = 0;
+    j["addons"] = nlohmann::json::object();
+    for (auto &entry: entries) {
+        auto &v = j["addons"][entry.filePath];
+        v["moduleName"] = entry.moduleName;
+        v["size"] = entry.size;
+        v["modified"] = entry.modified;
+        v["metadata"] = serializeMetadata(entry.metadata);
+    }
+    try {
+        FileOperations::fileWriteAll(indexFile, j.dump());
+    } catch (const std::exception &e) {
+        // The index is only an optimization, the addons are parsed again on the next read.
+    }
+}
+
+/**
+ * Read the metadata of all addons in the addon directory.
+ *
+ * The directory listing itself is sequential, the addon packages are then checked concurrently.
+ * Addon module files whose path, size and modification time match the on-disk index are not read,
+ * the remaining files are parsed and the index is rewritten if anything changed.
+ */
+static std::map<std::string, AddonMetadata> readAvailableAddons(const std::string &addonsDirectory,
+                                                                const std::string &indexFile) {
+    auto index = readAddonIndex(indexFile);
 
+    std::vector<std::filesystem::path> packages;
     for (auto &addonDir: std::filesystem::directory_iterator(addonsDirectory)) {
-        std::string addonDirPath = addonDir.path().string();
+        packages.emplace_back(addonDir.path());
+    }
 
-        auto filePath = concatPath(addonDirPath, addonDir.path().filename().string() + ".py");
+    std::vector<AddonIndexEntry> entries(packages.size());
+    std::vector<char> valid(packages.size(), false);
+    std::atomic<bool> changed(false);
 
-        auto fileContents = FileOperations::fileReadAll(filePath);
-        std::string n = R"(""")";
+    auto checkPackage = [&](size_t i) {
+        auto &package = packages.at(i);
+        auto filePath = concatPath(package.string(), package.filename().string() + ".py");
 
-        std::string json;
-        auto start = fileContents.find_first_of(n);
-        if (start != std::string::npos) {
-            auto end = fileContents.find(n, start + n.length());
-            if (end != std::string::npos) {
-                json = fileContents.substr(start + n.length(), end - n.length());
-            }
+        std::error_code ec;
+        auto size = std::filesystem::file_size(filePath, ec);
+        if (ec) {
+            // Not an addon package
+            return;
+        }
+        auto modified = static_cast<long long>(std::filesystem::last_write_time(filePath, ec).time_since_epoch().count());
+        if (ec) {
+            return;
         }
 
         auto file = std::filesystem::path(filePath);
         auto fileName = file.filename().string();
         auto fileExt = file.extension().string();
 
-        auto moduleName = fileName.substr(0, fileName.length() - fileExt.length());
+        auto &entry = entries.at(i);
+        entry.moduleName = fileName.substr(0, fileName.length() - fileExt.length());
+        entry.filePath = filePath;
+        entry.size = size;
+        entry.modified = modified;
 
-        AddonMetadata metadata;
-        if (!json.empty()) {
-            //Has metadata file
-            try {
-                metadata = deserializeMetadata(json);
-            } catch (const std::exception &e) {
-                //Ignore exception and set default metadata
-                metadata.displayName = moduleName;
-                metadata.description = "No Description";
-            }
+        auto it = index.find(filePath);
+        if (it != index.end() && it->second.size == size && it->second.modified == modified) {
+            entry.metadata = it->second.metadata;
         } else {
-            //No metadata file
-            metadata.displayName = moduleName;
-            metadata.description = "No Description";
+            entry.metadata = readMetadata(entry.filePath, entry.moduleName);
+            changed = true;
+        }
+        valid.at(i) = true;
+    };
+
+    if (!packages.empty()) {
+        size_t workerCount = std::max(1u, std::thread::hardware_concurrency());
+        workerCount = std::min(workerCount, packages.size());
+
+        std::vector<std::future<void>> workers;
+        for (size_t w = 0; w < workerCount; w++) {
+            workers.emplace_back(std::async(std::launch::async, [&checkPackage, &packages, w, workerCount]() {
+                for (size_t i = w; i < packages.size(); i += workerCount) {
+                    checkPackage(i);
+                }
+            }));
         }
+        for (auto &worker: workers) {
+            worker.get();
+        }
+    }
 
-        ret[moduleName] = metadata;
+    std::vector<AddonIndexEntry> validEntries;
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (valid.at(i))
+            validEntries.emplace_back(std::move(entries.at(i)));
     }
 
+    if (changed || index.size() != validEntries.size()) {
+        writeAddonIndex(indexFile, validEntries);
+    }
+
+    std::map<std::string, AddonMetadata> ret;
+    for (auto &entry: validEntries) {
+        ret[entry.moduleName] = entry.metadata;
+    }
     return ret;
 }
 
@@ -116,30 +266,13 @@ Archive AddonManager::createInstallableBundle(std::vector<InstallBundleEntry> en
 
             j["package"] = packageName;
 
-            for (auto &packageFile: FileOperations::findFilesInDirectory(packagePath.string(), "", true)) {
-                auto packageFilePath = packageFile.substr(basePath.string().size() + 1);
-                auto packageDataStr = FileOperations::fileReadAll(packageFile);
-
-                std::vector<char> packageData(packageDataStr.size());
-                for (auto i = 0; i < packageData.size(); i++) {
-                    packageData.at(i) = packageDataStr.at(i);
-                }
-
-                archive.addEntry(packageFilePath, packageData);
-            }
+            archive.addDirectory(packagePath.filename().string(), packagePath.string());
         } else {
             auto packageFilePath = packagePath.string().substr(basePath.string().size() + 1);
 
             j["package"] = packageFilePath;
 
-            auto packageDataStr = FileOperations::fileReadAll(packagePath.string());
-
-            std::vector<char> packageData(packageDataStr.size());
-            for (auto i = 0; i < packageData.size(); i++) {
-                packageData.at(i) = packageDataStr.at(i);
-            }
-
-            archive.addEntry(packageFilePath, packageData);
+            archive.addFile(packageFilePath, packagePath.string());
         }
 
         j["version"] = entry.version;
@@ -161,9 +294,11 @@ Archive AddonManager::createInstallableBundle(std::vector<InstallBundleEntry> en
 }
 
 AddonManager::AddonManager(std::string addonDirectory,
+                           std::string addonIndexFile,
                            Listener onAddonLoadFail,
                            Listener onAddonUnloadFail)
         : addonDir(std::move(addonDirectory)),
+          indexFile(std::move(addonIndexFile)),
           onAddonLoadFail(std::move(onAddonLoadFail)),
           onAddonUnloadFail(std::move(onAddonUnloadFail)) {
     readAddons();
@@ -189,7 +324,12 @@ void AddonManager::reloadModules() {
             // Addon is not available on disk anymore.
             continue;
         }
-        auto addon = addons.at(mod);
+        auto &addon = addons.at(mod);
+        if (!addon.isModuleLoaded()) {
+            // Lazy addon which was never activated, there is nothing to reload.
+            workingAddons.insert(mod);
+            continue;
+        }
         try {
             addon.reload();
         } catch (const std::exception &e) {
@@ -215,8 +355,13 @@ std::map<std::string, Addon> &AddonManager::getAvailableAddons() {
 void AddonManager::setActiveAddons(const std::set<std::string> &inputAddons) {
     for (auto &module: activeAddons) {
         if (inputAddons.find(module) == inputAddons.end()) {
+            auto &addon = addons.at(module);
+            if (addon.isActivationPending()) {
+                addon.setActivationPending(false);
+                continue;
+            }
             try {
-                addons.at(module).unload();
+                addon.unload();
             } catch (const std::exception &e) {
                 if (onAddonUnloadFail) {
                     onAddonUnloadFail(module, e.what());
@@ -228,12 +373,13 @@ void AddonManager::setActiveAddons(const std::set<std::string> &inputAddons) {
     std::set<std::string> rMods;
     for (auto &module: inputAddons) {
         if (activeAddons.find(module) == activeAddons.end()) {
-            try {
-                addons.at(module).load();
-            } catch (const std::exception &e) {
-                if (onAddonLoadFail) {
-                    onAddonLoadFail(module, e.what());
-                }
+            auto &addon = addons.at(module);
+            auto &activation = addon.getActivation();
+            if (activation.isLazy() && !(activation.footer && windowShown)) {
+                addon.setActivationPending(true);
+                continue;
+            }
+            if (!loadAddon(module)) {
                 rMods.insert(module);
             }
         }
@@ -246,15 +392,95 @@ void AddonManager::setActiveAddons(const std::set<std::string> &inputAddons) {
         activeAddons.erase(mod);
 }
 
+bool AddonManager::activateForExpression(const std::string &expression) {
+    std::set<std::string> identifiers;
+    std::string identifier;
+    for (auto &c: expression + " ") {
+        if (std::isalnum(static_cast<unsigned char>(c)) || c == '_') {
+            identifier += c;
+        } else if (!identifier.empty()) {
+            if (!std::isdigit(static_cast<unsigned char>(identifier.front())))
+                identifiers.insert(identifier);
+            identifier.clear();
+        }
+    }
+
+    std::set<std::string> pending;
+    for (auto &module: activeAddons) {
+        auto &addon = addons.at(module);
+        if (!addon.isActivationPending())
+            continue;
+        for (auto &script: addon.getActivation().scripts) {
+            if (identifiers.find(script) != identifiers.end()) {
+                pending.insert(module);
+                break;
+            }
+        }
+    }
+
+    return activatePending(pending);
+}
+
+bool AddonManager::activateOnShow() {
+    if (windowShown)
+        return false;
+    windowShown = true;
+
+    std::set<std::string> pending;
+    for (auto &module: activeAddons) {
+        auto &addon = addons.at(module);
+        if (addon.isActivationPending() && addon.getActivation().footer) {
+            pending.insert(module);
+        }
+    }
+    return activatePending(pending);
+}
+
+std::set<std::string> AddonManager::getPrefetchModules(const std::set<std::string> &enabledAddons) const {
+    std::set<std::string> ret;
+    for (auto &module: enabledAddons) {
+        auto it = addons.find(module);
+        if (it != addons.end() && !it->second.getActivation().isLazy()) {
+            ret.insert(it->second.getImportName());
+        }
+    }
+    return ret;
+}
+
+bool AddonManager::loadAddon(const std::string &module) {
+    try {
+        addons.at(module).load();
+        return true;
+    } catch (const std::exception &e) {
+        if (onAddonLoadFail) {
+            onAddonLoadFail(module, e.what());
+        }
+        return false;
+    }
+}
+
+bool AddonManager::activatePending(const std::set<std::string> &modules) {
+    for (auto &module: modules) {
+        if (!loadAddon(module)) {
+            addons.at(module).setActivationPending(false);
+            activeAddons.erase(module);
+        }
+    }
+    return !modules.empty();
+}
+
 std::set<std::string> AddonManager::getActiveAddons() {
     return activeAddons;
 }
 
 void AddonManager::readAddons() {
-    auto ad = readAvailableAddons(addonDir);
+    auto ad = readAvailableAddons(addonDir, indexFile);
     for (const auto &addon: ad) {
         bool lod = addons[addon.first].isModuleLoaded();
-        addons[addon.first] = Addon(addon.first, addon.second.displayName, addon.second.description);
+        addons[addon.first] = Addon(addon.first,
+                                    addon.second.displayName,
+                                    addon.second.description,
+                                    addon.second.activation);
         if (lod)
             addons[addon.first].setModuleLoaded();
     }
@@ -275,24 +501,18 @@ static void createPath(const std::string &path) {
     std::filesystem::create_directories(dir);
 }
 
-static void writeToFile(const std::string &path,
-                        const std::vector<char> &data) {
-    std::ofstream ofs(path);
-    ofs.write(data.data(), data.size());
-}
-
-size_t AddonManager::installAddonBundle(std::istream &sourceFile,
+size_t AddonManager::installAddonBundle(const std::string &bundleFile,
                                         const std::function<bool(const std::string &, const std::string &,
                                                                  std::vector<std::string> &)> &installDialog) {
     const char *const metadataFilePath = "addon_bundle.json";
 
-    Archive arch(sourceFile);
+    ArchiveReader arch(bundleFile);
 
-    if (arch.entries().find(metadataFilePath) == arch.entries().end()) {
+    if (!arch.contains(metadataFilePath)) {
         throw std::runtime_error("addon_bundle.json must be present in the addon package");
     }
 
-    auto metadata = arch.entries().at(metadataFilePath);
+    auto metadata = arch.readEntry(metadataFilePath);
 
     std::vector<AddonBundleEntry> bundleEntries;
 
@@ -333,6 +553,9 @@ size_t AddonManager::installAddonBundle(std::istream &sourceFile,
         }
         bundleEntries = copy;
 
+        // Map the archive entries of the selected packages to their output files
+        std::map<std::string, std::string> outputFiles;
+
         for (auto &addon: bundleEntries) {
             std::filesystem::path addonPackagePath(addon.packagePath);
 
@@ -343,36 +566,53 @@ size_t AddonManager::installAddonBundle(std::istream &sourceFile,
                 std::filesystem::remove_all(outputDir);
                 createPath(outputDir);
 
-                // Write all files in the package directory to disk
                 auto packageDir = addon.packagePath;
                 if (!packageDir.empty() && packageDir.back() == '/')
                     packageDir.pop_back();
 
-                std::set<std::string> files;
-                for (auto &entry: arch.entries()) {
-                    if (entry.first.size() > packageDir.size() && entry.first.find(packageDir) == 0) {
-                        files.insert(entry.first);
+                size_t fileCount = 0;
+                for (auto &entry: arch.getEntries()) {
+                    if (!entry.directory
+                        && entry.path.size() > packageDir.size()
+                        && entry.path.find(packageDir) == 0) {
+                        outputFiles[entry.path] = concatPath(outputDir, entry.path.substr(packageDir.size()));
+                        fileCount++;
                     }
                 }
 
-                if (!files.empty()) {
-                    for (auto &filePath: files) {
-                        auto path = concatPath(outputDir, filePath.substr(packageDir.size()));
-                        createPath(path);
-                        writeToFile(path, arch.entries().at(filePath));
-                    }
-                } else {
+                if (fileCount == 0) {
                     throw std::runtime_error("No packages files found for defined package " + packageDir);
                 }
             } else {
+                if (!arch.contains(addon.packagePath)) {
+                    throw std::runtime_error("Package file not found " + addon.packagePath);
+                }
+
                 auto outputFile = concatPath(addonDir, addonPackagePath.filename().string());
 
                 std::filesystem::remove(outputFile);
                 createPath(outputFile);
 
-                // Write the package file to disk
-                writeToFile(outputFile, arch.getEntry(addon.packagePath));
+                outputFiles[addon.packagePath] = outputFile;
+            }
+        }
+
+        // Write the package files to disk in a single pass over the archive
+        std::vector<std::string> sourceFiles;
+        arch.extract([&outputFiles, &sourceFiles](const ArchiveReader::EntryInfo &entry) -> std::string {
+            auto it = outputFiles.find(entry.path);
+            if (it == outputFiles.end())
+                return {};
+            if (std::filesystem::path(it->second).extension() == ".py") {
+                sourceFiles.emplace_back(it->second);
             }
+            return it->second;
+        });
+
+        // Compile the installed sources so that the first import does not have to.
+        // If python is not initialized yet the bytecode is written by the first import instead.
+        if (Interpreter::isInitialized()) {
+            Interpreter::compileFiles(sourceFiles);
         }
     }
 
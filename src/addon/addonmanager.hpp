@@ -47,7 +47,14 @@ public:
 
     AddonManager() = default;
 
+    /**
+     * @param addonDirectory The directory containing the addon packages.
+     * @param addonIndexFile The file used to cache the metadata of the addons in the addon directory.
+     * @param onAddonLoadFail
+     * @param onAddonUnloadFail
+     */
     AddonManager(std::string addonDirectory,
+                 std::string addonIndexFile,
                  Listener onAddonLoadFail,
                  Listener onAddonUnloadFail);
 
@@ -69,6 +76,28 @@ public:
      */
     std::set<std::string> getActiveAddons();
 
+    /**
+     * Load the enabled lazy addons which declare one of the script names referenced in the expression.
+     *
+     * @param expression The expression which is about to be evaluated.
+     * @return True if any addon was activated.
+     */
+    bool activateForExpression(const std::string &expression);
+
+    /**
+     * Load the enabled lazy addons which declare footer activation.
+     * Only the first call activates anything, afterwards newly enabled footer addons are loaded immediately.
+     *
+     * @return True if any addon was activated.
+     */
+    bool activateOnShow();
+
+    /**
+     * @param enabledAddons The set of addon module names which are going to be enabled.
+     * @return The python modules of the enabled addons which are loaded eagerly and can be imported ahead of time.
+     */
+    std::set<std::string> getPrefetchModules(const std::set<std::string> &enabledAddons) const;
+
     /**
      * Install addons from a addon bundle.
      * A addon bundle must be an archive format supported by libarchive
@@ -92,10 +121,12 @@ public:
      *      "bundleVersion": 0
      * }
      *
-     * @param sourceFile
-     * @param questionDialog
+     * The package files are streamed from the archive to disk without loading them into memory.
+     *
+     * @param bundleFile The path of the addon bundle archive.
+     * @param installDialog
      */
-    size_t installAddonBundle(std::istream &sourceFile,
+    size_t installAddonBundle(const std::string &bundleFile,
                               const std::function<bool(const std::string &, const std::string &,
                                                        std::vector<std::string> &)> &installDialog);
 
@@ -105,12 +136,19 @@ public:
 private:
     void readAddons();
 
+    bool loadAddon(const std::string &module);
+
+    bool activatePending(const std::set<std::string> &modules);
+
     std::string addonDir;
+    std::string indexFile;
 
     std::map<std::string, Addon> addons;
     std::set<std::string> activeAddons;
     std::set<std::string> addonLibraryPaths;
 
+    bool windowShown = false;
+
     Listener onAddonLoadFail;
     Listener onAddonUnloadFail;
 };
@@ -0,0 +1,240 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "calculator/compiledexpression.hpp"
+
+#include <sstream>
+#include <vector>
+
+#include "adaptors/exprtk_mpdecimal_adaptor.hpp"
+#include "exprtk.hpp"
+
+#include "calculator/scriptfunction.hpp"
+#include "calculator/scriptvarargfunction.hpp"
+#include "calculator/scriptbatchfunction.hpp"
+#include "calculator/memofunction.hpp"
+#include "calculator/memocache.hpp"
+#include "calculator/scriptwatchdog.hpp"
+
+struct CompiledExpression::Data {
+    exprtk::function_compositor<decimal::Decimal> compositor;
+    exprtk::symbol_table<decimal::Decimal> symbols;
+
+    //Use vectors with fixed size to store the function objects as the symbol table itself only stores references.
+    std::vector<ScriptVarArgFunction<decimal::Decimal>> varArgScriptFunctions;
+    std::vector<ScriptFunction<decimal::Decimal>> scriptFunctions;
+    std::vector<ScriptBatchFunction<decimal::Decimal>> batchScriptFunctions;
+    std::vector<MemoFunction<decimal::Decimal>> memoFunctions;
+
+    std::map<std::string, decimal::Decimal> variables;
+
+    exprtk::expression<decimal::Decimal> expression;
+};
+
+static std::string getScriptSignature(const Script &script) {
+    std::stringstream stream;
+    stream << std::hex << reinterpret_cast<std::uintptr_t>(script.callback);
+    return stream.str();
+}
+
+static std::string getFunctionSignature(const Function &function) {
+    std::string ret = function.expression;
+    for (auto &arg: function.argumentNames) {
+        ret += '\0';
+        ret += arg;
+    }
+    return ret;
+}
+
+CompiledExpression::CompiledExpression(const std::string &expr, const SymbolTable &symbolTable)
+        : data(std::make_unique<Data>()) {
+    auto &compositor = data->compositor;
+    auto &symbols = data->symbols;
+
+    symbols = compositor.symbol_table();
+
+    int batchScriptCount = 0;
+    int varArgScriptCount = 0;
+    int scriptCount = 0;
+    for (auto &v: symbolTable.getScripts()) {
+        if (v.second.batched)
+            batchScriptCount++;
+        else if (v.second.arguments.empty())
+            scriptCount++;
+        else
+            varArgScriptCount++;
+    }
+
+    int varArgScriptIndex = 0;
+    auto &varArgScriptFunctions = data->varArgScriptFunctions;
+    varArgScriptFunctions.resize(varArgScriptCount);
+
+    int scriptIndex = 0;
+    auto &scriptFunctions = data->scriptFunctions;
+    scriptFunctions.resize(scriptCount);
+
+    int batchScriptIndex = 0;
+    auto &batchScriptFunctions = data->batchScriptFunctions;
+    batchScriptFunctions.resize(batchScriptCount);
+
+    for (auto &v: symbolTable.getScripts()) {
+        MemoCache *cache = nullptr;
+        if (v.second.pure) {
+            cache = &MemoCache::getCache(v.first, getScriptSignature(v.second));
+        }
+        if (v.second.batched) {
+            int index = batchScriptIndex++;
+            assert(index < batchScriptCount);
+            batchScriptFunctions.at(index) = ScriptBatchFunction<decimal::Decimal>(v.second.callback,
+                                                                                 v.first,
+                                                                                 v.second.arguments.size(),
+                                                                                 cache);
+            symbols.add_function(v.first, batchScriptFunctions.at(index));
+        } else if (v.second.arguments.empty()) {
+            int index = scriptIndex++;
+            assert(index < scriptCount);
+            scriptFunctions.at(index) = ScriptFunction<decimal::Decimal>(v.second.callback, v.first, cache);
+            symbols.add_function(v.first, scriptFunctions.at(index));
+        } else {
+            int index = varArgScriptIndex++;
+            assert(index < varArgScriptCount);
+            varArgScriptFunctions.at(index) = ScriptVarArgFunction<decimal::Decimal>(v.second.callback, v.first, cache);
+            symbols.add_function(v.first, varArgScriptFunctions.at(index));
+        }
+    }
+
+    assert(varArgScriptIndex == varArgScriptCount);
+    assert(scriptIndex == scriptCount);
+    assert(batchScriptIndex == batchScriptCount);
+
+    int memoCount = 0;
+    for (auto &v: symbolTable.getFunctions()) {
+        if (v.second.pure)
+            memoCount++;
+    }
+
+    int memoIndex = 0;
+    auto &memoFunctions = data->memoFunctions;
+    memoFunctions.resize(memoCount);
+
+    for (auto &v: symbolTable.getFunctions()) {
+        switch (v.second.argumentNames.size()) {
+            case 0:
+                compositor.add(
+                        typename exprtk::function_compositor<decimal::Decimal>::function(v.first, v.second.expression));
+                break;
+            case 1:
+                compositor.add(typename exprtk::function_compositor<decimal::Decimal>::function(v.first,
+                                                                                              v.second.expression,
+                                                                                              v.second.argumentNames[0]));
+                break;
+            case 2:
+                compositor.add(
+                        typename exprtk::function_compositor<decimal::Decimal>::function(v.first,
+                                                                                       v.second.expression,
+                                                                                       v.second.argumentNames[0],
+                                                                                       v.second.argumentNames[1]));
+                break;
+            case 3:
+                compositor.add(
+                        typename exprtk::function_compositor<decimal::Decimal>::function(v.first,
+                                                                                       v.second.expression,
+                                                                                       v.second.argumentNames[0],
+                                                                                       v.second.argumentNames[1],
+                                                                                       v.second.argumentNames[2]));
+                break;
+            case 4:
+                compositor.add(
+                        typename exprtk::function_compositor<decimal::Decimal>::function(v.first,
+                                                                                       v.second.expression,
+                                                                                       v.second.argumentNames[0],
+                                                                                       v.second.argumentNames[1],
+                                                                                       v.second.argumentNames[2],
+                                                                                       v.second.argumentNames[3]));
+                break;
+            case 5:
+                compositor.add(
+                        typename exprtk::function_compositor<decimal::Decimal>::function(v.first,
+                                                                                       v.second.expression,
+                                                                                       v.second.argumentNames[0],
+                                                                                       v.second.argumentNames[1],
+                                                                                       v.second.argumentNames[2],
+                                                                                       v.second.argumentNames[3],
+                                                                                       v.second.argumentNames[4]));
+                break;
+            default:
+                throw std::runtime_error("Too many function argumentNames");
+        }
+
+        if (v.second.pure) {
+            // Replace the compiled function in the symbol table with a memoizing wrapper,
+            // functions added afterwards which call this function are compiled against the wrapper.
+            auto *function = symbols.get_function(v.first);
+            if (function == nullptr)
+                continue;
+            int index = memoIndex++;
+            assert(index < memoCount);
+            memoFunctions.at(index) = MemoFunction<decimal::Decimal>(function,
+                                                                     &MemoCache::getCache(v.first,
+                                                                                          getFunctionSignature(
+                                                                                                  v.second)));
+            symbols.remove_function(v.first);
+            symbols.add_function(v.first, memoFunctions.at(index));
+        }
+    }
+
+    for (auto &constant: symbolTable.getConstants()) {
+        symbols.add_constant(constant.first, constant.second);
+    }
+
+    data->variables = symbolTable.getVariables();
+    for (auto &variable: data->variables) {
+        symbols.add_variable(variable.first, variable.second);
+    }
+
+    if (symbolTable.getUseBuiltInConstants()) {
+        symbols.add_constants();
+    }
+
+    data->expression.register_symbol_table(symbols);
+
+    exprtk::parser<decimal::Decimal> parser;
+    if (!parser.compile(expr, data->expression)) {
+        throw std::runtime_error(parser.error());
+    }
+}
+
+CompiledExpression::~CompiledExpression() = default;
+
+decimal::Decimal CompiledExpression::value() {
+    ScriptWatchdog::Evaluation evaluation;
+    return data->expression.value();
+}
+
+const std::map<std::string, decimal::Decimal> &CompiledExpression::getVariables() const {
+    return data->variables;
+}
+
+void CompiledExpression::setVariable(const std::string &name, const decimal::Decimal &value) {
+    auto it = data->variables.find(name);
+    if (it == data->variables.end()) {
+        throw std::runtime_error("No variable with name " + name);
+    }
+    it->second = value;
+}
@@ -0,0 +1,75 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_COMPILEDEXPRESSION_HPP
+#define QCALC_COMPILEDEXPRESSION_HPP
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include <decimal.hh>
+
+#include "calculator/symboltable.hpp"
+
+/**
+ * A compiled expression which can be evaluated repeatedly without parsing the expression
+ * or building the exprtk symbol table again.
+ *
+ * The variables of the symbol table are bound by reference,
+ * changing a variable with setVariable() affects the next call to value()
+ * and assignments in the expression are visible through getVariables().
+ *
+ * The script callbacks referenced by the symbol table must stay valid for the lifetime of the compiled expression.
+ */
+class CompiledExpression {
+public:
+    /**
+     * Throws std::runtime_error containing the parser error if the expression could not be compiled.
+     *
+     * @param expr The mathematical expression which may contain symbols defined in the table.
+     * @param symbolTable The symbol table to use when evaluating the expression.
+     */
+    CompiledExpression(const std::string &expr, const SymbolTable &symbolTable);
+
+    ~CompiledExpression();
+
+    CompiledExpression(const CompiledExpression &other) = delete;
+
+    CompiledExpression &operator=(const CompiledExpression &other) = delete;
+
+    /**
+     * @return The value of the expression using the current values of the variables.
+     */
+    decimal::Decimal value();
+
+    const std::map<std::string, decimal::Decimal> &getVariables() const;
+
+    /**
+     * Throws std::runtime_error if the symbol table did not define a variable with the given name.
+     */
+    void setVariable(const std::string &name, const decimal::Decimal &value);
+
+private:
+    struct Data;
+
+    std::unique_ptr<Data> data;
+};
+
+#endif //QCALC_COMPILEDEXPRESSION_HPP
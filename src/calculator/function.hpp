@@ -28,14 +28,15 @@
 struct Function {
     std::string expression;
     std::vector<std::string> argumentNames;
+    bool pure = false; // If true the results are memoized by the expression parser.
 
     Function() : expression(), argumentNames() {};
 
-    Function(std::string expression, std::vector<std::string> arguments)
-            : expression(std::move(expression)), argumentNames(std::move(arguments)) {}
+    Function(std::string expression, std::vector<std::string> arguments, bool pure = false)
+            : expression(std::move(expression)), argumentNames(std::move(arguments)), pure(pure) {}
 
     bool operator==(const Function &other) const {
-        return expression == other.expression && argumentNames == other.argumentNames;
+        return expression == other.expression && argumentNames == other.argumentNames && pure == other.pure;
     }
 };
 
@@ -0,0 +1,150 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "calculator/memocache.hpp"
+
+#include <memory>
+
+static std::mutex cachesMutex;
+static std::map<std::string, std::unique_ptr<MemoCache>> caches;
+
+MemoCache &MemoCache::getCache(const std::string &name, const std::string &signature) {
+    std::lock_guard<std::mutex> guard(cachesMutex);
+    auto &cache = caches[name];
+    if (!cache) {
+        cache = std::make_unique<MemoCache>();
+    }
+    if (cache->signature != signature) {
+        cache->clear();
+        cache->signature = signature;
+    }
+    return *cache;
+}
+
+std::map<std::string, MemoCache::Statistics> MemoCache::getStatistics() {
+    std::lock_guard<std::mutex> guard(cachesMutex);
+    std::map<std::string, Statistics> ret;
+    for (auto &pair: caches) {
+        ret[pair.first] = pair.second->statistics();
+    }
+    return ret;
+}
+
+void MemoCache::clearAll() {
+    std::lock_guard<std::mutex> guard(cachesMutex);
+    for (auto &pair: caches) {
+        pair.second->clear();
+    }
+}
+
+MemoCache::MemoCache(size_t capacity)
+        : capacity(capacity) {}
+
+bool MemoCache::get(const std::vector<decimal::Decimal> &args, decimal::Decimal &result) {
+    auto key = createKey(args);
+
+    std::lock_guard<std::mutex> guard(mutex);
+
+    auto it = index.find(key);
+    if (it == index.end()) {
+        misses++;
+        return false;
+    }
+
+    // Move the entry to the front of the list, iterators stay valid when splicing.
+    entries.splice(entries.begin(), entries, it->second);
+
+    result = it->second->second;
+    hits++;
+    return true;
+}
+
+void MemoCache::put(const std::vector<decimal::Decimal> &args, const decimal::Decimal &result) {
+    auto key = createKey(args);
+
+    std::lock_guard<std::mutex> guard(mutex);
+
+    auto it = index.find(key);
+    if (it != index.end()) {
+        it->second->second = result;
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+
+    entries.emplace_front(key, result);
+    index[key] = entries.begin();
+
+    while (entries.size() > capacity) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+}
+
+void MemoCache::clear() {
+    std::lock_guard<std::mutex> guard(mutex);
+    entries.clear();
+    index.clear();
+    hits = 0;
+    misses = 0;
+}
+
+MemoCache::Statistics MemoCache::statistics() {
+    std::lock_guard<std::mutex> guard(mutex);
+    Statistics ret;
+    ret.hits = hits;
+    ret.misses = misses;
+    ret.entries = entries.size();
+    return ret;
+}
+
+MemoCache::Key MemoCache::createKey(const std::vector<decimal::Decimal> &args) {
+    Key ret;
+    ret.prec = decimal::context.prec();
+    ret.round = decimal::context.round();
+    ret.arguments.reserve(args.size());
+    for (auto &arg: args) {
+        const mpd_t *v = arg.getconst();
+        Argument a;
+        // Only the sign and special value bits identify the value, the remaining bits describe the memory allocation.
+        a.flags = v->flags & (MPD_NEG | MPD_SPECIAL);
+        a.exp = v->exp;
+        a.digits = v->digits;
+        a.coefficient = std::vector<mpd_uint_t>(v->data, v->data + v->len);
+        ret.arguments.emplace_back(std::move(a));
+    }
+    return ret;
+}
+
+bool MemoCache::Argument::operator<(const Argument &other) const {
+    if (flags != other.flags)
+        return flags < other.flags;
+    if (exp != other.exp)
+        return exp < other.exp;
+    if (digits != other.digits)
+        return digits < other.digits;
+    return coefficient < other.coefficient;
+}
+
+bool MemoCache::Key::operator<(const Key &other) const {
+    if (prec != other.prec)
+        return prec < other.prec;
+    if (round != other.round)
+        return round < other.round;
+    return arguments < other.arguments;
+}
@@ -0,0 +1,127 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_MEMOCACHE_HPP
+#define QCALC_MEMOCACHE_HPP
+
+#include <map>
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <decimal.hh>
+
+/**
+ * A bounded least recently used cache of results for symbols which are flagged as pure.
+ *
+ * Entries are keyed by the exact coefficient, exponent and sign of each argument decimal
+ * together with the precision and rounding mode of the current decimal context,
+ * therefore a lookup never converts the arguments to strings and changing the context never returns stale results.
+ *
+ * One cache instance exists per symbol name, the instances are created on demand by getCache()
+ * and live until the application exits.
+ */
+class MemoCache {
+public:
+    static const size_t DEFAULT_CAPACITY = 1024;
+
+    struct Statistics {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t entries = 0;
+
+        double hitRate() const {
+            auto total = hits + misses;
+            return total == 0 ? 0 : static_cast<double>(hits) / static_cast<double>(total);
+        }
+    };
+
+    /**
+     * Get the cache for the symbol with the given name.
+     *
+     * If the signature differs from the signature of the previous call with the same name
+     * the cached entries are discarded, this ensures that editing the definition of a symbol invalidates its results.
+     *
+     * @param name The name of the symbol
+     * @param signature A string which uniquely identifies the definition of the symbol. (eg. the function expression)
+     * @return The cache instance, the reference stays valid for the lifetime of the application.
+     */
+    static MemoCache &getCache(const std::string &name, const std::string &signature);
+
+    /**
+     * @return The statistics of all caches which were created by getCache() mapped by symbol name.
+     */
+    static std::map<std::string, Statistics> getStatistics();
+
+    /**
+     * Discard the entries and reset the statistics of all caches.
+     */
+    static void clearAll();
+
+    explicit MemoCache(size_t capacity = DEFAULT_CAPACITY);
+
+    /**
+     * @param args The argument values
+     * @param result Set to the cached result if an entry exists
+     * @return True if an entry for the arguments exists
+     */
+    bool get(const std::vector<decimal::Decimal> &args, decimal::Decimal &result);
+
+    void put(const std::vector<decimal::Decimal> &args, const decimal::Decimal &result);
+
+    void clear();
+
+    Statistics statistics();
+
+private:
+    struct Argument {
+        uint8_t flags;
+        mpd_ssize_t exp;
+        mpd_ssize_t digits;
+        std::vector<mpd_uint_t> coefficient;
+
+        bool operator<(const Argument &other) const;
+    };
+
+    struct Key {
+        mpd_ssize_t prec;
+        int round;
+        std::vector<Argument> arguments;
+
+        bool operator<(const Key &other) const;
+    };
+
+    typedef std::list<std::pair<Key, decimal::Decimal>> EntryList;
+
+    static Key createKey(const std::vector<decimal::Decimal> &args);
+
+    std::mutex mutex;
+
+    size_t capacity;
+    std::string signature;
+
+    EntryList entries; // Ordered from most recently used to least recently used
+    std::map<Key, EntryList::iterator> index;
+
+    size_t hits = 0;
+    size_t misses = 0;
+};
+
+#endif //QCALC_MEMOCACHE_HPP
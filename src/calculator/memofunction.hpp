@@ -0,0 +1,81 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_MEMOFUNCTION_HPP
+#define QCALC_MEMOFUNCTION_HPP
+
+#include "exprtk.hpp"
+
+#include "calculator/memocache.hpp"
+
+/**
+ * The MemoFunction wraps a function of the compositor and returns cached results for previously seen arguments.
+ * Only invocations from outside the wrapped function body are memoized,
+ * recursive calls inside the body are bound to the compositor function at compile time.
+ */
+template<typename T>
+struct MemoFunction : public exprtk::ifunction<T> {
+    using exprtk::ifunction<T>::operator();
+
+    MemoFunction()
+            : exprtk::ifunction<T>(0), function(nullptr), cache(nullptr) {}
+
+    MemoFunction(exprtk::ifunction<T> *function, MemoCache *cache)
+            : exprtk::ifunction<T>(function->param_count), function(function), cache(cache) {}
+
+    inline T operator()() {
+        return invoke({}, [this]() { return (*function)(); });
+    }
+
+    inline T operator()(const T &v0) {
+        return invoke({v0}, [&]() { return (*function)(v0); });
+    }
+
+    inline T operator()(const T &v0, const T &v1) {
+        return invoke({v0, v1}, [&]() { return (*function)(v0, v1); });
+    }
+
+    inline T operator()(const T &v0, const T &v1, const T &v2) {
+        return invoke({v0, v1, v2}, [&]() { return (*function)(v0, v1, v2); });
+    }
+
+    inline T operator()(const T &v0, const T &v1, const T &v2, const T &v3) {
+        return invoke({v0, v1, v2, v3}, [&]() { return (*function)(v0, v1, v2, v3); });
+    }
+
+    inline T operator()(const T &v0, const T &v1, const T &v2, const T &v3, const T &v4) {
+        return invoke({v0, v1, v2, v3, v4}, [&]() { return (*function)(v0, v1, v2, v3, v4); });
+    }
+
+private:
+    template<typename F>
+    inline T invoke(const std::vector<T> &args, F f) {
+        T ret;
+        if (cache->get(args, ret))
+            return ret;
+        ret = f();
+        cache->put(args, ret);
+        return ret;
+    }
+
+    exprtk::ifunction<T> *function;
+    MemoCache *cache;
+};
+
+#endif //QCALC_MEMOFUNCTION_HPP
@@ -0,0 +1,138 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "calculator/runtimestatistics.hpp"
+
+#include <map>
+#include <mutex>
+#include <algorithm>
+#include <sstream>
+
+struct EntryData {
+    RuntimeStatistics::Entry entry;
+    std::vector<double> samples; // Ring buffer of the most recent call durations
+    size_t nextSample = 0;
+};
+
+static std::mutex mutex;
+static std::map<std::pair<RuntimeStatistics::Kind, std::string>, EntryData> entryData;
+
+static double percentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty())
+        return 0;
+    auto index = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted.at(std::min(index, sorted.size() - 1));
+}
+
+static std::string escapeCsv(const std::string &str) {
+    if (str.find_first_of(",\"\n") == std::string::npos)
+        return str;
+    std::string ret = "\"";
+    for (auto c: str) {
+        if (c == '"')
+            ret += '"';
+        ret += c;
+    }
+    return ret + "\"";
+}
+
+void RuntimeStatistics::record(Kind kind, const std::string &name, const Sample &sample) {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    auto &d = entryData[{kind, name}];
+    auto &entry = d.entry;
+    entry.calls++;
+    entry.totalTime += sample.time;
+    entry.marshalTime += sample.marshalTime;
+    entry.gilWaitTime += sample.gilWaitTime;
+    entry.maxTime = std::max(entry.maxTime, sample.time);
+    if (sample.failed)
+        entry.failures++;
+    if (sample.timedOut)
+        entry.timeouts++;
+
+    if (d.samples.size() < SAMPLE_COUNT) {
+        d.samples.emplace_back(sample.time);
+    } else {
+        d.samples.at(d.nextSample) = sample.time;
+        d.nextSample = (d.nextSample + 1) % SAMPLE_COUNT;
+    }
+}
+
+std::vector<RuntimeStatistics::Entry> RuntimeStatistics::getEntries() {
+    std::vector<Entry> ret;
+    std::vector<double> sorted;
+
+    std::lock_guard<std::mutex> guard(mutex);
+    for (auto &pair: entryData) {
+        Entry entry = pair.second.entry;
+        entry.kind = pair.first.first;
+        entry.name = pair.first.second;
+
+        sorted = pair.second.samples;
+        std::sort(sorted.begin(), sorted.end());
+        entry.p50 = percentile(sorted, 0.5);
+        entry.p90 = percentile(sorted, 0.9);
+        entry.p99 = percentile(sorted, 0.99);
+
+        ret.emplace_back(entry);
+    }
+    return ret;
+}
+
+void RuntimeStatistics::reset() {
+    std::lock_guard<std::mutex> guard(mutex);
+    entryData.clear();
+}
+
+std::string RuntimeStatistics::getKindName(Kind kind) {
+    switch (kind) {
+        case SCRIPT:
+            return "script";
+        case ADDON_LOAD:
+            return "load";
+        case ADDON_UNLOAD:
+            return "unload";
+        case ADDON_RELOAD:
+            return "reload";
+        default:
+            return "unknown";
+    }
+}
+
+std::string RuntimeStatistics::toCsv(const std::vector<Entry> &entries) {
+    std::ostringstream stream;
+    stream << "kind,name,calls,failures,timeouts,total_ms,mean_ms,max_ms,p50_ms,p90_ms,p99_ms,marshal_ms,gil_wait_ms\n";
+    for (auto &entry: entries) {
+        stream << getKindName(entry.kind) << ','
+               << escapeCsv(entry.name) << ','
+               << entry.calls << ','
+               << entry.failures << ','
+               << entry.timeouts << ','
+               << entry.totalTime << ','
+               << entry.meanTime() << ','
+               << entry.maxTime << ','
+               << entry.p50 << ','
+               << entry.p90 << ','
+               << entry.p99 << ','
+               << entry.marshalTime << ','
+               << entry.gilWaitTime << '\n';
+    }
+    return stream.str();
+}
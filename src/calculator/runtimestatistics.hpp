@@ -0,0 +1,93 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_RUNTIMESTATISTICS_HPP
+#define QCALC_RUNTIMESTATISTICS_HPP
+
+#include <string>
+#include <vector>
+
+/**
+ * Collects the runtime of script calls and addon callbacks.
+ *
+ * Each entry accumulates the call count and the cumulative times of all calls,
+ * the percentiles are computed from the durations of the most recent SAMPLE_COUNT calls.
+ */
+class RuntimeStatistics {
+public:
+    static const size_t SAMPLE_COUNT = 1024;
+
+    enum Kind {
+        SCRIPT,
+        ADDON_LOAD,
+        ADDON_UNLOAD,
+        ADDON_RELOAD
+    };
+
+    /**
+     * The measurements of a single call in milliseconds.
+     */
+    struct Sample {
+        double time = 0; // The total duration including marshaling and waiting for the GIL
+        double marshalTime = 0; // Converting arguments to python objects and the result back
+        double gilWaitTime = 0; // Waiting to acquire the GIL
+        bool failed = false;
+        bool timedOut = false;
+    };
+
+    struct Entry {
+        Kind kind = SCRIPT;
+        std::string name; // The script name or the addon module name
+        size_t calls = 0;
+        size_t failures = 0;
+        size_t timeouts = 0;
+        double totalTime = 0;
+        double maxTime = 0;
+        double marshalTime = 0;
+        double gilWaitTime = 0;
+        double p50 = 0;
+        double p90 = 0;
+        double p99 = 0;
+
+        double meanTime() const {
+            return calls == 0 ? 0 : totalTime / static_cast<double>(calls);
+        }
+    };
+
+    static void record(Kind kind, const std::string &name, const Sample &sample);
+
+    /**
+     * @return A snapshot of all entries ordered by kind and name.
+     */
+    static std::vector<Entry> getEntries();
+
+    static void reset();
+
+    /**
+     * @return The name of the kind as used in the csv export and the python api. (eg. "script", "load")
+     */
+    static std::string getKindName(Kind kind);
+
+    /**
+     * @return The entries formatted as comma separated values with a header line.
+     */
+    static std::string toCsv(const std::vector<Entry> &entries);
+};
+
+#endif //QCALC_RUNTIMESTATISTICS_HPP
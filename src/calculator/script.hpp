@@ -21,6 +21,7 @@
 #define QCALC_SCRIPT_HPP
 
 #include <string>
+#include <vector>
 #include <utility>
 
 struct _object;
@@ -29,14 +30,19 @@ typedef _object PyObject;
 struct Script {
     PyObject *callback = nullptr;
     std::vector<std::string> arguments = {}; //If not empty the script is wrapped by a vararg function otherwise a function with 0 arguments is used.
+    bool pure = false; // If true the results are memoized and the callback is only invoked for unseen arguments.
+    bool batched = false; // If true the callback receives a list of argument tuples and returns a list of results.
 
     Script() = default;
 
-    Script(PyObject *callback, std::vector<std::string> arguments)
-            : callback(callback), arguments(std::move(arguments)) {}
+    Script(PyObject *callback, std::vector<std::string> arguments, bool pure = false, bool batched = false)
+            : callback(callback), arguments(std::move(arguments)), pure(pure), batched(batched) {}
 
     bool operator==(const Script &other) const {
-        return callback == other.callback && arguments == other.arguments;
+        return callback == other.callback
+               && arguments == other.arguments
+               && pure == other.pure
+               && batched == other.batched;
     }
 };
 
@@ -0,0 +1,131 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_SCRIPTBATCHFUNCTION_HPP
+#define QCALC_SCRIPTBATCHFUNCTION_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <stdexcept>
+
+#include "exprtk.hpp"
+
+#include "calculator/scripthandler.hpp"
+
+struct _object;
+typedef _object PyObject;
+
+/**
+ * The ScriptBatchFunction executes a batched python function.
+ * The script receives a list of argument tuples and must return a list with one result per tuple.
+ *
+ * When invoked with the declared number of scalar arguments the script is called with a batch
+ * containing a single tuple and the result is returned.
+ *
+ * A batch is requested by passing an output vector after the declared arguments.
+ * The function is then evaluated for every element of the output vector in a single call into python,
+ * vector arguments must have the size of the output vector and scalar arguments are passed unchanged to every call.
+ * The results are written into the output vector, the arguments are never modified, and the result of the last call is returned.
+ *
+ * eg. var x[3] := {1, 2, 3}; var y[3]; f(x, y) evaluates f(1), f(2) and f(3) with one call into python and stores the results in y.
+ */
+template<typename T>
+class ScriptBatchFunction : public exprtk::igeneric_function<T> {
+public:
+    typedef typename exprtk::igeneric_function<T>::parameter_list_t parameter_list_t;
+    typedef typename exprtk::igeneric_function<T>::generic_type generic_type;
+    typedef typename generic_type::scalar_view scalar_t;
+    typedef typename generic_type::vector_view vector_t;
+
+    using exprtk::igeneric_function<T>::operator();
+
+    ScriptBatchFunction() {
+        exprtk::enable_zero_parameters(*this);
+    }
+
+    /**
+     * @param argumentCount The number of arguments declared by the script, an additional vector argument is the output.
+     */
+    ScriptBatchFunction(PyObject *callback, std::string name, size_t argumentCount, MemoCache *cache = nullptr)
+            : callback(callback), name(std::move(name)), argumentCount(argumentCount), cache(cache) {
+        exprtk::enable_zero_parameters(*this);
+    }
+
+    inline T operator()(parameter_list_t parameters) {
+        size_t inputCount = parameters.size();
+        bool hasOutput = false;
+        size_t batchSize = 1;
+        if (parameters.size() == argumentCount + 1) {
+            if (parameters[argumentCount].type != generic_type::e_vector)
+                throw std::runtime_error("The output argument of batched script " + name + " must be a vector");
+            hasOutput = true;
+            inputCount = argumentCount;
+            batchSize = parameters[argumentCount].size;
+        } else if (parameters.size() != argumentCount) {
+            throw std::runtime_error("Batched script " + name + " expects " + std::to_string(argumentCount)
+                                     + " arguments and an optional output vector");
+        }
+
+        for (size_t i = 0; i < inputCount; i++) {
+            auto &parameter = parameters[i];
+            if (parameter.type == generic_type::e_vector) {
+                if (!hasOutput)
+                    throw std::runtime_error("Vector arguments of batched script " + name + " require an output vector");
+                if (parameter.size != batchSize)
+                    throw std::runtime_error("Vector arguments of batched script must have the size of the output vector");
+            } else if (parameter.type != generic_type::e_scalar) {
+                throw std::runtime_error("Batched script arguments must be scalars or vectors");
+            }
+        }
+
+        std::vector<std::vector<T>> batch(batchSize);
+        for (size_t call = 0; call < batchSize; call++) {
+            auto &args = batch.at(call);
+            args.reserve(inputCount);
+            for (size_t i = 0; i < inputCount; i++) {
+                auto &parameter = parameters[i];
+                if (parameter.type == generic_type::e_vector) {
+                    args.emplace_back(vector_t(parameter)[call]);
+                } else {
+                    args.emplace_back(scalar_t(parameter)());
+                }
+            }
+        }
+
+        auto results = ScriptHandler::runBatch(callback, name, batch, cache);
+
+        if (hasOutput) {
+            vector_t output(parameters[argumentCount]);
+            for (size_t i = 0; i < results.size(); i++) {
+                output[i] = results.at(i);
+            }
+        }
+
+        return results.empty() ? T() : results.back();
+    }
+
+private:
+    PyObject *callback = nullptr;
+    std::string name;
+    size_t argumentCount = 0;
+    MemoCache *cache = nullptr;
+};
+
+#endif //QCALC_SCRIPTBATCHFUNCTION_HPP
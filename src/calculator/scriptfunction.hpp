@@ -21,6 +21,7 @@
 #define QCALC_SCRIPTFUNCTION_HPP
 
 #include <string>
+#include <utility>
 
 #include "exprtk.hpp"
 
@@ -31,24 +32,26 @@ typedef _object PyObject;
 
 /**
  * The ScriptFunction executes a python function with no arguments.
- * The script must return the result value as a string, float or int.
+ * The script must return the result value as a decimal.Decimal, string, float or int.
  */
 template<typename T>
 struct ScriptFunction : public exprtk::ifunction<T> {
     using exprtk::ifunction<T>::operator();
 
     ScriptFunction()
-            : exprtk::ifunction<T>(0), callback(nullptr) {}
+            : exprtk::ifunction<T>(0), callback(nullptr), cache(nullptr) {}
 
-    explicit ScriptFunction(PyObject *callback)
-            : exprtk::ifunction<T>(0), callback(callback) {}
+    ScriptFunction(PyObject *callback, std::string name, MemoCache *cache = nullptr)
+            : exprtk::ifunction<T>(0), callback(callback), name(std::move(name)), cache(cache) {}
 
     inline T operator()() {
-        return ScriptHandler::run(callback, {});
+        return ScriptHandler::run(callback, name, {}, cache);
     }
 
 private:
     PyObject *callback;
+    std::string name;
+    MemoCache *cache;
 };
 
 #endif //QCALC_SCRIPTFUNCTION_HPP
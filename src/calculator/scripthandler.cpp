@@ -19,12 +19,53 @@
 
 #include "calculator/scripthandler.hpp"
 
+#include <chrono>
+#include <exception>
+
 #include "python/pythoninclude.hpp"
 #include "python/interpreter.hpp"
 
 #include "python/interpreterhandler.hpp"
+#include "python/decimalutil.hpp"
+#include "python/interpreterpool.hpp"
+
+#include "calculator/scriptwatchdog.hpp"
+#include "calculator/runtimestatistics.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static double millisecondsSince(const Clock::time_point &start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * Records the runtime of a script call when destroyed,
+ * the call is counted as failed if the destructor runs because of an exception.
+ */
+class CallRecord {
+public:
+    explicit CallRecord(const std::string &name)
+            : name(name), start(Clock::now()), exceptions(std::uncaught_exceptions()) {}
+
+    ~CallRecord() {
+        sample.time = millisecondsSince(start);
+        sample.failed = sample.failed || std::uncaught_exceptions() > exceptions;
+        RuntimeStatistics::record(RuntimeStatistics::SCRIPT, name, sample);
+    }
+
+    CallRecord(const CallRecord &other) = delete;
+
+    CallRecord &operator=(const CallRecord &other) = delete;
+
+    RuntimeStatistics::Sample sample;
+
+private:
+    const std::string &name;
+    Clock::time_point start;
+    int exceptions;
+};
 
-decimal::Decimal ScriptHandler::run(PyObject *c, const std::vector<decimal::Decimal> &a) {
+static void checkInitialized(PyObject *c) {
     if (!InterpreterHandler::waitForInitialization()) {
         throw std::runtime_error("Python is not initialized");
     }
@@ -36,37 +77,209 @@ decimal::Decimal ScriptHandler::run(PyObject *c, const std::vector<decimal::Deci
     if (c == NULL) {
         throw std::runtime_error("Null callback in script handler");
     }
+}
 
+static PyObject *createArguments(const std::vector<decimal::Decimal> &a) {
     PyObject *args = PyTuple_New(a.size());
     for (auto i = 0; i < a.size(); i++) {
-        auto &v = a.at(i);
-        PyObject *f = PyUnicode_FromString(v.format("f").c_str());
-        PyTuple_SetItem(args, i, f);
+        PyObject *v;
+        try {
+            v = DecimalUtil::New(a.at(i));
+        } catch (const std::exception &e) {
+            Py_DECREF(args);
+            throw;
+        }
+        PyTuple_SetItem(args, i, v);
     }
+    return args;
+}
 
-    PyObject *pyRet = PyObject_Call(c, args, NULL);
-    Py_DECREF(args);
+decimal::Decimal ScriptHandler::run(PyObject *c,
+                                    const std::string &name,
+                                    const std::vector<decimal::Decimal> &a,
+                                    MemoCache *cache) {
+    decimal::Decimal ret;
 
-    if (pyRet == NULL) {
-        throw std::runtime_error(Interpreter::getError());
+    if (cache != nullptr && cache->get(a, ret)) {
+        return ret;
     }
 
-    decimal::Decimal ret;
+    checkInitialized(c);
+
+    CallRecord record(name);
+
+    auto gilStart = Clock::now();
+    PyGILState_STATE gstate = PyGILState_Ensure();
+    record.sample.gilWaitTime = millisecondsSince(gilStart);
+
+    try {
+        PyObject *pyRet;
+        {
+            ScriptWatchdog::Call call(name);
+
+            auto marshalStart = Clock::now();
+            PyObject *args = createArguments(a);
+            record.sample.marshalTime = millisecondsSince(marshalStart);
+
+            pyRet = PyObject_Call(c, args, NULL);
+            Py_DECREF(args);
+
+            if (call.timedOut()) {
+                // The script may have caught the TimeoutError, a timed out call fails regardless of its result.
+                Py_XDECREF(pyRet);
+                PyErr_Clear();
+                record.sample.timedOut = true;
+                throw std::runtime_error(call.getTimeoutMessage());
+            }
+        }
+
+        if (pyRet == NULL) {
+            throw std::runtime_error(Interpreter::getError());
+        }
+
+        auto marshalStart = Clock::now();
+        try {
+            ret = DecimalUtil::Convert(pyRet);
+        } catch (const std::exception &e) {
+            Py_DECREF(pyRet);
+            throw;
+        }
+        record.sample.marshalTime += millisecondsSince(marshalStart);
+
+        Py_DECREF(pyRet);
+    } catch (const std::exception &e) {
+        PyGILState_Release(gstate);
+        throw;
+    }
 
-    if (PyUnicode_Check(pyRet)) {
-        auto *str = PyUnicode_AsUTF8(pyRet);
-        ret = decimal::Decimal(str);
-    } else if (PyFloat_Check(pyRet)) {
-        ret = decimal::Decimal(std::to_string(PyFloat_AsDouble(pyRet)));
-    } else if (PyLong_Check(pyRet)) {
-        ret = decimal::Decimal(std::to_string(PyLong_AsDouble(pyRet)));
+    PyGILState_Release(gstate);
+
+    if (cache != nullptr) {
+        cache->put(a, ret);
     }
 
-    if (PyErr_Occurred() != NULL) {
-        throw std::runtime_error(Interpreter::getError());
+    return ret;
+}
+
+std::vector<decimal::Decimal> ScriptHandler::runBatch(PyObject *c,
+                                                      const std::string &name,
+                                                      const std::vector<std::vector<decimal::Decimal>> &a,
+                                                      MemoCache *cache) {
+    std::vector<decimal::Decimal> ret(a.size());
+
+    std::vector<size_t> pending; // The indices of the argument sets which have to be passed to the callback
+    for (size_t i = 0; i < a.size(); i++) {
+        if (cache == nullptr || !cache->get(a.at(i), ret.at(i))) {
+            pending.emplace_back(i);
+        }
     }
 
-    Py_DECREF(pyRet);
+    if (pending.empty()) {
+        return ret;
+    }
+
+    checkInitialized(c);
+
+    CallRecord record(name);
+
+    // Pure scripts have no side effects in the main interpreter and can therefore run in the worker interpreters.
+    // Single calls are not sent to the pool, the evaluating thread would wait for the worker in any case.
+    if (cache != nullptr && InterpreterPool::isRunning()) {
+        std::vector<std::vector<decimal::Decimal>> pendingArgs;
+        pendingArgs.reserve(pending.size());
+        for (auto index: pending) {
+            pendingArgs.emplace_back(a.at(index));
+        }
+
+        std::vector<decimal::Decimal> results;
+        if (InterpreterPool::runBatch(c, name, pendingArgs, results)) {
+            for (size_t i = 0; i < pending.size(); i++) {
+                ret.at(pending.at(i)) = results.at(i);
+                cache->put(a.at(pending.at(i)), results.at(i));
+            }
+            return ret;
+        }
+    }
+
+    auto gilStart = Clock::now();
+    PyGILState_STATE gstate = PyGILState_Ensure();
+    record.sample.gilWaitTime = millisecondsSince(gilStart);
+
+    try {
+        PyObject *pyRet;
+        {
+            ScriptWatchdog::Call call(name);
+
+            auto marshalStart = Clock::now();
+            PyObject *batch = PyList_New(pending.size());
+            for (auto i = 0; i < pending.size(); i++) {
+                PyObject *args;
+                try {
+                    args = createArguments(a.at(pending.at(i)));
+                } catch (const std::exception &e) {
+                    Py_DECREF(batch);
+                    throw;
+                }
+                PyList_SetItem(batch, i, args);
+            }
+            record.sample.marshalTime = millisecondsSince(marshalStart);
+
+            pyRet = PyObject_CallOneArg(c, batch);
+            Py_DECREF(batch);
+
+            if (call.timedOut()) {
+                Py_XDECREF(pyRet);
+                PyErr_Clear();
+                record.sample.timedOut = true;
+                throw std::runtime_error(call.getTimeoutMessage());
+            }
+        }
+
+        if (pyRet == NULL) {
+            throw std::runtime_error(Interpreter::getError());
+        }
+
+        PyObject *results = PySequence_Fast(pyRet, "Batched script must return a sequence");
+        Py_DECREF(pyRet);
+
+        if (results == NULL) {
+            throw std::runtime_error(Interpreter::getError());
+        }
+
+        if (PySequence_Fast_GET_SIZE(results) != pending.size()) {
+            auto size = PySequence_Fast_GET_SIZE(results);
+            Py_DECREF(results);
+            throw std::runtime_error("Batched script returned "
+                                     + std::to_string(size)
+                                     + " results for "
+                                     + std::to_string(pending.size())
+                                     + " calls");
+        }
+
+        auto marshalStart = Clock::now();
+        try {
+            for (auto i = 0; i < pending.size(); i++) {
+                ret.at(pending.at(i)) = DecimalUtil::Convert(PySequence_Fast_GET_ITEM(results, i)); //Borrowed
+            }
+        } catch (const std::exception &e) {
+            Py_DECREF(results);
+            throw;
+        }
+        record.sample.marshalTime += millisecondsSince(marshalStart);
+
+        Py_DECREF(results);
+    } catch (const std::exception &e) {
+        PyGILState_Release(gstate);
+        throw;
+    }
+
+    PyGILState_Release(gstate);
+
+    if (cache != nullptr) {
+        for (auto index: pending) {
+            cache->put(a.at(index), ret.at(index));
+        }
+    }
 
     return ret;
-}
\ No newline at end of file
+}
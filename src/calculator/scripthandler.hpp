@@ -26,12 +26,49 @@
 
 #include <decimal.hh>
 
+#include "calculator/memocache.hpp"
+
 struct _object;
 typedef _object PyObject;
 
 class ScriptHandler {
 public:
-    static decimal::Decimal run(PyObject *callback, const std::vector<decimal::Decimal> &args);
+    /**
+     * Invoke the callback with the given arguments.
+     *
+     * If a cache is passed and contains an entry for the arguments the cached result is returned
+     * without acquiring the GIL or converting the arguments to python objects.
+     *
+     * Throws std::runtime_error if the callback raised an exception or exceeded the time budget of the ScriptWatchdog.
+     *
+     * @param callback The python callable
+     * @param name The name of the script, used for the time statistics and error messages
+     * @param args The argument values
+     * @param cache The memo cache of the script or null if the script is not pure.
+     * @return The result value returned by the callback
+     */
+    static decimal::Decimal run(PyObject *callback,
+                                const std::string &name,
+                                const std::vector<decimal::Decimal> &args,
+                                MemoCache *cache = nullptr);
+
+    /**
+     * Invoke a batched callback once for all given argument sets.
+     *
+     * The callback receives a single list argument containing one tuple of arguments per call
+     * and must return a sequence containing one result per tuple.
+     * Argument sets which have an entry in the cache are not passed to the callback.
+     *
+     * @param callback The python callable
+     * @param name The name of the script, used for the time statistics and error messages
+     * @param args The argument values of each call
+     * @param cache The memo cache of the script or null if the script is not pure.
+     * @return The result values in the order of the argument sets
+     */
+    static std::vector<decimal::Decimal> runBatch(PyObject *callback,
+                                                  const std::string &name,
+                                                  const std::vector<std::vector<decimal::Decimal>> &args,
+                                                  MemoCache *cache = nullptr);
 };
 
 #endif //QCALC_SCRIPTHANDLER_HPP
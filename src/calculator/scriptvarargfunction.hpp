@@ -21,6 +21,7 @@
 #define QCALC_SCRIPTVARARGFUNCTION_HPP
 
 #include <string>
+#include <utility>
 #include <cassert>
 
 #include "exprtk.hpp"
@@ -33,23 +34,25 @@ typedef _object PyObject;
 /**
  * The ScriptVarArgFunction executes a python function a variable number of arguments.
  * Arguments are stored in a single args list argument.
- * Arguments are passed as string objects containing the number representation.
- * The script must return the result value as a string, float or int.
+ * Arguments are passed as decimal.Decimal objects.
+ * The script must return the result value as a decimal.Decimal, string, float or int.
  */
 template<typename T>
 class ScriptVarArgFunction : public exprtk::ivararg_function<T> {
 public:
     ScriptVarArgFunction() = default;
 
-    explicit ScriptVarArgFunction(PyObject* callback)
-            : callback(callback) {}
+    ScriptVarArgFunction(PyObject* callback, std::string name, MemoCache *cache = nullptr)
+            : callback(callback), name(std::move(name)), cache(cache) {}
 
     inline T operator()(const std::vector<T> &args) {
-        return ScriptHandler::run(callback, args);
+        return ScriptHandler::run(callback, name, args, cache);
     }
 
 private:
     PyObject* callback = nullptr;
+    std::string name;
+    MemoCache *cache = nullptr;
 };
 
 #endif //QCALC_SCRIPTVARARGFUNCTION_HPP
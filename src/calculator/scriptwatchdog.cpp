@@ -0,0 +1,268 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "calculator/scriptwatchdog.hpp"
+
+#include <map>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <stdexcept>
+
+#include "python/pythoninclude.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+namespace {
+    struct ActiveCall {
+        unsigned long threadId;
+        PyInterpreterState *interpreter;
+        Clock::time_point deadline;
+        bool fired;
+    };
+
+    std::atomic<int> callBudgetValue{10000};
+    std::atomic<int> evaluationBudgetValue{30000};
+
+    std::mutex mutex;
+    std::condition_variable interruptFinished;
+    PyInterpreterState *interruptedInterpreter = nullptr; // The interpreter which the watchdog thread is interrupting
+    std::condition_variable condition;
+    std::map<uint64_t, ActiveCall> activeCalls;
+    uint64_t nextToken = 0;
+
+    thread_local int evaluationDepth = 0;
+    thread_local int currentEvaluationBudget = 0;
+    thread_local Clock::time_point evaluationDeadline;
+
+    void raiseTimeout(uint64_t token) {
+        std::lock_guard<std::mutex> guard(mutex);
+        auto it = activeCalls.find(token);
+        if (it != activeCalls.end() && !it->second.fired) {
+            it->second.fired = true;
+            PyThreadState_SetAsyncExc(it->second.threadId, PyExc_TimeoutError);
+        }
+    }
+
+    /**
+     * Raise a TimeoutError in the thread running the call identified by the token if the call is still active.
+     *
+     * The GIL of the interpreter is acquired before checking the call, a running call holds the GIL
+     * from construction until destruction of its ScriptWatchdog::Call
+     * therefore the call cannot finish between the check and raising the exception.
+     *
+     * The caller must set the interrupted interpreter so that a sub interpreter is not ended while it is interrupted.
+     */
+    void interruptCall(uint64_t token, PyInterpreterState *interpreter) {
+        if (!Py_IsInitialized())
+            return;
+
+        if (interpreter == PyInterpreterState_Main()) {
+            PyGILState_STATE gstate = PyGILState_Ensure();
+            raiseTimeout(token);
+            PyGILState_Release(gstate);
+        } else {
+            // The GIL state api only supports the main interpreter.
+            PyThreadState *state = PyThreadState_New(interpreter);
+            PyEval_RestoreThread(state);
+            raiseTimeout(token);
+            PyThreadState_Clear(state);
+            PyThreadState_DeleteCurrent();
+        }
+    }
+
+    class WatchdogThread {
+    public:
+        ~WatchdogThread() {
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                shutdown = true;
+            }
+            condition.notify_all();
+            if (thread.joinable())
+                thread.join();
+        }
+
+        /**
+         * Start the thread if it is not running, must be called while holding the mutex.
+         */
+        void start() {
+            if (!thread.joinable()) {
+                thread = std::thread([this]() { loop(); });
+            }
+        }
+
+    private:
+        void loop() {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!shutdown) {
+                uint64_t token = 0;
+                PyInterpreterState *interpreter = nullptr;
+                auto deadline = Clock::time_point::max();
+                for (auto &pair: activeCalls) {
+                    if (!pair.second.fired && pair.second.deadline < deadline) {
+                        token = pair.first;
+                        interpreter = pair.second.interpreter;
+                        deadline = pair.second.deadline;
+                    }
+                }
+
+                if (token == 0) {
+                    condition.wait(lock);
+                } else if (Clock::now() < deadline) {
+                    condition.wait_until(lock, deadline);
+                } else {
+                    // The mutex must not be held while acquiring the GIL, the running call locks the mutex with the GIL held.
+                    // The interrupted interpreter is set before releasing the mutex because the call is known to be active
+                    // and its interpreter to be alive only while holding the mutex.
+                    interruptedInterpreter = interpreter;
+                    lock.unlock();
+                    interruptCall(token, interpreter);
+                    lock.lock();
+                    interruptedInterpreter = nullptr;
+                    interruptFinished.notify_all();
+                }
+            }
+        }
+
+        std::thread thread;
+        bool shutdown = false;
+    };
+
+    WatchdogThread watchdogThread;
+}
+
+ScriptWatchdog::Evaluation::Evaluation()
+        : outermost(evaluationDepth++ == 0) {
+    if (outermost) {
+        currentEvaluationBudget = evaluationBudgetValue;
+        evaluationDeadline = Clock::now() + std::chrono::milliseconds(currentEvaluationBudget);
+    }
+}
+
+ScriptWatchdog::Evaluation::~Evaluation() {
+    evaluationDepth--;
+}
+
+ScriptWatchdog::Call::Call(const std::string &name, const EvaluationState &evaluation)
+        : name(name),
+          token(0),
+          threadId(PyThread_get_thread_ident()),
+          interpreter(PyInterpreterState_Get()),
+          limitedByEvaluation(false),
+          budget(callBudgetValue) {
+    auto start = Clock::now();
+    auto deadline = Clock::time_point::max();
+    if (budget > 0) {
+        deadline = start + std::chrono::milliseconds(budget);
+    }
+
+    if (evaluation.budget > 0) {
+        if (evaluation.deadline <= start) {
+            throw std::runtime_error("Evaluation exceeded the time budget of "
+                                     + std::to_string(evaluation.budget)
+                                     + " ms before calling script "
+                                     + name);
+        }
+        if (evaluation.deadline < deadline) {
+            deadline = evaluation.deadline;
+            limitedByEvaluation = true;
+            budget = evaluation.budget;
+        }
+    }
+
+    if (deadline != Clock::time_point::max()) {
+        std::lock_guard<std::mutex> guard(mutex);
+        token = ++nextToken;
+        activeCalls[token] = {threadId, interpreter, deadline, false};
+        watchdogThread.start();
+        condition.notify_all();
+    }
+}
+
+ScriptWatchdog::Call::~Call() {
+    if (token == 0)
+        return;
+
+    bool fired;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        auto it = activeCalls.find(token);
+        fired = it->second.fired;
+        activeCalls.erase(it);
+    }
+
+    if (fired) {
+        // Discard the exception if the call returned before the interpreter raised it.
+        PyThreadState_SetAsyncExc(threadId, NULL);
+    }
+}
+
+bool ScriptWatchdog::Call::timedOut() const {
+    if (token == 0)
+        return false;
+    std::lock_guard<std::mutex> guard(mutex);
+    return activeCalls.at(token).fired;
+}
+
+std::string ScriptWatchdog::Call::getTimeoutMessage() const {
+    if (limitedByEvaluation) {
+        return "Evaluation exceeded the time budget of "
+               + std::to_string(budget)
+               + " ms in script "
+               + name;
+    } else {
+        return "Script "
+               + name
+               + " exceeded the time budget of "
+               + std::to_string(budget)
+               + " ms";
+    }
+}
+
+ScriptWatchdog::EvaluationState ScriptWatchdog::getEvaluationState() {
+    EvaluationState ret;
+    if (evaluationDepth > 0) {
+        ret.budget = currentEvaluationBudget;
+        ret.deadline = evaluationDeadline;
+    }
+    return ret;
+}
+
+void ScriptWatchdog::releaseInterpreter(PyInterpreterState *interpreter) {
+    std::unique_lock<std::mutex> lock(mutex);
+    interruptFinished.wait(lock, [interpreter]() { return interruptedInterpreter != interpreter; });
+}
+
+void ScriptWatchdog::setCallBudget(int milliseconds) {
+    callBudgetValue = milliseconds;
+}
+
+int ScriptWatchdog::getCallBudget() {
+    return callBudgetValue;
+}
+
+void ScriptWatchdog::setEvaluationBudget(int milliseconds) {
+    evaluationBudgetValue = milliseconds;
+}
+
+int ScriptWatchdog::getEvaluationBudget() {
+    return evaluationBudgetValue;
+}
@@ -0,0 +1,133 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_SCRIPTWATCHDOG_HPP
+#define QCALC_SCRIPTWATCHDOG_HPP
+
+#include <string>
+#include <chrono>
+#include <cstdint>
+
+struct _is;
+typedef _is PyInterpreterState;
+
+/**
+ * The ScriptWatchdog enforces time budgets on python script calls.
+ *
+ * Every script call is limited by the call budget and by the remaining budget of the evaluation which invoked it.
+ * When a budget expires a watchdog thread raises a TimeoutError in the python thread which is running the script.
+ * The exception is raised asynchronously by the interpreter at the next bytecode boundary,
+ * therefore a script which is blocked inside a long running native call is only interrupted once the call returns.
+ */
+class ScriptWatchdog {
+public:
+    /**
+     * The budget of the evaluation running on a thread, passed along when a script call is executed on another thread.
+     */
+    struct EvaluationState {
+        int budget = 0; // Milliseconds, 0 if no evaluation with a budget is running
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    /**
+     * Marks the duration of an expression evaluation.
+     *
+     * The evaluation budget starts when the outermost Evaluation on the calling thread is constructed,
+     * nested evaluations (eg. a script calling exprtk.evaluate) share the budget of the outermost evaluation.
+     */
+    class Evaluation {
+    public:
+        Evaluation();
+
+        ~Evaluation();
+
+        Evaluation(const Evaluation &other) = delete;
+
+        Evaluation &operator=(const Evaluation &other) = delete;
+
+    private:
+        bool outermost;
+    };
+
+    /**
+     * Marks the duration of a single script call.
+     *
+     * Must be constructed and destroyed while holding the GIL of the interpreter which runs the script,
+     * the watchdog interrupts the calling thread in that interpreter.
+     * Throws std::runtime_error if the budget of the evaluation has already expired.
+     */
+    class Call {
+    public:
+        explicit Call(const std::string &name, const EvaluationState &evaluation = getEvaluationState());
+
+        ~Call();
+
+        Call(const Call &other) = delete;
+
+        Call &operator=(const Call &other) = delete;
+
+        /**
+         * @return True if the watchdog interrupted this call.
+         */
+        bool timedOut() const;
+
+        /**
+         * @return The error message describing which budget expired.
+         */
+        std::string getTimeoutMessage() const;
+
+    private:
+        std::string name;
+        uint64_t token;
+        unsigned long threadId;
+        PyInterpreterState *interpreter;
+        bool limitedByEvaluation;
+        int budget;
+    };
+
+    /**
+     * @return The budget of the evaluation running on the calling thread.
+     */
+    static EvaluationState getEvaluationState();
+
+    /**
+     * Wait for a running interrupt of the interpreter to finish.
+     *
+     * Must be called before ending a sub interpreter which ran script calls and without holding its GIL,
+     * no script calls may be started in the interpreter afterwards.
+     */
+    static void releaseInterpreter(PyInterpreterState *interpreter);
+
+    /**
+     * @param milliseconds The maximum duration of a single script call, 0 disables the budget.
+     */
+    static void setCallBudget(int milliseconds);
+
+    static int getCallBudget();
+
+    /**
+     * @param milliseconds The maximum duration of a single evaluation, 0 disables the budget.
+     * Script calls which are running when the budget expires are interrupted.
+     */
+    static void setEvaluationBudget(int milliseconds);
+
+    static int getEvaluationBudget();
+};
+
+#endif //QCALC_SCRIPTWATCHDOG_HPP
@@ -17,18 +17,32 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
-#include <istream>
 #include <utility>
 #include <filesystem>
-
-#include <QDir>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <algorithm>
+#include <cctype>
 
 #include "io/archive.hpp"
 
 #include "archive.h"
 #include "archive_entry.h"
 
-static int copy_data(struct archive *ar, struct archive *aw) {
+// The size of the blocks in which entry data is written and progress is reported
+static const size_t WRITE_BLOCK_SIZE = 1024 * 1024;
+
+static void checkProgress(const Archive::ProgressCallback &progress, uint64_t processed, uint64_t total) {
+    if (progress && !progress(processed, total))
+        throw std::runtime_error("Cancelled");
+}
+
+static int copy_data(struct archive *ar, struct archive *aw,
+                     const Archive::ProgressCallback &progress, uint64_t total) {
     long r;
     const void *buff;
     size_t size;
@@ -44,6 +58,7 @@ static int copy_data(struct archive *ar, struct archive *aw) {
         if (r < ARCHIVE_OK) {
             return (int) r;
         }
+        checkProgress(progress, archive_filter_bytes(ar, -1), total);
     }
 }
 
@@ -53,6 +68,10 @@ const QStringList &Archive::getFormatMimeTypes() {
             "application/x-7z-compressed",
             "application/x-rar-compressed",
             "application/x-tar",
+            "application/x-compressed-tar",
+            "application/x-bzip-compressed-tar",
+            "application/x-xz-compressed-tar",
+            "application/x-zstd-compressed-tar",
             "application/x-iso9660-image",
             "application/x-cpio",
             "application/x-shar",
@@ -96,157 +115,515 @@ Archive::Format Archive::getFormatFromExtension(const std::string &extension) {
     }
 }
 
+Archive::Format Archive::getFormatFromFilename(const std::string &filename) {
+    auto path = std::filesystem::path(filename);
+    auto ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (ext == ".tgz" || ext == ".tbz2" || ext == ".txz" || ext == ".tzst") {
+        return (Archive::Format) ARCHIVE_FORMAT_TAR;
+    }
+    if (getCompressionFromFilename(filename) != COMPRESSION_NONE) {
+        ext = path.stem().extension().string();
+        if (ext.empty())
+            throw std::runtime_error("Compressed file names must contain the archive format, for example .tar" + path.extension().string());
+    }
+    return getFormatFromExtension(ext);
+}
+
+Archive::Compression Archive::getCompressionFromFilename(const std::string &filename) {
+    auto ext = std::filesystem::path(filename).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (ext == ".gz" || ext == ".tgz") {
+        return COMPRESSION_GZIP;
+    } else if (ext == ".bz2" || ext == ".tbz2") {
+        return COMPRESSION_BZIP2;
+    } else if (ext == ".xz" || ext == ".txz") {
+        return COMPRESSION_XZ;
+    } else if (ext == ".zst" || ext == ".tzst") {
+        return COMPRESSION_ZSTD;
+    } else {
+        return COMPRESSION_NONE;
+    }
+}
+
 void Archive::extractToDisk(const std::string &filename,
                             const std::string &outputDirectory,
-                            std::function<void(const std::string &)> progressCallback) {
+                            const ProgressCallback &progress) {
     auto outputDir = outputDirectory;
     if (!outputDir.empty() && outputDir.back() != '/')
         outputDir += "/";
 
-    auto originalPath = QDir::current();
-    QDir::setCurrent(outputDir.c_str());
-
-    struct archive *a;
-    struct archive *ext;
-    struct archive_entry *entry;
-    int flags;
-    int r;
-
     /* Select which attributes we want to restore. */
-    flags = ARCHIVE_EXTRACT_TIME;
+    int flags = ARCHIVE_EXTRACT_TIME;
     flags |= ARCHIVE_EXTRACT_PERM;
     flags |= ARCHIVE_EXTRACT_ACL;
     flags |= ARCHIVE_EXTRACT_FFLAGS;
+    flags |= ARCHIVE_EXTRACT_SECURE_NODOTDOT;
+    flags |= ARCHIVE_EXTRACT_SECURE_SYMLINKS;
 
-    a = archive_read_new();
-    archive_read_support_format_all(a);
-    archive_read_support_filter_all(a);
-    ext = archive_write_disk_new();
-    archive_write_disk_set_options(ext, flags);
-    archive_write_disk_set_standard_lookup(ext);
+    std::unique_ptr<struct archive, decltype(&archive_read_free)> a(archive_read_new(), &archive_read_free);
+    archive_read_support_format_all(a.get());
+    archive_read_support_filter_all(a.get());
 
-    r = archive_read_open_filename(a, filename.c_str(), 10240);
+    std::unique_ptr<struct archive, decltype(&archive_write_free)> ext(archive_write_disk_new(), &archive_write_free);
+    archive_write_disk_set_options(ext.get(), flags);
+    archive_write_disk_set_standard_lookup(ext.get());
 
+    auto r = archive_read_open_filename(a.get(), filename.c_str(), WRITE_BLOCK_SIZE);
     if (r < ARCHIVE_WARN)
         throw std::runtime_error("Failed to read archive " + filename);
 
+    // Progress is reported in bytes of the archive file, which is known up front unlike the extracted size.
+    auto total = static_cast<uint64_t>(std::filesystem::file_size(filename));
+    checkProgress(progress, 0, total);
+
+    struct archive_entry *entry;
     for (;;) {
-        r = archive_read_next_header(a, &entry);
+        r = archive_read_next_header(a.get(), &entry);
         if (r == ARCHIVE_EOF)
             break;
         if (r < ARCHIVE_WARN)
-            throw std::runtime_error("Failed to read header: " + std::string(archive_error_string(a)));
-
-        auto entryPath = std::string(archive_entry_pathname(entry));
+            throw std::runtime_error("Failed to read header: " + std::string(archive_error_string(a.get())));
 
-        progressCallback("Extracting " + entryPath);
+        // Extract relative to the output directory instead of changing the working directory of the process
+        archive_entry_set_pathname(entry, (outputDir + archive_entry_pathname(entry)).c_str());
+        auto *hardlink = archive_entry_hardlink(entry);
+        if (hardlink != nullptr) {
+            archive_entry_set_hardlink(entry, (outputDir + hardlink).c_str());
+        }
 
-        r = archive_write_header(ext, entry);
+        r = archive_write_header(ext.get(), entry);
         if (r < ARCHIVE_OK) {}
         else if (archive_entry_size(entry) > 0) {
-            r = copy_data(a, ext);
+            r = copy_data(a.get(), ext.get(), progress, total);
             if (r < ARCHIVE_WARN)
-                throw std::runtime_error("Failed to read header: " + std::string(archive_error_string(a)));
+                throw std::runtime_error("Failed to read data: " + std::string(archive_error_string(a.get())));
         }
-        r = archive_write_finish_entry(ext);
+        r = archive_write_finish_entry(ext.get());
         if (r < ARCHIVE_WARN)
-            throw std::runtime_error("Failed to read header: " + std::string(archive_error_string(a)));
+            throw std::runtime_error("Failed to write entry: " + std::string(archive_error_string(ext.get())));
+
+        checkProgress(progress, archive_filter_bytes(a.get(), -1), total);
     }
 
-    archive_read_close(a);
-    archive_read_free(a);
-    archive_write_close(ext);
-    archive_write_free(ext);
+    archive_read_close(a.get());
+    archive_write_close(ext.get());
 
-    QDir::setCurrent(originalPath.path());
+    checkProgress(progress, total, total);
 }
 
 
 Archive::Archive() = default;
 
-Archive::Archive(std::istream &stream) {
-    std::vector<char> buf = std::vector<char>(std::istreambuf_iterator<char>(stream),
-                                              std::istreambuf_iterator<char>());
+static void setFilter(struct archive *a, Archive::Format format, const Archive::CompressionOptions &options) {
+    int r;
+    switch (options.compression) {
+        case Archive::COMPRESSION_NONE:
+            return;
+        case Archive::COMPRESSION_GZIP:
+            r = archive_write_add_filter_gzip(a);
+            break;
+        case Archive::COMPRESSION_BZIP2:
+            r = archive_write_add_filter_bzip2(a);
+            break;
+        case Archive::COMPRESSION_XZ:
+            r = archive_write_add_filter_xz(a);
+            break;
+        case Archive::COMPRESSION_ZSTD:
+            r = archive_write_add_filter_zstd(a);
+            break;
+        default:
+            throw std::runtime_error("Invalid compression");
+    }
 
-    auto a = archive_read_new();
-    archive_read_support_filter_all(a);
-    archive_read_support_format_all(a);
-    archive_read_open_memory(a, buf.data(), buf.size());
+    auto base = format & ARCHIVE_FORMAT_BASE_MASK;
+    if (base == ARCHIVE_FORMAT_ZIP || base == ARCHIVE_FORMAT_7ZIP)
+        throw std::runtime_error("Compression filters are not supported for zip and 7zip archives");
 
-    struct archive_entry *entry;
-    // Read Entry Headers
-    for (;;) {
-        auto r = archive_read_next_header(a, &entry);
-        if (r == ARCHIVE_EOF)
-            break;
+    if (r < ARCHIVE_WARN)
+        throw std::runtime_error("Failed to add compression filter " + std::string(archive_error_string(a)));
+
+    if (options.level >= 0) {
+        r = archive_write_set_filter_option(a, nullptr, "compression-level", std::to_string(options.level).c_str());
         if (r < ARCHIVE_WARN)
-            throw std::runtime_error("Failed to read header: " + std::string(archive_error_string(a)));
+            throw std::runtime_error("Failed to set compression level " + std::string(archive_error_string(a)));
+    }
 
-        std::string path = archive_entry_pathname(entry);
-        auto &e = mEntries[path];
+    if (options.compression == Archive::COMPRESSION_XZ || options.compression == Archive::COMPRESSION_ZSTD) {
+        auto threads = options.threads > 0
+                       ? options.threads
+                       : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        // Libarchive versions without threading support for the filter compress on a single thread.
+        archive_write_set_filter_option(a, nullptr, "threads", std::to_string(threads).c_str());
+    }
+}
 
-        if (archive_entry_size(entry) > 0) {
-            // Read Entry data
-            const char *buff = nullptr;
-            size_t size = 0;
-            la_int64_t offset = 0;
+// The number of blocks the file reader may read ahead of the writer
+static const size_t READ_AHEAD_BLOCKS = 8;
+
+// The maximum number of threads traversing directories
+static const unsigned int MAX_TRAVERSAL_THREADS = 4;
+
+namespace {
+    /**
+     * A queue with an optional capacity which can be closed to wake up waiting producers and consumers.
+     */
+    template<typename T>
+    class BlockingQueue {
+    public:
+        explicit BlockingQueue(size_t capacity = 0) : capacity(capacity) {}
+
+        /**
+         * @return False if the queue was closed.
+         */
+        bool push(T value) {
+            std::unique_lock<std::mutex> lock(mutex);
+            notFull.wait(lock, [this]() { return closed || capacity == 0 || items.size() < capacity; });
+            if (closed)
+                return false;
+            items.emplace_back(std::move(value));
+            notEmpty.notify_one();
+            return true;
+        }
 
-            for (;;) {
-                auto ret = archive_read_data_block(a, (const void **) &buff, &size, &offset);
-                if (ret == ARCHIVE_EOF)
+        /**
+         * @return False if the queue was closed and all items have been popped.
+         */
+        bool pop(T &value) {
+            std::unique_lock<std::mutex> lock(mutex);
+            notEmpty.wait(lock, [this]() { return closed || !items.empty(); });
+            if (items.empty())
+                return false;
+            value = std::move(items.front());
+            items.pop_front();
+            notFull.notify_one();
+            return true;
+        }
+
+        void close() {
+            std::lock_guard<std::mutex> guard(mutex);
+            closed = true;
+            notEmpty.notify_all();
+            notFull.notify_all();
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable notEmpty;
+        std::condition_variable notFull;
+        std::deque<T> items;
+        size_t capacity;
+        bool closed = false;
+    };
+
+    struct FileEntry {
+        std::string name;
+        std::string path;
+        bool directory = false;
+    };
+
+    struct Block {
+        enum Type {
+            BEGIN,
+            DATA,
+            END,
+            DIRECTORY,
+            ERROR
+        };
+
+        Type type = DATA;
+        std::string name; // The entry name for BEGIN and DIRECTORY or the error message for ERROR
+        uint64_t size = 0; // The entry size for BEGIN
+        std::vector<char> data;
+    };
+
+    /**
+     * Streams the file entries of an archive as blocks of data.
+     *
+     * Directories are traversed by a pool of threads which find the files ahead of the reader thread,
+     * the reader thread reads the files in blocks ahead of the consumer.
+     * Memory use is bounded by READ_AHEAD_BLOCKS blocks of WRITE_BLOCK_SIZE bytes.
+     */
+    class FileStream {
+    public:
+        FileStream(const std::map<std::string, std::string> &files,
+                   const std::map<std::string, std::string> &directories)
+                : blocks(READ_AHEAD_BLOCKS) {
+            for (auto &file: files) {
+                totalSize += std::filesystem::file_size(file.second);
+            }
+
+            for (auto &directory: directories) {
+                pendingDirectories.emplace_back(directory.first, directory.second);
+            }
+
+            auto threadCount = std::max(1u, std::min(MAX_TRAVERSAL_THREADS, std::thread::hardware_concurrency()));
+            for (auto i = 0u; i < threadCount; i++) {
+                traversalThreads.emplace_back([this]() { traverse(); });
+            }
+
+            reader = std::thread([this, files]() {
+                for (auto &file: files) {
+                    if (!readFile({file.first, file.second}))
+                        return;
+                }
+                FileEntry entry;
+                while (foundFiles.pop(entry)) {
+                    if (!readFile(entry))
+                        return;
+                }
+                std::string error;
+                {
+                    std::lock_guard<std::mutex> guard(mutex);
+                    error = traversalError;
+                }
+                if (!error.empty()) {
+                    Block block;
+                    block.type = Block::ERROR;
+                    block.name = error;
+                    blocks.push(std::move(block));
+                }
+                blocks.close();
+            });
+        }
+
+        ~FileStream() {
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                stopped = true;
+            }
+            directoryAdded.notify_all();
+            foundFiles.close();
+            blocks.close();
+            for (auto &thread: traversalThreads) {
+                thread.join();
+            }
+            reader.join();
+        }
+
+        /**
+         * @return False if all files have been read.
+         */
+        bool next(Block &block) {
+            return blocks.pop(block);
+        }
+
+        /**
+         * @return The total size of the files found so far.
+         */
+        uint64_t getTotalSize() const {
+            return totalSize;
+        }
+
+    private:
+        void traverse() {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (true) {
+                directoryAdded.wait(lock, [this]() {
+                    return stopped || !pendingDirectories.empty() || busyThreads == 0;
+                });
+                if (stopped)
+                    break;
+                if (pendingDirectories.empty() && busyThreads == 0) {
+                    // All directories have been traversed, this also applies if no directories were added.
+                    foundFiles.close();
                     break;
-                if (ret < ARCHIVE_OK)
-                    throw std::runtime_error("Failed to read archive data: " + std::string(archive_error_string(a)));
-
-                // Copy data to archive
-                auto prevSize = e.size();
-                e.resize(prevSize + size);
-                for (auto i = 0; i < size; i++) {
-                    e.at(prevSize + i) = buff[i];
+                }
+
+                auto directory = pendingDirectories.back();
+                pendingDirectories.pop_back();
+                busyThreads++;
+
+                lock.unlock();
+
+                // Directories have their own entry so that empty directories are kept
+                if (!foundFiles.push({directory.first + "/", directory.second, true})) {
+                    lock.lock();
+                    busyThreads--;
+                    continue;
+                }
+
+                std::string error;
+                std::error_code ec;
+                for (auto it = std::filesystem::directory_iterator(directory.second, ec);
+                     !ec && it != std::filesystem::directory_iterator();
+                     it.increment(ec)) {
+                    auto &entry = *it;
+                    auto name = directory.first + "/" + entry.path().filename().string();
+                    if (entry.is_symlink(ec) && entry.is_directory(ec)) {
+                        // Do not follow directory links which could form cycles
+                        continue;
+                    } else if (entry.is_directory(ec)) {
+                        std::lock_guard<std::mutex> guard(mutex);
+                        pendingDirectories.emplace_back(name, entry.path().string());
+                        directoryAdded.notify_one();
+                    } else if (entry.is_regular_file(ec)) {
+                        totalSize += entry.file_size(ec);
+                        if (!foundFiles.push({name, entry.path().string()}))
+                            break;
+                    }
+                }
+                if (ec)
+                    error = "Failed to read directory " + directory.second + ": " + ec.message();
+
+                lock.lock();
+                busyThreads--;
+                if (!error.empty() && traversalError.empty())
+                    traversalError = error;
+                if (busyThreads == 0 && pendingDirectories.empty()) {
+                    directoryAdded.notify_all();
                 }
             }
         }
-    }
 
-    format = static_cast<Archive::Format>(archive_format(a));
+        /**
+         * @return False if the stream was stopped.
+         */
+        bool readFile(const FileEntry &file) {
+            if (file.directory) {
+                Block block;
+                block.type = Block::DIRECTORY;
+                block.name = file.name;
+                return blocks.push(std::move(block));
+            }
+
+            std::ifstream stream(file.path, std::ios::binary);
+            std::error_code ec;
+            auto size = std::filesystem::file_size(file.path, ec);
+            if (!stream || ec) {
+                Block block;
+                block.type = Block::ERROR;
+                block.name = "Failed to open " + file.path;
+                blocks.push(std::move(block));
+                return false;
+            }
 
-    archive_read_close(a);
-    archive_read_free(a);
+            Block begin;
+            begin.type = Block::BEGIN;
+            begin.name = file.name;
+            begin.size = size;
+            if (!blocks.push(std::move(begin)))
+                return false;
+
+            // Never read more than the size written to the entry header
+            uint64_t remaining = size;
+            while (remaining > 0) {
+                Block block;
+                block.data.resize(static_cast<size_t>(std::min<uint64_t>(WRITE_BLOCK_SIZE, remaining)));
+                stream.read(block.data.data(), static_cast<std::streamsize>(block.data.size()));
+                block.data.resize(static_cast<size_t>(stream.gcount()));
+                if (block.data.empty())
+                    break; // The file was truncated, the archive pads the entry
+                remaining -= block.data.size();
+                if (!blocks.push(std::move(block)))
+                    return false;
+            }
+
+            Block end;
+            end.type = Block::END;
+            return blocks.push(std::move(end));
+        }
+
+        BlockingQueue<Block> blocks;
+        BlockingQueue<FileEntry> foundFiles;
+
+        std::mutex mutex;
+        std::condition_variable directoryAdded;
+        std::vector<std::pair<std::string, std::string>> pendingDirectories;
+        int busyThreads = 0;
+        bool stopped = false;
+        std::string traversalError;
+        std::atomic<uint64_t> totalSize{0};
+
+        std::vector<std::thread> traversalThreads;
+        std::thread reader;
+    };
 }
 
-Archive::Format Archive::getFormat() {
-    return format;
+static void writeHeader(struct archive *a, const std::string &name, uint64_t size, bool directory = false) {
+    std::unique_ptr<archive_entry, decltype(&archive_entry_free)> e(archive_entry_new(), &archive_entry_free);
+
+    archive_entry_set_pathname(e.get(), name.c_str());
+    archive_entry_set_filetype(e.get(), directory ? AE_IFDIR : AE_IFREG);
+    archive_entry_set_perm(e.get(), directory ? 0755 : 0644);
+    archive_entry_set_size(e.get(), (la_int64_t) size);
+
+    auto ret = archive_write_header(a, e.get());
+    if (ret < ARCHIVE_OK)
+        throw std::runtime_error("Failed to write archive header " + std::string(archive_error_string(a)));
+}
+
+static void writeData(struct archive *a, const char *data, size_t size) {
+    auto writeCount = archive_write_data(a, data, size);
+    if (writeCount < 0)
+        throw std::runtime_error("Failed to write archive data " + std::string(archive_error_string(a)));
 }
 
-void Archive::save(const std::string &outputFile, Archive::Format f) {
-    struct archive *a = archive_write_new();
+void Archive::save(const std::string &outputFile,
+                   Archive::Format f,
+                   const CompressionOptions &options,
+                   const ProgressCallback &progress) {
+    std::unique_ptr<struct archive, decltype(&archive_write_free)> a(archive_write_new(), &archive_write_free);
 
-    archive_write_set_format(a, f);
-    auto ret = archive_write_open_filename(a, outputFile.c_str());
+    if (archive_write_set_format(a.get(), f) < ARCHIVE_OK)
+        throw std::runtime_error("Unsupported archive format " + std::string(archive_error_string(a.get())));
+
+    setFilter(a.get(), f, options);
+
+    auto ret = archive_write_open_filename(a.get(), outputFile.c_str());
     if (ret < ARCHIVE_OK)
-        throw std::runtime_error("Failed to open output file " + std::string(archive_error_string(a)));
+        throw std::runtime_error("Failed to open output file " + std::string(archive_error_string(a.get())));
 
+    uint64_t entriesSize = 0;
     for (auto &entry: mEntries) {
-        auto *e = archive_entry_new();
+        entriesSize += entry.second.size();
+    }
 
-        archive_entry_set_pathname(e, entry.first.c_str());
-        archive_entry_set_filetype(e, AE_IFREG);
-        archive_entry_set_perm(e, 0644);
-        archive_entry_set_size(e, (long) entry.second.size());
+    FileStream files(mFiles, mDirectories);
 
-        ret = archive_write_header(a, e);
-        if (ret < ARCHIVE_OK)
-            throw std::runtime_error("Failed to write archive header " + std::string(archive_error_string(a)));
+    // The total grows while the directories are traversed
+    uint64_t processed = 0;
+    auto getTotal = [&]() { return entriesSize + files.getTotalSize(); };
 
-        auto writeCount = archive_write_data(a, entry.second.data(), entry.second.size());
-        if (writeCount < 0)
-            throw std::runtime_error("Failed to write archive data " + std::string(archive_error_string(a)));
+    checkProgress(progress, processed, getTotal());
 
-        archive_write_finish_entry(a);
+    for (auto &entry: mEntries) {
+        writeHeader(a.get(), entry.first, entry.second.size());
+        // Write in blocks so that progress is reported and cancellation is possible within large entries
+        for (size_t offset = 0; offset < entry.second.size(); offset += WRITE_BLOCK_SIZE) {
+            auto size = std::min(WRITE_BLOCK_SIZE, entry.second.size() - offset);
+            writeData(a.get(), entry.second.data() + offset, size);
+            processed += size;
+            checkProgress(progress, processed, getTotal());
+        }
+        archive_write_finish_entry(a.get());
+    }
 
-        archive_entry_free(e);
+    Block block;
+    while (files.next(block)) {
+        switch (block.type) {
+            case Block::BEGIN:
+                writeHeader(a.get(), block.name, block.size);
+                break;
+            case Block::DATA:
+                writeData(a.get(), block.data.data(), block.data.size());
+                processed += block.data.size();
+                checkProgress(progress, processed, getTotal());
+                break;
+            case Block::END:
+                archive_write_finish_entry(a.get());
+                break;
+            case Block::DIRECTORY:
+                writeHeader(a.get(), block.name, 0, true);
+                archive_write_finish_entry(a.get());
+                break;
+            case Block::ERROR:
+                throw std::runtime_error(block.name);
+        }
     }
 
-    archive_write_close(a);
-    archive_write_free(a);
-}
\ No newline at end of file
+    if (archive_write_close(a.get()) < ARCHIVE_OK)
+        throw std::runtime_error("Failed to write archive " + std::string(archive_error_string(a.get())));
+
+    checkProgress(progress, processed, processed);
+}
@@ -25,6 +25,7 @@
 #include <string>
 #include <memory>
 #include <functional>
+#include <cstdint>
 
 #include <QStringList>
 
@@ -65,23 +66,75 @@ public:
         ARCHIVE_FORMAT_RAR_V5 = 0x100000,
     };
 
+    enum Compression : int {
+        COMPRESSION_NONE,
+        COMPRESSION_GZIP,
+        COMPRESSION_BZIP2,
+        COMPRESSION_XZ,
+        COMPRESSION_ZSTD
+    };
+
+    struct CompressionOptions {
+        Compression compression = COMPRESSION_NONE;
+
+        // The compression level, -1 for the default level of the filter
+        int level = -1;
+
+        // The number of compression threads used by the xz and zstd filters, 0 for one thread per core
+        int threads = 0;
+    };
+
+    /**
+     * Receives the number of processed bytes and the total number of bytes of an operation.
+     * Returning false cancels the operation, which then throws.
+     */
+    typedef std::function<bool(uint64_t processed, uint64_t total)> ProgressCallback;
+
     static const QStringList & getFormatMimeTypes();
 
     static Format getFormatFromExtension(const std::string &extension);
 
-    static void extractToDisk(const std::string &archive, const std::string &outputDirectory,
-                              std::function<void(const std::string &)> progressCallback);
+    /**
+     * Get the format from a file name which may contain a compression suffix such as "bundle.tar.zst".
+     */
+    static Format getFormatFromFilename(const std::string &filename);
 
-    Archive();
+    /**
+     * Get the compression filter from the suffix of the file name, for example ".gz" or ".tzst".
+     */
+    static Compression getCompressionFromFilename(const std::string &filename);
 
-    explicit Archive(std::istream &stream);
+    /**
+     * Extract the archive file into the output directory.
+     * The progress is reported in bytes of the archive file that have been read.
+     */
+    static void extractToDisk(const std::string &archive,
+                              const std::string &outputDirectory,
+                              const ProgressCallback &progress = ProgressCallback());
 
-    Format getFormat();
+    Archive();
 
     void addEntry(const std::string &name, const std::vector<char> &data) {
         mEntries[name] = data;
     }
 
+    /**
+     * Add an entry whose data is read from the file when the archive is saved.
+     */
+    void addFile(const std::string &name, const std::string &filePath) {
+        mFiles[name] = filePath;
+    }
+
+    /**
+     * Add the directory with its subdirectories and files, which are found and read when the archive is saved.
+     *
+     * @param name The entry name of the directory, the contents are added as name/relative/path.
+     * @param directoryPath
+     */
+    void addDirectory(const std::string &name, const std::string &directoryPath) {
+        mDirectories[name] = directoryPath;
+    }
+
     const std::vector<char> &getEntry(const std::string &name){
         return mEntries.at(name);
     }
@@ -90,11 +143,32 @@ public:
 
     const std::map<std::string, std::vector<char>> &entries() const { return mEntries; }
 
-    void save(const std::string &outputFile, Format format);
+    /**
+     * Write the archive.
+     *
+     * Files are streamed into the archive in blocks that are read on a separate thread while
+     * the previous blocks are compressed, the memory used does not depend on the size of the files.
+     * The directories are traversed by multiple threads ahead of the reader,
+     * so the order of the directory entries in the archive is not deterministic.
+     *
+     * @param outputFile
+     * @param format
+     * @param options The compression filter applied to the archive, not supported for zip and 7zip archives.
+     * @param progress Receives the number of uncompressed bytes written.
+     */
+    void save(const std::string &outputFile,
+              Format format,
+              const CompressionOptions &options,
+              const ProgressCallback &progress = ProgressCallback());
+
+    void save(const std::string &outputFile, Format format) {
+        save(outputFile, format, CompressionOptions());
+    }
 
 private:
-    Format format;
     std::map<std::string, std::vector<char>> mEntries;
+    std::map<std::string, std::string> mFiles;
+    std::map<std::string, std::string> mDirectories;
 };
 
 #endif //QCALC_ARCHIVE_HPP
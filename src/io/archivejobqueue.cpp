@@ -0,0 +1,163 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "io/archivejobqueue.hpp"
+
+#include <filesystem>
+#include <algorithm>
+
+ArchiveJobQueue::ArchiveJobQueue() {
+    worker = std::thread([this]() { run(); });
+}
+
+ArchiveJobQueue::~ArchiveJobQueue() {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        shutdown = true;
+        for (auto &entry: entries) {
+            entry.cancelRequested = true;
+        }
+    }
+    jobAdded.notify_all();
+    worker.join();
+}
+
+int ArchiveJobQueue::enqueue(Job job) {
+    std::lock_guard<std::mutex> guard(mutex);
+    Entry entry;
+    entry.status = {nextId++, job.description, QUEUED, 0, 0, 0, -1, ""};
+    entry.job = std::move(job);
+    entries.emplace_back(std::move(entry));
+    jobAdded.notify_all();
+    return entries.back().status.id;
+}
+
+void ArchiveJobQueue::cancel(int id) {
+    std::lock_guard<std::mutex> guard(mutex);
+    auto *entry = getEntry(id);
+    if (entry == nullptr)
+        return;
+    if (entry->status.state == QUEUED) {
+        entry->status.state = CANCELLED;
+    } else if (entry->status.state == RUNNING) {
+        entry->cancelRequested = true;
+    }
+}
+
+std::vector<ArchiveJobQueue::Status> ArchiveJobQueue::getStatus() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    std::vector<Status> ret;
+    ret.reserve(entries.size());
+    for (auto &entry: entries) {
+        ret.emplace_back(entry.status);
+    }
+    return ret;
+}
+
+void ArchiveJobQueue::removeCompleted() {
+    std::lock_guard<std::mutex> guard(mutex);
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [](const Entry &entry) {
+        return entry.status.state != QUEUED && entry.status.state != RUNNING;
+    }), entries.end());
+}
+
+bool ArchiveJobQueue::isIdle() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return std::none_of(entries.begin(), entries.end(), [](const Entry &entry) {
+        return entry.status.state == QUEUED || entry.status.state == RUNNING;
+    });
+}
+
+void ArchiveJobQueue::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        Entry *entry = nullptr;
+        jobAdded.wait(lock, [this, &entry]() {
+            for (auto &e: entries) {
+                if (e.status.state == QUEUED) {
+                    entry = &e;
+                    return true;
+                }
+            }
+            return shutdown;
+        });
+        if (shutdown)
+            break;
+
+        auto id = entry->status.id;
+        auto job = entry->job;
+        entry->status.state = RUNNING;
+        entry->startTime = std::chrono::steady_clock::now();
+
+        lock.unlock();
+
+        std::string error;
+        try {
+            job.run([this, id](uint64_t processed, uint64_t total) {
+                return reportProgress(id, processed, total);
+            });
+        } catch (const std::exception &e) {
+            error = e.what();
+        }
+
+        lock.lock();
+
+        // Entries are only removed when they are not running, so the entry still exists.
+        entry = getEntry(id);
+        if (entry->cancelRequested) {
+            entry->status.state = CANCELLED;
+        } else if (!error.empty()) {
+            entry->status.state = FAILED;
+            entry->status.error = error;
+        } else {
+            entry->status.state = FINISHED;
+            entry->status.processed = entry->status.total;
+            entry->status.remainingTime = 0;
+        }
+
+        if (entry->status.state != FINISHED && !job.outputFile.empty()) {
+            std::error_code ec;
+            std::filesystem::remove(job.outputFile, ec);
+        }
+    }
+}
+
+bool ArchiveJobQueue::reportProgress(int id, uint64_t processed, uint64_t total) {
+    std::lock_guard<std::mutex> guard(mutex);
+    auto *entry = getEntry(id);
+    entry->status.processed = processed;
+    entry->status.total = total;
+
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - entry->startTime).count();
+    if (elapsed > 0 && processed > 0) {
+        entry->status.throughput = static_cast<double>(processed) / elapsed;
+        entry->status.remainingTime = static_cast<double>(total > processed ? total - processed : 0)
+                                      / entry->status.throughput;
+    }
+
+    return !entry->cancelRequested;
+}
+
+ArchiveJobQueue::Entry *ArchiveJobQueue::getEntry(int id) {
+    for (auto &entry: entries) {
+        if (entry.status.id == id)
+            return &entry;
+    }
+    return nullptr;
+}
@@ -0,0 +1,124 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_ARCHIVEJOBQUEUE_HPP
+#define QCALC_ARCHIVEJOBQUEUE_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#include "io/archive.hpp"
+
+/**
+ * Runs archive jobs one after another on a worker thread.
+ *
+ * Jobs report their progress through the passed callback, which is also used to cancel them.
+ */
+class ArchiveJobQueue {
+public:
+    enum State {
+        QUEUED,
+        RUNNING,
+        FINISHED,
+        FAILED,
+        CANCELLED
+    };
+
+    struct Job {
+        std::string description;
+
+        // Performs the job, must pass the callback to the archive operation.
+        std::function<void(const Archive::ProgressCallback &progress)> run;
+
+        // A file that is removed if the job fails or is cancelled, may be empty.
+        std::string outputFile;
+    };
+
+    struct Status {
+        int id;
+        std::string description;
+        State state;
+        uint64_t processed;
+        uint64_t total;
+        double throughput; // Bytes per second
+        double remainingTime; // Seconds, negative if unknown
+        std::string error;
+    };
+
+    ArchiveJobQueue();
+
+    /**
+     * Cancels all jobs and waits for the running job to stop.
+     */
+    ~ArchiveJobQueue();
+
+    ArchiveJobQueue(const ArchiveJobQueue &) = delete;
+
+    ArchiveJobQueue &operator=(const ArchiveJobQueue &) = delete;
+
+    /**
+     * @return The id of the job.
+     */
+    int enqueue(Job job);
+
+    /**
+     * Cancel a queued or running job, a running job stops at its next progress report.
+     */
+    void cancel(int id);
+
+    /**
+     * @return The status of all jobs that have not been removed, in the order they were enqueued.
+     */
+    std::vector<Status> getStatus() const;
+
+    /**
+     * Remove the finished, failed and cancelled jobs.
+     */
+    void removeCompleted();
+
+    bool isIdle() const;
+
+private:
+    struct Entry {
+        Job job;
+        Status status;
+        bool cancelRequested = false;
+        std::chrono::steady_clock::time_point startTime;
+    };
+
+    void run();
+
+    bool reportProgress(int id, uint64_t processed, uint64_t total);
+
+    Entry *getEntry(int id);
+
+    mutable std::mutex mutex;
+    std::condition_variable jobAdded;
+    std::deque<Entry> entries;
+    int nextId = 0;
+    bool shutdown = false;
+    std::thread worker;
+};
+
+#endif //QCALC_ARCHIVEJOBQUEUE_HPP
@@ -0,0 +1,183 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "io/archivereader.hpp"
+
+#include <fstream>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+
+#include "archive.h"
+#include "archive_entry.h"
+
+// The size of the blocks read from the archive file
+static const size_t READ_BLOCK_SIZE = 1024 * 1024;
+
+namespace {
+    /**
+     * Owns a libarchive read handle opened on a file.
+     *
+     * The archive is read in blocks instead of being mapped,
+     * a user archive which is truncated while it is read would raise SIGBUS on a mapping.
+     */
+    class ReadHandle {
+    public:
+        explicit ReadHandle(const std::string &filename) {
+            handle = archive_read_new();
+            archive_read_support_filter_all(handle);
+            archive_read_support_format_all(handle);
+            if (archive_read_open_filename(handle, filename.c_str(), READ_BLOCK_SIZE) != ARCHIVE_OK) {
+                std::string error = archive_error_string(handle) ? archive_error_string(handle) : "";
+                archive_read_free(handle);
+                throw std::runtime_error("Failed to open archive " + filename + ": " + error);
+            }
+        }
+
+        ~ReadHandle() {
+            archive_read_close(handle);
+            archive_read_free(handle);
+        }
+
+        ReadHandle(const ReadHandle &) = delete;
+
+        ReadHandle &operator=(const ReadHandle &) = delete;
+
+        /**
+         * @return False if the end of the archive was reached.
+         */
+        bool nextHeader(archive_entry **entry) {
+            auto r = archive_read_next_header(handle, entry);
+            if (r == ARCHIVE_EOF)
+                return false;
+            if (r < ARCHIVE_WARN)
+                throw std::runtime_error("Failed to read header: " + getError());
+            return true;
+        }
+
+        void skipData() {
+            if (archive_read_data_skip(handle) < ARCHIVE_WARN)
+                throw std::runtime_error("Failed to skip archive data: " + getError());
+        }
+
+        void readData(const ArchiveReader::Sink &sink) {
+            const void *buff = nullptr;
+            size_t size = 0;
+            la_int64_t offset = 0;
+            for (;;) {
+                auto r = archive_read_data_block(handle, &buff, &size, &offset);
+                if (r == ARCHIVE_EOF)
+                    break;
+                if (r < ARCHIVE_OK)
+                    throw std::runtime_error("Failed to read archive data: " + getError());
+                if (size > 0)
+                    sink(static_cast<const char *>(buff), size);
+            }
+        }
+
+        std::string getError() {
+            auto *str = archive_error_string(handle);
+            return str ? str : "";
+        }
+
+        archive *handle;
+    };
+}
+
+ArchiveReader::ArchiveReader(std::string filename)
+        : filename(std::move(filename)) {
+    ReadHandle a(this->filename);
+    archive_entry *entry;
+    while (a.nextHeader(&entry)) {
+        EntryInfo info;
+        info.path = archive_entry_pathname(entry);
+        info.size = archive_entry_size_is_set(entry) ? archive_entry_size(entry) : 0;
+        info.directory = archive_entry_filetype(entry) == AE_IFDIR;
+        entryIndex[info.path] = entries.size();
+        entries.emplace_back(std::move(info));
+        a.skipData();
+    }
+    format = static_cast<Archive::Format>(archive_format(a.handle));
+}
+
+const std::vector<ArchiveReader::EntryInfo> &ArchiveReader::getEntries() const {
+    return entries;
+}
+
+bool ArchiveReader::contains(const std::string &path) const {
+    return entryIndex.find(path) != entryIndex.end();
+}
+
+const ArchiveReader::EntryInfo &ArchiveReader::getEntry(const std::string &path) const {
+    auto it = entryIndex.find(path);
+    if (it == entryIndex.end())
+        throw std::runtime_error("Archive entry not found: " + path);
+    return entries.at(it->second);
+}
+
+Archive::Format ArchiveReader::getFormat() const {
+    return format;
+}
+
+void ArchiveReader::read(const SinkSelector &selector) const {
+    ReadHandle a(filename);
+    archive_entry *entry;
+    for (auto &info: entries) {
+        if (!a.nextHeader(&entry))
+            throw std::runtime_error("Archive " + filename + " was modified while reading");
+        auto sink = info.directory ? Sink() : selector(info);
+        if (sink) {
+            a.readData(sink);
+        } else {
+            a.skipData();
+        }
+    }
+}
+
+std::string ArchiveReader::readEntry(const std::string &path) const {
+    auto &info = getEntry(path);
+    std::string ret;
+    ret.reserve(static_cast<size_t>(info.size));
+    read([&path, &ret](const EntryInfo &entry) -> Sink {
+        if (entry.path != path)
+            return {};
+        return [&ret](const char *data, size_t size) {
+            ret.append(data, size);
+        };
+    });
+    return ret;
+}
+
+void ArchiveReader::extract(const std::function<std::string(const EntryInfo &)> &selector) const {
+    read([&selector](const EntryInfo &entry) -> Sink {
+        auto outputPath = selector(entry);
+        if (outputPath.empty())
+            return {};
+        auto parent = std::filesystem::path(outputPath).parent_path();
+        if (!parent.empty())
+            std::filesystem::create_directories(parent);
+        auto stream = std::make_shared<std::ofstream>(outputPath, std::ios::binary | std::ios::trunc);
+        if (!*stream)
+            throw std::runtime_error("Failed to open " + outputPath);
+        return [stream, outputPath](const char *data, size_t size) {
+            if (!stream->write(data, static_cast<std::streamsize>(size)))
+                throw std::runtime_error("Failed to write " + outputPath);
+        };
+    });
+}
@@ -0,0 +1,94 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_ARCHIVEREADER_HPP
+#define QCALC_ARCHIVEREADER_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <cstdint>
+
+#include "io/archive.hpp"
+
+/**
+ * Reads an archive file without loading the entry data into memory.
+ *
+ * On construction only the entry headers are read.
+ * The entry data is streamed on demand into sinks provided by the caller,
+ * the sinks receive the data blocks decoded by libarchive without copying.
+ */
+class ArchiveReader {
+public:
+    struct EntryInfo {
+        std::string path;
+        int64_t size = 0;
+        bool directory = false;
+    };
+
+    /**
+     * Receives consecutive blocks of entry data.
+     */
+    typedef std::function<void(const char *data, size_t size)> Sink;
+
+    /**
+     * Returns the sink for the entry or an empty function if the entry should be skipped.
+     */
+    typedef std::function<Sink(const EntryInfo &entry)> SinkSelector;
+
+    /**
+     * Read the entry headers of the archive file.
+     */
+    explicit ArchiveReader(std::string filename);
+
+    const std::vector<EntryInfo> &getEntries() const;
+
+    bool contains(const std::string &path) const;
+
+    const EntryInfo &getEntry(const std::string &path) const;
+
+    Archive::Format getFormat() const;
+
+    /**
+     * Stream the data of the selected entries in a single pass over the archive.
+     * The data of entries which are not selected is skipped without being copied.
+     */
+    void read(const SinkSelector &selector) const;
+
+    /**
+     * Read the data of a single entry into memory, intended for small entries such as metadata files.
+     */
+    std::string readEntry(const std::string &path) const;
+
+    /**
+     * Stream the data of the selected entries into files.
+     *
+     * @param selector Returns the output file path for the entry or an empty string if the entry should be skipped.
+     */
+    void extract(const std::function<std::string(const EntryInfo &entry)> &selector) const;
+
+private:
+    std::string filename;
+    std::vector<EntryInfo> entries;
+    std::map<std::string, size_t> entryIndex;
+    Archive::Format format{};
+};
+
+#endif //QCALC_ARCHIVEREADER_HPP
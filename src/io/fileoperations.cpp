@@ -19,13 +19,26 @@
 
 #include "fileoperations.hpp"
 
-#include <QFile>
-#include <QDir>
-#include <QTextStream>
-
 #include <filesystem>
-
+#include <algorithm>
 #include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+
+#if _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <climits>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#endif
 
 namespace FileOperations {
     std::vector<std::string> findFilesInDirectory(const std::string &directory,
@@ -53,22 +66,83 @@ namespace FileOperations {
         return ret;
     }
 
-    std::string fileReadAll(const std::string &filePath) {
-        try {
-            QFile file(filePath.c_str());
-            if (file.exists()) {
-                file.open(QFile::ReadOnly);
-
-                QTextStream stream(&file);
-                QString fileContents = stream.readAll();
-                stream.flush();
+    MappedFile::MappedFile(const std::string &filePath) {
+#if _WIN32
+        // The wide api opens paths which are not representable in the ansi code page
+        auto file = CreateFileW(std::filesystem::path(filePath).wstring().c_str(),
+                                GENERIC_READ,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                nullptr,
+                                OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                                nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("Failed to open file at " + filePath);
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) {
+            CloseHandle(file);
+            throw std::runtime_error("Failed to read file size at " + filePath);
+        }
+        mSize = static_cast<size_t>(size.QuadPart);
+
+        // Empty files cannot be mapped
+        if (mSize > 0) {
+            auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping != nullptr) {
+                mData = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                // The view keeps the mapping alive
+                CloseHandle(mapping);
+            }
+            if (mData == nullptr) {
+                CloseHandle(file);
+                throw std::runtime_error("Failed to map file at " + filePath);
+            }
+        }
+        CloseHandle(file);
+#else
+        auto fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            throw std::runtime_error("Failed to open file at " + filePath + " Error: " + std::strerror(errno));
+
+        struct stat st{};
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::runtime_error("Failed to read file size at " + filePath);
+        }
+        mSize = static_cast<size_t>(st.st_size);
+
+        // Empty files cannot be mapped
+        if (mSize > 0) {
+            auto *ptr = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (ptr == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("Failed to map file at " + filePath + " Error: " + std::strerror(errno));
+            }
+            posix_madvise(ptr, mSize, POSIX_MADV_SEQUENTIAL);
+            mData = static_cast<const char *>(ptr);
+        }
+        // The mapping stays valid after the descriptor is closed
+        close(fd);
+#endif
+    }
 
-                file.close();
+    MappedFile::~MappedFile() {
+        if (mData == nullptr)
+            return;
+#if _WIN32
+        UnmapViewOfFile(mData);
+#else
+        munmap(const_cast<char *>(mData), mSize);
+#endif
+    }
 
-                return fileContents.toStdString();
-            } else {
+    std::string fileReadAll(const std::string &filePath) {
+        try {
+            if (!std::filesystem::exists(filePath))
                 throw std::runtime_error("File not found.");
-            }
+            MappedFile file(filePath);
+            return std::string(file.view());
         }
         catch (const std::exception &e) {
             std::string error = "Failed to read file at ";
@@ -80,36 +154,91 @@ namespace FileOperations {
     }
 
     std::vector<char> fileReadAllVector(const std::string &filePath) {
-        auto ret = fileReadAll(filePath);
-        std::vector<char> rv;
-        for (auto &v: ret)
-            rv.emplace_back(v);
-        return rv;
+        MappedFile file(filePath);
+        return {file.data(), file.data() + file.size()};
     }
 
-    void fileWriteAll(const std::string &filePath, const std::string &contents) {
-        try {
-            QFile file(filePath.c_str());
-
-            file.open(QFile::WriteOnly | QFile::Truncate);
-
-            QTextStream stream(&file);
-
-            QString tmp(contents.c_str());
-            stream << tmp;
+    void fileWriteAll(const std::string &filePath, std::string_view contents) {
+        fileWriteAtomic(filePath, {contents});
+    }
 
-            stream.flush();
+#if _WIN32
+    void fileWrite(const std::string &filePath,
+                   const std::vector<std::string_view> &buffers,
+                   bool append,
+                   bool sync) {
+        FILE *file = _wfopen(std::filesystem::path(filePath).wstring().c_str(), append ? L"ab" : L"wb");
+        if (file == nullptr)
+            throw std::runtime_error("Failed to open file at " + filePath);
+        for (auto &buffer: buffers) {
+            if (fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) {
+                fclose(file);
+                throw std::runtime_error("Failed to write file at " + filePath);
+            }
+        }
+        fflush(file);
+        if (sync)
+            _commit(_fileno(file));
+        if (fclose(file) != 0)
+            throw std::runtime_error("Failed to write file at " + filePath);
+    }
+#else
+    void fileWrite(const std::string &filePath,
+                   const std::vector<std::string_view> &buffers,
+                   bool append,
+                   bool sync) {
+        auto flags = O_WRONLY | O_CREAT | O_CLOEXEC | (append ? O_APPEND : O_TRUNC);
+        auto fd = open(filePath.c_str(), flags, 0644);
+        if (fd < 0)
+            throw std::runtime_error("Failed to open file at " + filePath + " Error: " + std::strerror(errno));
+
+        std::vector<iovec> vectors;
+        for (auto &buffer: buffers) {
+            if (!buffer.empty())
+                vectors.push_back({const_cast<char *>(buffer.data()), buffer.size()});
+        }
 
-            file.flush();
+        size_t index = 0;
+        while (index < vectors.size()) {
+            auto count = std::min(vectors.size() - index, static_cast<size_t>(IOV_MAX));
+            auto written = writev(fd, vectors.data() + index, static_cast<int>(count));
+            if (written < 0) {
+                if (errno == EINTR)
+                    continue;
+                auto error = std::strerror(errno);
+                close(fd);
+                throw std::runtime_error("Failed to write file at " + filePath + " Error: " + error);
+            }
+            // Continue after a partial write
+            auto remaining = static_cast<size_t>(written);
+            while (remaining > 0 && remaining >= vectors[index].iov_len) {
+                remaining -= vectors[index].iov_len;
+                index++;
+            }
+            if (remaining > 0) {
+                vectors[index].iov_base = static_cast<char *>(vectors[index].iov_base) + remaining;
+                vectors[index].iov_len -= remaining;
+            }
+        }
 
-            file.close();
+        if (sync && fsync(fd) != 0) {
+            close(fd);
+            throw std::runtime_error("Failed to sync file at " + filePath);
         }
-        catch (const std::exception &e) {
-            std::string error = "Failed to write file at ";
-            error += filePath;
-            error += " Error: ";
-            error += e.what();
-            throw std::runtime_error(error);
+        if (close(fd) != 0)
+            throw std::runtime_error("Failed to write file at " + filePath);
+    }
+#endif
+
+    void fileWriteAtomic(const std::string &filePath, const std::vector<std::string_view> &buffers) {
+        auto tmpPath = filePath + ".tmp";
+        try {
+            fileWrite(tmpPath, buffers, false, true);
+            std::filesystem::rename(tmpPath, filePath);
+        } catch (...) {
+            std::error_code ec;
+            std::filesystem::remove(tmpPath, ec);
+            throw;
         }
     }
 }
\ No newline at end of file
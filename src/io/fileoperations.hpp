@@ -21,7 +21,9 @@
 #define QCALC_FILEOPERATIONS_HPP
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <cstddef>
 
 namespace FileOperations {
     /**
@@ -34,11 +36,61 @@ namespace FileOperations {
      */
     std::vector<std::string> findFilesInDirectory(const std::string &directory, const std::string &suffix = "", bool recursive = false);
 
+    /**
+     * A read only memory mapping of a file.
+     *
+     * The data is read from the page cache on access without copying it into a buffer,
+     * it must not be accessed after another process truncates the file.
+     */
+    class MappedFile {
+    public:
+        /**
+         * @param filePath The file to map, throws a runtime_error if it cannot be opened.
+         */
+        explicit MappedFile(const std::string &filePath);
+
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        const char *data() const { return mData; }
+
+        size_t size() const { return mSize; }
+
+        std::string_view view() const { return {mData, mSize}; }
+
+    private:
+        const char *mData = nullptr;
+        size_t mSize = 0;
+    };
+
     std::string fileReadAll(const std::string &filePath);
 
     std::vector<char> fileReadAllVector(const std::string &filePath);
 
-    void fileWriteAll(const std::string &filePath, const std::string &contents);
+    /**
+     * Replace the contents of the file atomically.
+     */
+    void fileWriteAll(const std::string &filePath, std::string_view contents);
+
+    /**
+     * Write the buffers to the file with a gathering write, without concatenating them first.
+     *
+     * @param append If true the buffers are appended to the file instead of replacing its contents.
+     * @param sync If true the data is flushed to the disk before returning.
+     */
+    void fileWrite(const std::string &filePath,
+                   const std::vector<std::string_view> &buffers,
+                   bool append = false,
+                   bool sync = false);
+
+    /**
+     * Write the buffers to a temporary file which is synced and renamed over the file,
+     * so that the file is never observed partially written.
+     */
+    void fileWriteAtomic(const std::string &filePath, const std::vector<std::string_view> &buffers);
 }
 
 #endif //QCALC_FILEOPERATIONS_HPP
@@ -0,0 +1,293 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "io/historyindex.hpp"
+
+#include <filesystem>
+#include <algorithm>
+#include <stdexcept>
+#include <cctype>
+#include <cstring>
+
+#include "io/fileoperations.hpp"
+
+static const char INDEX_MAGIC[4] = {'Q', 'C', 'H', 'I'};
+static const uint32_t INDEX_VERSION = 1;
+
+static char toLower(char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+static uint32_t getTrigram(const char *data) {
+    return static_cast<uint32_t>(static_cast<unsigned char>(toLower(data[0])))
+           | static_cast<uint32_t>(static_cast<unsigned char>(toLower(data[1]))) << 8
+           | static_cast<uint32_t>(static_cast<unsigned char>(toLower(data[2]))) << 16;
+}
+
+static bool containsIgnoreCase(const std::string &text, const std::string &lowerQuery) {
+    return std::search(text.begin(), text.end(), lowerQuery.begin(), lowerQuery.end(),
+                       [](char a, char b) { return toLower(a) == b; }) != text.end();
+}
+
+static bool matches(const HistoryIndex::Entry &entry, const std::string &lowerQuery) {
+    return containsIgnoreCase(entry.first, lowerQuery) || containsIgnoreCase(entry.second, lowerQuery);
+}
+
+/**
+ * Identifies the entries an index file was written for, the index is only a cache so a hash collision
+ * at worst produces stale search results until the next rebuild.
+ */
+static uint64_t getFingerprint(size_t size, const HistoryIndex::Accessor &accessor) {
+    uint64_t ret = size;
+    if (size > 0) {
+        std::hash<std::string> hash;
+        auto &first = accessor(0);
+        auto &last = accessor(size - 1);
+        ret = ret * 31 + hash(first.first);
+        ret = ret * 31 + hash(first.second);
+        ret = ret * 31 + hash(last.first);
+        ret = ret * 31 + hash(last.second);
+    }
+    return ret;
+}
+
+template<typename T>
+static void writeValue(std::string &out, T value) {
+    out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template<typename T>
+static bool readValue(std::string_view &data, T &value) {
+    if (data.size() < sizeof(T))
+        return false;
+    std::memcpy(&value, data.data(), sizeof(T));
+    data.remove_prefix(sizeof(T));
+    return true;
+}
+
+void HistoryIndex::append(const std::string &expression, const std::string &result) {
+    auto id = nextId++;
+    addTrigrams(expression, id);
+    addTrigrams(result, id);
+}
+
+void HistoryIndex::removeFront(size_t count) {
+    count = std::min(count, size());
+    firstId += static_cast<uint32_t>(count);
+    staleCount += count;
+    if (staleCount > size()) {
+        prune();
+    }
+}
+
+void HistoryIndex::clear() {
+    postings.clear();
+    firstId = 0;
+    nextId = 0;
+    staleCount = 0;
+}
+
+void HistoryIndex::rebuild(size_t size, const Accessor &accessor) {
+    clear();
+    for (size_t i = 0; i < size; i++) {
+        auto &entry = accessor(i);
+        append(entry.first, entry.second);
+    }
+}
+
+size_t HistoryIndex::size() const {
+    return nextId - firstId;
+}
+
+std::vector<size_t> HistoryIndex::find(const std::string &query, const Accessor &accessor) const {
+    std::vector<size_t> ret;
+    if (query.empty())
+        return ret;
+
+    std::string lowerQuery;
+    for (auto c: query) {
+        lowerQuery.push_back(toLower(c));
+    }
+
+    if (lowerQuery.size() < 3) {
+        // Too short for the index
+        for (size_t i = 0; i < size(); i++) {
+            if (matches(accessor(i), lowerQuery))
+                ret.emplace_back(i);
+        }
+        return ret;
+    }
+
+    std::vector<const std::vector<uint32_t> *> lists;
+    for (size_t i = 0; i + 3 <= lowerQuery.size(); i++) {
+        auto it = postings.find(getTrigram(lowerQuery.data() + i));
+        if (it == postings.end())
+            return ret;
+        if (std::find(lists.begin(), lists.end(), &it->second) == lists.end())
+            lists.emplace_back(&it->second);
+    }
+
+    std::sort(lists.begin(), lists.end(), [](const std::vector<uint32_t> *a, const std::vector<uint32_t> *b) {
+        return a->size() < b->size();
+    });
+
+    // Intersect starting from the shortest posting list
+    std::vector<uint32_t> candidates(std::lower_bound(lists.at(0)->begin(), lists.at(0)->end(), firstId),
+                                     lists.at(0)->end());
+    for (size_t i = 1; i < lists.size() && !candidates.empty(); i++) {
+        auto &list = *lists.at(i);
+        auto begin = list.begin();
+        size_t count = 0;
+        for (auto id: candidates) {
+            begin = std::lower_bound(begin, list.end(), id);
+            if (begin == list.end())
+                break;
+            if (*begin == id)
+                candidates[count++] = id;
+        }
+        candidates.resize(count);
+    }
+
+    // The trigrams of a query can occur in an entry without the query itself
+    for (auto id: candidates) {
+        auto position = static_cast<size_t>(id - firstId);
+        if (matches(accessor(position), lowerQuery))
+            ret.emplace_back(position);
+    }
+
+    return ret;
+}
+
+bool HistoryIndex::load(const std::string &path, size_t size, const Accessor &accessor) {
+    if (!std::filesystem::exists(path))
+        return false;
+
+    FileOperations::MappedFile file(path);
+    auto data = file.view();
+
+    uint32_t version;
+    uint64_t entryCount;
+    uint64_t fingerprint;
+    uint32_t listCount;
+    if (data.substr(0, sizeof(INDEX_MAGIC)) != std::string_view(INDEX_MAGIC, sizeof(INDEX_MAGIC)))
+        return false;
+    data.remove_prefix(sizeof(INDEX_MAGIC));
+    if (!readValue(data, version)
+        || version != INDEX_VERSION
+        || !readValue(data, entryCount)
+        || entryCount != size
+        || !readValue(data, fingerprint)
+        || fingerprint != getFingerprint(size, accessor)
+        || !readValue(data, listCount)) {
+        return false;
+    }
+
+    std::unordered_map<uint32_t, std::vector<uint32_t>> lists;
+    lists.reserve(listCount);
+    for (uint32_t i = 0; i < listCount; i++) {
+        uint32_t trigram;
+        uint32_t count;
+        if (!readValue(data, trigram)
+            || !readValue(data, count)
+            || count > size
+            || data.size() < count * sizeof(uint32_t)) {
+            return false;
+        }
+        auto &list = lists[trigram];
+        list.resize(count);
+        std::memcpy(list.data(), data.data(), count * sizeof(uint32_t));
+        data.remove_prefix(count * sizeof(uint32_t));
+        for (size_t p = 0; p < list.size(); p++) {
+            if (list[p] >= size || (p > 0 && list[p] <= list[p - 1]))
+                return false;
+        }
+    }
+
+    if (!data.empty())
+        return false;
+
+    postings = std::move(lists);
+    firstId = 0;
+    nextId = static_cast<uint32_t>(size);
+    staleCount = 0;
+    return true;
+}
+
+void HistoryIndex::save(const std::string &path, const Accessor &accessor) const {
+    std::vector<std::pair<uint32_t, std::vector<uint32_t>>> lists;
+    for (auto &pair: postings) {
+        std::vector<uint32_t> positions;
+        for (auto it = std::lower_bound(pair.second.begin(), pair.second.end(), firstId);
+             it != pair.second.end();
+             it++) {
+            positions.emplace_back(*it - firstId);
+        }
+        if (!positions.empty())
+            lists.emplace_back(pair.first, std::move(positions));
+    }
+
+    std::string header(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    writeValue(header, INDEX_VERSION);
+    writeValue(header, static_cast<uint64_t>(size()));
+    writeValue(header, getFingerprint(size(), accessor));
+    writeValue(header, static_cast<uint32_t>(lists.size()));
+
+    // The posting lists are written from their own storage, only the list headers are copied
+    std::vector<std::string> listHeaders;
+    listHeaders.reserve(lists.size());
+    std::vector<std::string_view> buffers;
+    buffers.reserve(lists.size() * 2 + 1);
+    buffers.emplace_back(header);
+    for (auto &pair: lists) {
+        auto &listHeader = listHeaders.emplace_back();
+        writeValue(listHeader, pair.first);
+        writeValue(listHeader, static_cast<uint32_t>(pair.second.size()));
+        buffers.emplace_back(listHeader);
+        buffers.emplace_back(reinterpret_cast<const char *>(pair.second.data()),
+                             pair.second.size() * sizeof(uint32_t));
+    }
+
+    FileOperations::fileWriteAtomic(path, buffers);
+}
+
+void HistoryIndex::addTrigrams(const std::string &text, uint32_t id) {
+    for (size_t i = 0; i + 3 <= text.size(); i++) {
+        auto &list = postings[getTrigram(text.data() + i)];
+        if (list.empty() || list.back() != id)
+            list.emplace_back(id);
+    }
+}
+
+void HistoryIndex::prune() {
+    for (auto it = postings.begin(); it != postings.end();) {
+        auto &list = it->second;
+        list.erase(list.begin(), std::lower_bound(list.begin(), list.end(), firstId));
+        for (auto &id: list) {
+            id -= firstId;
+        }
+        if (list.empty()) {
+            it = postings.erase(it);
+        } else {
+            it++;
+        }
+    }
+    nextId -= firstId;
+    firstId = 0;
+    staleCount = 0;
+}
@@ -0,0 +1,92 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_HISTORYINDEX_HPP
+#define QCALC_HISTORYINDEX_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <cstdint>
+
+/**
+ * A case-insensitive trigram index over the expressions and results of the history.
+ *
+ * Entries are addressed by their position in the history, the oldest retained entry has position 0.
+ * Appending and removing the oldest entries updates the index incrementally.
+ */
+class HistoryIndex {
+public:
+    typedef std::pair<std::string, std::string> Entry;
+
+    /**
+     * Returns the entry at the position, used to verify candidate matches.
+     */
+    typedef std::function<const Entry &(size_t position)> Accessor;
+
+    void append(const std::string &expression, const std::string &result);
+
+    /**
+     * Remove the oldest entries.
+     */
+    void removeFront(size_t count);
+
+    void clear();
+
+    /**
+     * Index the entries.
+     */
+    void rebuild(size_t size, const Accessor &accessor);
+
+    size_t size() const;
+
+    /**
+     * Find the entries whose expression or result contains the query, ignoring ASCII case.
+     *
+     * @return The positions of the matching entries in ascending order.
+     */
+    std::vector<size_t> find(const std::string &query, const Accessor &accessor) const;
+
+    /**
+     * Load the index written by save.
+     *
+     * Returns false if the file does not exist or does not match the passed entries,
+     * in which case the index should be rebuilt.
+     */
+    bool load(const std::string &path, size_t size, const Accessor &accessor);
+
+    /**
+     * Write the index to the file.
+     */
+    void save(const std::string &path, const Accessor &accessor) const;
+
+private:
+    void addTrigrams(const std::string &text, uint32_t id);
+
+    void prune();
+
+    // Posting lists of entry ids in ascending order, the id of an entry is firstId + position.
+    std::unordered_map<uint32_t, std::vector<uint32_t>> postings;
+    uint32_t firstId = 0;
+    uint32_t nextId = 0;
+    size_t staleCount = 0;
+};
+
+#endif //QCALC_HISTORYINDEX_HPP
@@ -0,0 +1,301 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "io/historyjournal.hpp"
+
+#include <filesystem>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+
+#include "io/fileoperations.hpp"
+
+static const char JOURNAL_MAGIC[4] = {'Q', 'C', 'H', 'J'};
+static const uint32_t JOURNAL_VERSION = 1;
+static const size_t HEADER_SIZE = 8;
+static const size_t RECORD_HEADER_SIZE = 12;
+static const uint32_t MAX_FIELD_SIZE = 16 * 1024 * 1024;
+
+// Records appended within this interval are written and synced together.
+static const std::chrono::milliseconds SYNC_INTERVAL(500);
+
+// The minimum number of records above the maximum before the journal is compacted.
+static const size_t MIN_COMPACTION_MARGIN = 64;
+
+static void writeUInt32(std::string &out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+static uint32_t readUInt32(const char *data) {
+    uint32_t ret = 0;
+    for (int i = 0; i < 4; i++) {
+        ret |= static_cast<uint32_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
+    return ret;
+}
+
+// FNV-1a
+static uint32_t checksum(const char *data, size_t size, uint32_t hash = 2166136261u) {
+    for (size_t i = 0; i < size; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static std::string encodeHeader() {
+    std::string ret(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+    writeUInt32(ret, JOURNAL_VERSION);
+    return ret;
+}
+
+static void encodeRecord(std::string &out, const std::string &expression, const std::string &result) {
+    if (expression.size() > MAX_FIELD_SIZE || result.size() > MAX_FIELD_SIZE)
+        throw std::runtime_error("History entry too large");
+    auto begin = out.size();
+    writeUInt32(out, static_cast<uint32_t>(expression.size()));
+    writeUInt32(out, static_cast<uint32_t>(result.size()));
+    auto sum = checksum(out.data() + begin, 8);
+    sum = checksum(expression.data(), expression.size(), sum);
+    sum = checksum(result.data(), result.size(), sum);
+    writeUInt32(out, sum);
+    out.append(expression);
+    out.append(result);
+}
+
+/**
+ * Decode the records in data until the end or the first invalid record.
+ *
+ * @return The size of the valid prefix of data, 0 if the header is invalid.
+ */
+static size_t decodeRecords(std::string_view data, std::vector<HistoryJournal::Entry> &entries) {
+    if (data.size() < HEADER_SIZE
+        || std::memcmp(data.data(), JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0
+        || readUInt32(data.data() + sizeof(JOURNAL_MAGIC)) != JOURNAL_VERSION) {
+        return 0;
+    }
+    size_t offset = HEADER_SIZE;
+    while (data.size() - offset >= RECORD_HEADER_SIZE) {
+        auto *record = data.data() + offset;
+        auto expressionSize = readUInt32(record);
+        auto resultSize = readUInt32(record + 4);
+        if (expressionSize > MAX_FIELD_SIZE || resultSize > MAX_FIELD_SIZE)
+            break;
+        auto size = RECORD_HEADER_SIZE + expressionSize + resultSize;
+        if (data.size() - offset < size)
+            break;
+        auto sum = checksum(record, 8);
+        sum = checksum(record + RECORD_HEADER_SIZE, expressionSize + resultSize, sum);
+        if (sum != readUInt32(record + 8))
+            break;
+        entries.emplace_back(std::string(record + RECORD_HEADER_SIZE, expressionSize),
+                             std::string(record + RECORD_HEADER_SIZE + expressionSize, resultSize));
+        offset += size;
+    }
+    return offset;
+}
+
+static std::string encodeEntries(const std::vector<HistoryJournal::Entry> &entries) {
+    auto ret = encodeHeader();
+    for (auto &entry: entries) {
+        encodeRecord(ret, entry.first, entry.second);
+    }
+    return ret;
+}
+
+HistoryJournal::HistoryJournal(std::string path, size_t maxEntries)
+        : path(std::move(path)), maxEntries(maxEntries) {}
+
+HistoryJournal::~HistoryJournal() {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        shutdown = true;
+    }
+    pendingChanged.notify_all();
+    if (writer.joinable())
+        writer.join();
+}
+
+std::vector<HistoryJournal::Entry> HistoryJournal::load() {
+    std::vector<Entry> ret;
+    if (!std::filesystem::exists(path)) {
+        recordCount = 0;
+        return ret;
+    }
+
+    size_t validSize;
+    size_t fileSize;
+    {
+        // The mapping is released before the file is truncated
+        FileOperations::MappedFile file(path);
+        validSize = decodeRecords(file.view(), ret);
+        fileSize = file.size();
+    }
+    if (validSize == 0) {
+        // Not a journal or the header was never completely written
+        FileOperations::fileWriteAtomic(path, {encodeHeader()});
+    } else if (validSize < fileSize) {
+        // Truncate the partially written trailing record
+        std::filesystem::resize_file(path, validSize);
+    }
+
+    recordCount = ret.size();
+    if (maxEntries > 0 && ret.size() > maxEntries) {
+        ret.erase(ret.begin(), ret.end() - static_cast<long>(maxEntries));
+    }
+    return ret;
+}
+
+void HistoryJournal::replace(const std::vector<Entry> &entries) {
+    auto begin = entries.begin();
+    if (maxEntries > 0 && entries.size() > maxEntries) {
+        begin = entries.end() - static_cast<long>(maxEntries);
+    }
+    std::vector<Entry> retained(begin, entries.end());
+    FileOperations::fileWriteAtomic(path, {encodeEntries(retained)});
+    recordCount = retained.size();
+}
+
+void HistoryJournal::append(const std::string &expression, const std::string &result) {
+    std::lock_guard<std::mutex> guard(mutex);
+    encodeRecord(pendingData, expression, result);
+    pendingCount++;
+    if (!writer.joinable()) {
+        writer = std::thread([this]() { run(); });
+    }
+    pendingChanged.notify_all();
+}
+
+std::string HistoryJournal::takeError() {
+    std::lock_guard<std::mutex> guard(mutex);
+    std::string ret;
+    ret.swap(error);
+    return ret;
+}
+
+void HistoryJournal::clear() {
+    std::lock_guard<std::mutex> guard(mutex);
+    pendingData.clear();
+    pendingCount = 0;
+    truncateRequested = true;
+    if (!writer.joinable()) {
+        writer = std::thread([this]() { run(); });
+    }
+    pendingChanged.notify_all();
+}
+
+void HistoryJournal::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!writer.joinable())
+        return;
+    // A batch which is already being written is awaited without requesting another one
+    if (pendingCount > 0 || truncateRequested)
+        flushRequested = true;
+    pendingChanged.notify_all();
+    batchWritten.wait(lock, [this]() {
+        return pendingCount == 0 && !truncateRequested && !writing;
+    });
+}
+
+void HistoryJournal::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        pendingChanged.wait(lock, [this]() {
+            return shutdown || pendingCount > 0 || truncateRequested;
+        });
+
+        // Collect the records appended in the meantime so that they are synced together
+        pendingChanged.wait_for(lock, SYNC_INTERVAL, [this]() {
+            return shutdown || flushRequested;
+        });
+
+        if (pendingCount == 0 && !truncateRequested) {
+            if (shutdown)
+                break;
+            continue;
+        }
+
+        std::string data;
+        data.swap(pendingData);
+        auto count = pendingCount;
+        auto truncate = truncateRequested;
+        pendingCount = 0;
+        truncateRequested = false;
+        flushRequested = false;
+        writing = true;
+
+        lock.unlock();
+
+        std::string batchError;
+        try {
+            if (truncate) {
+                FileOperations::fileWriteAtomic(path, {encodeHeader()});
+                recordCount = 0;
+            }
+            if (count > 0) {
+                writeBatch(data, count);
+            }
+            if (maxEntries > 0
+                && recordCount > maxEntries + std::max(MIN_COMPACTION_MARGIN, maxEntries / 2)) {
+                compact();
+            }
+        } catch (const std::exception &e) {
+            batchError = e.what();
+        }
+
+        lock.lock();
+        writing = false;
+        if (pendingCount == 0 && !truncateRequested)
+            flushRequested = false;
+        if (!batchError.empty())
+            error = batchError;
+        batchWritten.notify_all();
+    }
+}
+
+void HistoryJournal::writeBatch(const std::string &data, size_t count) {
+    if (!std::filesystem::exists(path)) {
+        FileOperations::fileWriteAtomic(path, {encodeHeader()});
+        recordCount = 0;
+    }
+    auto offset = std::filesystem::file_size(path);
+    try {
+        FileOperations::fileWrite(path, {data}, true, true);
+    } catch (const std::exception &e) {
+        // Remove the partially written records, records of later batches would be appended after them
+        // and discarded on load.
+        std::error_code ec;
+        std::filesystem::resize_file(path, offset, ec);
+        throw;
+    }
+    recordCount += count;
+}
+
+void HistoryJournal::compact() {
+    std::vector<Entry> entries;
+    {
+        FileOperations::MappedFile file(path);
+        decodeRecords(file.view(), entries);
+    }
+    replace(entries);
+}
@@ -0,0 +1,124 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_HISTORYJOURNAL_HPP
+#define QCALC_HISTORYJOURNAL_HPP
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * An append only file of expression / result records.
+ *
+ * Each record is stored as the lengths of the expression and result, a checksum and the data.
+ * Appended records are written and synced to disk in batches by a background thread.
+ * When the number of records exceeds the maximum by a margin the thread rewrites the file
+ * with only the newest records.
+ *
+ * A record which was only partially written, for example because the application crashed,
+ * fails the checksum and is truncated from the file on load.
+ */
+class HistoryJournal {
+public:
+    typedef std::pair<std::string, std::string> Entry;
+
+    /**
+     * @param path The path of the journal file.
+     * @param maxEntries The maximum number of entries that are kept, 0 for unlimited.
+     */
+    HistoryJournal(std::string path, size_t maxEntries);
+
+    /**
+     * Writes all pending records before returning.
+     */
+    ~HistoryJournal();
+
+    HistoryJournal(const HistoryJournal &) = delete;
+
+    HistoryJournal &operator=(const HistoryJournal &) = delete;
+
+    /**
+     * Read the entries in the journal and truncate invalid trailing records.
+     * Must be called before appending.
+     *
+     * @return The newest maxEntries entries, oldest first.
+     */
+    std::vector<Entry> load();
+
+    /**
+     * Replace the contents of the journal file.
+     * Must be called before appending.
+     *
+     * @param entries The entries, oldest first.
+     */
+    void replace(const std::vector<Entry> &entries);
+
+    /**
+     * Queue a record to be appended to the journal.
+     * Failures of the background writes are not reported here, see takeError.
+     *
+     * Throws if the record is too large to be stored.
+     */
+    void append(const std::string &expression, const std::string &result);
+
+    /**
+     * @return The error of the last failed background write, or an empty string if no write has failed since the last call.
+     */
+    std::string takeError();
+
+    /**
+     * Discard all records including pending ones.
+     */
+    void clear();
+
+    /**
+     * Block until all pending records have been written and synced.
+     */
+    void flush();
+
+private:
+    void run();
+
+    void writeBatch(const std::string &data, size_t count);
+
+    void compact();
+
+    std::string path;
+    size_t maxEntries;
+
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable pendingChanged;
+    std::condition_variable batchWritten;
+
+    std::string pendingData; // Encoded records which have not been written yet
+    size_t pendingCount = 0;
+    bool truncateRequested = false;
+    bool flushRequested = false;
+    bool shutdown = false;
+    bool writing = false;
+    std::string error;
+
+    size_t recordCount = 0; // Only accessed by the writer thread after load / replace
+};
+
+#endif //QCALC_HISTORYJOURNAL_HPP
@@ -50,3 +50,9 @@ std::string Paths::getLibDirectory() {
     QDir().mkpath(ret);
     return ret.toStdString();
 }
+
+std::string Paths::getPythonCacheDirectory() {
+    auto ret = getAppDataDirectory().append("/pycache");
+    QDir().mkpath(ret.c_str());
+    return ret;
+}
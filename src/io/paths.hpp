@@ -27,6 +27,10 @@ namespace Paths {
     static const std::string SETTINGS_FILE = "/settings.json";
     static const std::string SYMBOL_TABLE_HISTORY_FILE = "/sym_path_history.txt";
     static const std::string HISTORY_FILE = "/history.txt";
+    static const std::string HISTORY_JOURNAL_FILE = "/history.journal";
+    static const std::string HISTORY_INDEX_FILE = "/history.index";
+    static const std::string PYTHON_INIT_CHECK_FILE = "/python_init_check.json";
+    static const std::string ADDON_INDEX_FILE = "/addon_index.json";
     static const std::string CALCULATOR_ICON_FILE = "/icons/calculator.ico";
     static const std::string SYMBOLS_ICON_FILE = "/icons/symbols.ico";
     static const std::string TERMINAL_ICON_FILE = "/icons/terminal.ico";
@@ -41,6 +45,12 @@ namespace Paths {
 
     std::string getLibDirectory();
 
+    /**
+     * The directory which the interpreter uses for bytecode instead of the __pycache__ directories next to the sources,
+     * so that an installation in a read-only location still caches bytecode.
+     */
+    std::string getPythonCacheDirectory();
+
     inline std::string getAddonsFile() {
         return getAppConfigDirectory() + ADDONS_FILE;
     }
@@ -57,6 +67,22 @@ namespace Paths {
         return getAppConfigDirectory() + HISTORY_FILE;
     }
 
+    inline std::string getHistoryJournalFile() {
+        return getAppConfigDirectory() + HISTORY_JOURNAL_FILE;
+    }
+
+    inline std::string getHistoryIndexFile() {
+        return getAppConfigDirectory() + HISTORY_INDEX_FILE;
+    }
+
+    inline std::string getPythonInitCheckFile() {
+        return getAppDataDirectory() + PYTHON_INIT_CHECK_FILE;
+    }
+
+    inline std::string getAddonIndexFile() {
+        return getAppDataDirectory() + ADDON_INDEX_FILE;
+    }
+
     inline std::string getCalculatorIconFile() {
         return getApplicationDirectory() + CALCULATOR_ICON_FILE;
     }
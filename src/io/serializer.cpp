@@ -19,8 +19,178 @@
 
 #include "serializer.hpp"
 
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
 #include "json.hpp"
 
+static const char TABLE_MAGIC[4] = {'Q', 'C', 'S', 'T'};
+static const uint32_t TABLE_VERSION = 1;
+static const char *const TABLE_EXTENSION = ".qcst";
+
+static const uint8_t VALUE_FLAGS = MPD_NEG | MPD_SPECIAL;
+
+namespace {
+    /**
+     * Appends little endian values to a buffer.
+     */
+    class BinaryWriter {
+    public:
+        template<typename T>
+        void write(T value) {
+            for (size_t i = 0; i < sizeof(T); i++) {
+                data.push_back(static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xFF));
+            }
+        }
+
+        void write(const std::string &str) {
+            write(static_cast<uint32_t>(str.size()));
+            data.append(str);
+        }
+
+        void write(const decimal::Decimal &value) {
+            const mpd_t *v = value.getconst();
+            write(static_cast<uint8_t>(v->flags & VALUE_FLAGS));
+            write(static_cast<int64_t>(v->exp));
+            write(static_cast<uint32_t>(v->len));
+            for (mpd_ssize_t i = 0; i < v->len; i++) {
+                write(static_cast<uint64_t>(v->data[i]));
+            }
+        }
+
+        std::string data;
+    };
+
+    /**
+     * Reads little endian values from a buffer, throws if the buffer ends early.
+     */
+    class BinaryReader {
+    public:
+        explicit BinaryReader(std::string_view data) : data(data) {}
+
+        template<typename T>
+        T read() {
+            auto bytes = take(sizeof(T));
+            uint64_t ret = 0;
+            for (size_t i = 0; i < sizeof(T); i++) {
+                ret |= static_cast<uint64_t>(static_cast<unsigned char>(bytes[i])) << (8 * i);
+            }
+            return static_cast<T>(ret);
+        }
+
+        std::string readString() {
+            auto size = read<uint32_t>();
+            return std::string(take(size));
+        }
+
+        decimal::Decimal readDecimal(int radixDigits) {
+            auto flags = read<uint8_t>();
+            auto exp = read<int64_t>();
+            auto len = read<uint32_t>();
+            auto special = flags & MPD_SPECIAL;
+            // Special values can have an empty coefficient
+            if ((len == 0 && !special)
+                || (flags & ~VALUE_FLAGS) != 0
+                || (special != 0 && special != MPD_INF && special != MPD_NAN && special != MPD_SNAN)
+                || exp < MPD_MIN_ETINY
+                || exp > MPD_MAX_EMAX
+                || len > remaining() / sizeof(uint64_t)) {
+                throw std::runtime_error("Invalid symbol table value");
+            }
+
+            if (radixDigits != MPD_RDIGITS)
+                return readDecimalString(flags, exp, len, radixDigits);
+
+            decimal::Decimal ret;
+            mpd_t *dst = ret.get();
+
+            uint32_t status = 0;
+            if (!mpd_qresize(dst, std::max<uint32_t>(len, 1), &status))
+                throw std::runtime_error("Failed to allocate decimal coefficient");
+
+            for (uint32_t i = 0; i < len; i++) {
+                auto word = read<uint64_t>();
+                if (word >= MPD_RADIX || (i == len - 1 && i > 0 && word == 0))
+                    throw std::runtime_error("Invalid symbol table value");
+                dst->data[i] = static_cast<mpd_uint_t>(word);
+            }
+
+            mpd_set_flags(dst, flags);
+            dst->exp = static_cast<mpd_ssize_t>(exp);
+            dst->len = len;
+            if (len > 0) {
+                mpd_setdigits(dst);
+            } else {
+                dst->digits = 0;
+            }
+
+            if (!special)
+                checkAdjustedExponent(exp, dst->digits);
+
+            return ret;
+        }
+
+        size_t remaining() const {
+            return data.size();
+        }
+
+    private:
+        std::string_view take(size_t size) {
+            if (data.size() < size)
+                throw std::runtime_error("Unexpected end of symbol table");
+            auto ret = data.substr(0, size);
+            data.remove_prefix(size);
+            return ret;
+        }
+
+        /**
+         * Throw if the most significant digit of a finite value is above the largest exponent of libmpdec.
+         */
+        static void checkAdjustedExponent(int64_t exp, int64_t digits) {
+            if (exp + digits - 1 > MPD_MAX_EMAX)
+                throw std::runtime_error("Invalid symbol table value");
+        }
+
+        /**
+         * Restore a value written with a different coefficient radix through its string representation.
+         */
+        decimal::Decimal readDecimalString(uint8_t flags, int64_t exp, uint32_t len, int radixDigits) {
+            uint64_t radix = 1;
+            for (int i = 0; i < radixDigits; i++) {
+                radix *= 10;
+            }
+
+            std::string coefficient;
+            for (uint32_t i = 0; i < len; i++) {
+                auto value = read<uint64_t>();
+                if (value >= radix || (i == len - 1 && i > 0 && value == 0))
+                    throw std::runtime_error("Invalid symbol table value");
+                auto word = std::to_string(value);
+                if (i > 0)
+                    word.insert(0, static_cast<size_t>(std::max(0, radixDigits - static_cast<int>(word.size()))), '0');
+                coefficient.insert(0, word);
+            }
+
+            std::string str = flags & MPD_NEG ? "-" : "";
+            if (flags & MPD_INF) {
+                str += "Infinity";
+            } else if (flags & (MPD_NAN | MPD_SNAN)) {
+                str += flags & MPD_SNAN ? "sNaN" : "NaN";
+                if (!coefficient.empty() && coefficient != "0")
+                    str += coefficient;
+            } else {
+                checkAdjustedExponent(exp, static_cast<int64_t>(coefficient.size()));
+                str += coefficient + "E" + std::to_string(exp);
+            }
+
+            return decimal::Decimal::exact(str, decimal::context);
+        }
+
+        std::string_view data;
+    };
+}
+
 std::string Serializer::serializeTable(const SymbolTable &table) {
     nlohmann::json j;
     j["version"] = 0;
@@ -51,6 +221,7 @@ std::string Serializer::serializeTable(const SymbolTable &table) {
         t["name"] = p.first;
         t["expression"] = p.second.expression;
         t["argumentNames"] = p.second.argumentNames;
+        t["pure"] = p.second.pure;
         tmp.emplace_back(t);
     }
     j["functions"] = tmp;
@@ -59,8 +230,98 @@ std::string Serializer::serializeTable(const SymbolTable &table) {
     return nlohmann::to_string(j);
 }
 
-SymbolTable Serializer::deserializeTable(const std::string &str) {
-    nlohmann::json j = nlohmann::json::parse(str);
+std::string Serializer::serializeTableBinary(const SymbolTable &table) {
+    BinaryWriter writer;
+    writer.data.append(TABLE_MAGIC, sizeof(TABLE_MAGIC));
+    writer.write(TABLE_VERSION);
+    writer.write(static_cast<uint8_t>(MPD_RDIGITS));
+    writer.write(static_cast<uint8_t>(table.getUseBuiltInConstants()));
+
+    writer.write(static_cast<uint32_t>(table.getVariables().size()));
+    for (auto &p: table.getVariables()) {
+        writer.write(p.first);
+        writer.write(p.second);
+    }
+
+    writer.write(static_cast<uint32_t>(table.getConstants().size()));
+    for (auto &p: table.getConstants()) {
+        writer.write(p.first);
+        writer.write(p.second);
+    }
+
+    writer.write(static_cast<uint32_t>(table.getFunctions().size()));
+    for (auto &p: table.getFunctions()) {
+        writer.write(p.first);
+        writer.write(p.second.expression);
+        writer.write(static_cast<uint32_t>(p.second.argumentNames.size()));
+        for (auto &arg: p.second.argumentNames) {
+            writer.write(arg);
+        }
+        writer.write(static_cast<uint8_t>(p.second.pure));
+    }
+
+    return std::move(writer.data);
+}
+
+static SymbolTable deserializeTableBinary(std::string_view str) {
+    BinaryReader reader(str.substr(sizeof(TABLE_MAGIC)));
+    auto version = reader.read<uint32_t>();
+    if (version != TABLE_VERSION)
+        throw std::runtime_error("Unsupported symbol table version " + std::to_string(version));
+
+    auto radixDigits = reader.read<uint8_t>();
+    if (radixDigits == 0 || radixDigits > 19)
+        throw std::runtime_error("Invalid symbol table header");
+
+    SymbolTable ret;
+    ret.setUseBuiltInConstants(reader.read<uint8_t>() != 0);
+
+    auto count = reader.read<uint32_t>();
+    for (uint32_t i = 0; i < count; i++) {
+        auto name = reader.readString();
+        ret.setVariable(name, reader.readDecimal(radixDigits));
+    }
+
+    count = reader.read<uint32_t>();
+    for (uint32_t i = 0; i < count; i++) {
+        auto name = reader.readString();
+        ret.setConstant(name, reader.readDecimal(radixDigits));
+    }
+
+    count = reader.read<uint32_t>();
+    for (uint32_t i = 0; i < count; i++) {
+        auto name = reader.readString();
+        Function f;
+        f.expression = reader.readString();
+        auto argumentCount = reader.read<uint32_t>();
+        for (uint32_t a = 0; a < argumentCount; a++) {
+            f.argumentNames.emplace_back(reader.readString());
+        }
+        f.pure = reader.read<uint8_t>() != 0;
+        ret.setFunction(name, f);
+    }
+
+    if (reader.remaining() != 0)
+        throw std::runtime_error("Unexpected data at the end of symbol table");
+
+    return ret;
+}
+
+bool Serializer::isBinaryTable(std::string_view str) {
+    return str.size() >= sizeof(TABLE_MAGIC) && std::memcmp(str.data(), TABLE_MAGIC, sizeof(TABLE_MAGIC)) == 0;
+}
+
+bool Serializer::isBinaryTableFilename(const std::string &filename) {
+    auto extension = std::string(TABLE_EXTENSION);
+    return filename.size() >= extension.size()
+           && filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+SymbolTable Serializer::deserializeTable(std::string_view str) {
+    if (isBinaryTable(str))
+        return deserializeTableBinary(str);
+
+    nlohmann::json j = nlohmann::json::parse(str.begin(), str.end());
     SymbolTable ret;
 
     ret.setUseBuiltInConstants(j["useBuiltInConstants"]);
@@ -87,6 +348,7 @@ SymbolTable Serializer::deserializeTable(const std::string &str) {
         Function f;
         f.expression = v["expression"];
         f.argumentNames = v["argumentNames"].get<std::vector<std::string>>();
+        f.pure = v.value("pure", false);
         ret.setFunction(name, f);
     }
 
@@ -117,9 +379,9 @@ std::string Serializer::serializeSettings(const Settings &settings) {
     return nlohmann::to_string(j);
 }
 
-Settings Serializer::deserializeSettings(const std::string &str) {
+Settings Serializer::deserializeSettings(std::string_view str) {
     Settings ret;
-    nlohmann::json j = nlohmann::json::parse(str);
+    nlohmann::json j = nlohmann::json::parse(str.begin(), str.end());
     for (auto &entry: j.items()) {
         const std::string &key = entry.key();
         const auto &value = entry.value();
@@ -142,8 +404,8 @@ std::string Serializer::serializeSet(const std::set<std::string> &set) {
     return nlohmann::to_string(j);
 }
 
-std::set<std::string> Serializer::deserializeSet(const std::string &str) {
-    nlohmann::json j = nlohmann::json::parse(str);
+std::set<std::string> Serializer::deserializeSet(std::string_view str) {
+    nlohmann::json j = nlohmann::json::parse(str.begin(), str.end());
     return j["data"];
 }
 
@@ -21,6 +21,7 @@
 #define QT_CALC_SERIALIZER_HPP
 
 #include <string>
+#include <string_view>
 #include <set>
 
 #include "calculator/symboltable.hpp"
@@ -30,15 +31,35 @@
 namespace Serializer {
     std::string serializeTable(const SymbolTable &table);
 
-    SymbolTable deserializeTable(const std::string &str);
+    /**
+     * Serialize the table in the versioned binary format.
+     * The values are stored as the coefficient words of the decimals so they are restored exactly,
+     * without formatting and parsing a string per value.
+     */
+    std::string serializeTableBinary(const SymbolTable &table);
+
+    /**
+     * Deserialize a table in either the json or the binary format.
+     */
+    SymbolTable deserializeTable(std::string_view str);
+
+    /**
+     * @return True if the data starts with the header of the binary table format.
+     */
+    bool isBinaryTable(std::string_view str);
+
+    /**
+     * @return True if the file name has the extension of the binary table format (.qcst).
+     */
+    bool isBinaryTableFilename(const std::string &filename);
 
     std::string serializeSettings(const Settings &settings);
 
-    Settings deserializeSettings(const std::string &str);
+    Settings deserializeSettings(std::string_view str);
 
     std::string serializeSet(const std::set<std::string> &set);
 
-    std::set<std::string> deserializeSet(const std::string &str);
+    std::set<std::string> deserializeSet(std::string_view str);
 
     int serializeRoundingMode(decimal::round mode);
 
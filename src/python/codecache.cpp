@@ -0,0 +1,127 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "python/codecache.hpp"
+
+#include <map>
+#include <list>
+#include <mutex>
+#include <tuple>
+#include <functional>
+
+#include "python/pythoninclude.hpp"
+
+namespace {
+struct Key {
+    size_t hash;
+    int startToken;
+    std::string context;
+
+    bool operator<(const Key &other) const {
+        return std::tie(hash, startToken, context) < std::tie(other.hash, other.startToken, other.context);
+    }
+};
+
+struct Entry {
+    Key key;
+    std::string source;
+    PyObject *code;
+};
+
+}
+
+typedef std::list<Entry> EntryList;
+
+static EntryList entries; // Ordered from most recently used to least recently used
+static std::multimap<Key, EntryList::iterator> entryIndex;
+
+static std::mutex statisticsMutex;
+static CodeCache::Statistics statistics;
+
+static void updateStatistics(bool hit) {
+    std::lock_guard<std::mutex> guard(statisticsMutex);
+    if (hit)
+        statistics.hits++;
+    else
+        statistics.misses++;
+    statistics.entries = entries.size();
+}
+
+PyObject *CodeCache::getCode(const std::string &source, int startToken, const std::string &context) {
+    if (source.size() > MAX_SOURCE_SIZE) {
+        updateStatistics(false);
+        return Py_CompileString(source.c_str(), "<string>", startToken);
+    }
+
+    Key key{std::hash<std::string>()(source), startToken, context};
+
+    auto range = entryIndex.equal_range(key);
+    for (auto it = range.first; it != range.second; it++) {
+        if (it->second->source == source) {
+            // Move the entry to the front of the list, iterators stay valid when splicing.
+            entries.splice(entries.begin(), entries, it->second);
+            updateStatistics(true);
+            Py_INCREF(it->second->code);
+            return it->second->code;
+        }
+    }
+
+    PyObject *code = Py_CompileString(source.c_str(), "<string>", startToken);
+    if (code == NULL) {
+        updateStatistics(false);
+        return NULL;
+    }
+
+    entries.push_front(Entry{key, source, code});
+    Py_INCREF(code);
+    entryIndex.emplace(key, entries.begin());
+
+    while (entries.size() > CAPACITY) {
+        auto &last = entries.back();
+        auto lastRange = entryIndex.equal_range(last.key);
+        for (auto it = lastRange.first; it != lastRange.second; it++) {
+            if (it->second == std::prev(entries.end())) {
+                entryIndex.erase(it);
+                break;
+            }
+        }
+        Py_DECREF(last.code);
+        entries.pop_back();
+    }
+
+    updateStatistics(false);
+
+    return code;
+}
+
+CodeCache::Statistics CodeCache::getStatistics() {
+    std::lock_guard<std::mutex> guard(statisticsMutex);
+    return statistics;
+}
+
+void CodeCache::clear() {
+    for (auto &entry: entries) {
+        Py_DECREF(entry.code);
+    }
+    entries.clear();
+    entryIndex.clear();
+
+    std::lock_guard<std::mutex> guard(statisticsMutex);
+    statistics = {};
+}
@@ -0,0 +1,70 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_CODECACHE_HPP
+#define QCALC_CODECACHE_HPP
+
+#include <string>
+
+struct _object;
+typedef _object PyObject;
+
+/**
+ * A bounded least recently used cache of compiled python code objects.
+ *
+ * Entries are keyed by the hash of the source together with the parse style and the context module name,
+ * the source itself is stored with the entry so that hash collisions never return the wrong code object.
+ * Sources larger than MAX_SOURCE_SIZE are compiled every time and not cached.
+ *
+ * Except for getStatistics all functions must be called with the GIL held.
+ */
+namespace CodeCache {
+    static const size_t CAPACITY = 256;
+    static const size_t MAX_SOURCE_SIZE = 64 * 1024;
+
+    struct Statistics {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t entries = 0;
+
+        double hitRate() const {
+            auto total = hits + misses;
+            return total == 0 ? 0 : static_cast<double>(hits) / static_cast<double>(total);
+        }
+    };
+
+    /**
+     * Return the cached code object or compile the source and insert it into the cache.
+     *
+     * @param source The python source
+     * @param startToken The python start token (Py_single_input, Py_file_input, ...)
+     * @param context The name of the module in which the code is run
+     * @return A new reference to the code object or NULL with the python error set if compilation failed.
+     */
+    PyObject *getCode(const std::string &source, int startToken, const std::string &context);
+
+    Statistics getStatistics();
+
+    /**
+     * Release all cached code objects, must be called before the interpreter is finalized.
+     */
+    void clear();
+}
+
+#endif //QCALC_CODECACHE_HPP
@@ -0,0 +1,203 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "python/decimalutil.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "python/pythoninclude.hpp"
+#include "python/interpreter.hpp"
+
+/**
+ * The object layout of decimal.Decimal in the C implementation of the python decimal module (Modules/_decimal),
+ * which has been the same since python 3.3.
+ *
+ * No released python installs the pydecimal.h header or exports the decimal C API capsule,
+ * so the layout is checked at runtime against a known value before it is used.
+ */
+struct PyDecObject {
+    PyObject_HEAD
+    Py_hash_t hash;
+    mpd_t dec;
+    mpd_uint_t data[4];
+};
+
+// A value with a coefficient of more than one word on every libmpdec configuration
+static const char *const PROBE_VALUE = "-1234567890123456789012345678E-7";
+
+static const uint8_t VALUE_FLAGS = MPD_NEG | MPD_SPECIAL;
+
+static PyObject *decimalType = nullptr;
+static bool nativeLayout = false;
+
+/**
+ * @return True if the decimal type has the expected object layout and uses the same libmpdec configuration.
+ */
+static bool checkLayout(PyObject *type) {
+    if (!PyType_Check(type) || reinterpret_cast<PyTypeObject *>(type)->tp_basicsize != sizeof(PyDecObject))
+        return false;
+
+    PyObject *probe = PyObject_CallFunction(type, "s", PROBE_VALUE);
+    if (probe == NULL) {
+        PyErr_Clear();
+        return false;
+    }
+
+    auto *object = reinterpret_cast<PyDecObject *>(probe);
+    const mpd_t *actual = &object->dec;
+    decimal::Decimal value = decimal::Decimal::exact(PROBE_VALUE, decimal::context);
+    const mpd_t *expected = value.getconst();
+
+    bool ret = actual->data == object->data
+               && (actual->flags & VALUE_FLAGS) == (expected->flags & VALUE_FLAGS)
+               && actual->exp == expected->exp
+               && actual->digits == expected->digits
+               && actual->len == expected->len
+               && std::equal(expected->data, expected->data + expected->len, actual->data);
+
+    Py_DECREF(probe);
+    return ret;
+}
+
+static PyObject *getDecimalType() {
+    if (decimalType != nullptr) {
+        return decimalType;
+    }
+
+    PyObject *module = PyImport_ImportModule("decimal");
+    if (module == NULL) {
+        throw std::runtime_error("Failed to import decimal module, Error: " + Interpreter::getError());
+    }
+
+    decimalType = PyObject_GetAttrString(module, "Decimal");
+    Py_DECREF(module);
+    if (decimalType == NULL) {
+        throw std::runtime_error("Failed to get Decimal class object");
+    }
+
+    nativeLayout = checkLayout(decimalType);
+
+    return decimalType;
+}
+
+static void copyValue(mpd_t *dst, const mpd_t *src) {
+    mpd_set_flags(dst, src->flags & VALUE_FLAGS);
+    dst->exp = src->exp;
+    dst->digits = src->digits;
+    dst->len = src->len;
+    std::copy(src->data, src->data + src->len, dst->data);
+}
+
+PyObject *DecimalUtil::New(const decimal::Decimal &value) {
+    PyObject *type = getDecimalType();
+
+    if (nativeLayout) {
+        const mpd_t *src = value.getconst();
+        PyObject *ret = PyObject_CallNoArgs(type);
+        if (ret == NULL) {
+            throw std::runtime_error(Interpreter::getError());
+        }
+
+        // The python decimal object was just created and is not shared yet,
+        // the coefficient is copied into the preallocated data so that no memory owned by python is reallocated.
+        auto *object = reinterpret_cast<PyDecObject *>(ret);
+        mpd_t *dst = &object->dec;
+        if (dst->data == object->data && dst->alloc >= src->len) {
+            copyValue(dst, src);
+            return ret;
+        }
+
+        Py_DECREF(ret);
+    }
+
+    PyObject *ret = PyObject_CallFunction(type, "s", value.to_sci().c_str());
+    if (ret == NULL) {
+        throw std::runtime_error(Interpreter::getError());
+    }
+    return ret;
+}
+
+decimal::Decimal DecimalUtil::Convert(PyObject *o) {
+    PyObject *type = getDecimalType();
+
+    if (PyObject_TypeCheck(o, reinterpret_cast<PyTypeObject *>(type))) {
+        if (nativeLayout) {
+            const mpd_t *src = &reinterpret_cast<PyDecObject *>(o)->dec;
+
+            decimal::Decimal ret;
+            mpd_t *dst = ret.get();
+
+            uint32_t status = 0;
+            if (!mpd_qresize(dst, std::max<mpd_ssize_t>(src->len, 1), &status)) {
+                throw std::runtime_error("Failed to allocate decimal coefficient");
+            }
+
+            copyValue(dst, src);
+
+            return ret;
+        }
+        PyObject *str = PyObject_Str(o);
+        if (str == NULL) {
+            throw std::runtime_error(Interpreter::getError());
+        }
+        decimal::Decimal ret(PyUnicode_AsUTF8(str));
+        Py_DECREF(str);
+        return ret;
+    } else if (PyLong_Check(o)) {
+        int overflow = 0;
+        long long v = PyLong_AsLongLongAndOverflow(o, &overflow);
+        if (overflow == 0) {
+            if (v == -1 && PyErr_Occurred() != NULL) {
+                throw std::runtime_error(Interpreter::getError());
+            }
+            return {static_cast<int64_t>(v)};
+        }
+        PyObject *str = PyObject_Str(o);
+        if (str == NULL) {
+            throw std::runtime_error(Interpreter::getError());
+        }
+        decimal::Decimal ret(PyUnicode_AsUTF8(str));
+        Py_DECREF(str);
+        return ret;
+    } else if (PyFloat_Check(o)) {
+        char *str = PyOS_double_to_string(PyFloat_AsDouble(o), 'r', 0, 0, NULL);
+        if (str == NULL) {
+            throw std::runtime_error(Interpreter::getError());
+        }
+        decimal::Decimal ret(str);
+        PyMem_Free(str);
+        return ret;
+    } else if (PyUnicode_Check(o)) {
+        const char *str = PyUnicode_AsUTF8(o);
+        if (str == NULL) {
+            throw std::runtime_error(Interpreter::getError());
+        }
+        return {str};
+    } else {
+        throw std::runtime_error("Value must be decimal, string, float or long");
+    }
+}
+
+void DecimalUtil::Reset() {
+    Py_XDECREF(decimalType);
+    decimalType = nullptr;
+    nativeLayout = false;
+}
@@ -0,0 +1,65 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_DECIMALUTIL_HPP
+#define QCALC_DECIMALUTIL_HPP
+
+#include <decimal.hh>
+
+struct _object;
+typedef _object PyObject;
+
+/**
+ * Conversion between decimal::Decimal and instances of the python decimal.Decimal class.
+ *
+ * When the C implementation of the python decimal module is used and its object layout and libmpdec configuration
+ * match, the coefficient words, exponent and sign are copied directly between the mpd_t structures
+ * without formatting or parsing a string.
+ * Values which do not fit into the preallocated coefficient of a python decimal object
+ * and the pure python implementation fall back to the exact scientific string representation.
+ *
+ * All functions must be called with the GIL held.
+ */
+namespace DecimalUtil {
+    /**
+     * Throws on error and does NOT touch python errors in any way.
+     *
+     * @param value
+     * @return A new reference to a decimal.Decimal object which is exactly equal to value.
+     */
+    PyObject *New(const decimal::Decimal &value);
+
+    /**
+     * Throws on error and does NOT touch python errors in any way.
+     *
+     * Integers are converted exactly regardless of their magnitude,
+     * floats are converted from their shortest round trip representation.
+     *
+     * @param o A decimal.Decimal, int, float or str object
+     * @return The converted value
+     */
+    decimal::Decimal Convert(PyObject *o);
+
+    /**
+     * Release the cached reference to the decimal type, must be called before the interpreter is finalized.
+     */
+    void Reset();
+}
+
+#endif //QCALC_DECIMALUTIL_HPP
@@ -20,22 +20,46 @@
 #include "python/interpreter.hpp"
 #include "python/pythoninclude.hpp"
 
+#include <filesystem>
+
 #include "python/modules/stdredirmodule.hpp"
 #include "python/modules/exprtkmodule.hpp"
 #include "python/pythoninterpreterstate.hpp"
+#include "python/decimalutil.hpp"
+#include "python/codecache.hpp"
 
 static bool pyInitialized = false;
+static std::string cachePrefix;
+
+void Interpreter::setCachePrefix(const std::string &directory) {
+    cachePrefix = directory;
+}
 
 void Interpreter::initialize() {
     if (!pyInitialized) {
-        Py_Initialize();
+        PyConfig config;
+        PyConfig_InitPythonConfig(&config);
+        PyStatus status = PyStatus_Ok();
+        if (!cachePrefix.empty()) {
+            status = PyConfig_SetBytesString(&config, &config.pycache_prefix, cachePrefix.c_str());
+        }
+        if (!PyStatus_Exception(status)) {
+            status = Py_InitializeFromConfig(&config);
+        }
+        PyConfig_Clear(&config);
+        if (PyStatus_Exception(status)) {
+            Py_ExitStatusException(status);
+        }
     }
     pyInitialized = true;
 }
 
 void Interpreter::finalize() {
-    if (pyInitialized)
+    if (pyInitialized) {
+        DecimalUtil::Reset();
+        CodeCache::clear();
         Py_Finalize();
+    }
     pyInitialized = false;
 }
 
@@ -204,7 +228,19 @@ void Interpreter::runString(const std::string &expression,
 
     PyObject *g = PyModule_GetDict(m); //Borrowed
 
-    PyObject *r = PyRun_String(expression.c_str(), pyStyle, g, g);
+    PyObject *code = CodeCache::getCode(expression, pyStyle, context);
+    if (code == NULL) {
+        Py_DECREF(m);
+        Py_DECREF(n);
+
+        auto error = getError();
+        PyGILState_Release(gstate);
+        throw std::runtime_error(error);
+    }
+
+    PyObject *r = PyEval_EvalCode(code, g, g);
+
+    Py_DECREF(code);
 
     if (r == NULL) {
         Py_DECREF(m);
@@ -259,6 +295,21 @@ void Interpreter::callFunctionNoArgs(const std::string &m, const std::string &f)
     PyGILState_Release(gstate);
 }
 
+void Interpreter::importModule(const std::string &module) {
+    PyGILState_STATE gstate;
+    gstate = PyGILState_Ensure();
+
+    PyObject *mod = PyImport_ImportModule(module.c_str());
+    if (mod == NULL) {
+        auto error = getError();
+        PyGILState_Release(gstate);
+        throw std::runtime_error(error);
+    }
+    Py_DECREF(mod);
+
+    PyGILState_Release(gstate);
+}
+
 void Interpreter::reloadModule(const std::string &module) {
     PyGILState_STATE gstate;
     gstate = PyGILState_Ensure();
@@ -277,6 +328,84 @@ void Interpreter::reloadModule(const std::string &module) {
     PyGILState_Release(gstate);
 }
 
+void Interpreter::compileFiles(const std::vector<std::string> &files, bool force) {
+    PyGILState_STATE gstate;
+    gstate = PyGILState_Ensure();
+
+    PyObject *pyCompile = PyImport_ImportModule("py_compile");
+    PyObject *importUtil = PyImport_ImportModule("importlib.util");
+    if (pyCompile == NULL || importUtil == NULL) {
+        auto error = getError();
+        Py_XDECREF(pyCompile);
+        Py_XDECREF(importUtil);
+        PyGILState_Release(gstate);
+        throw std::runtime_error(error);
+    }
+
+    PyObject *compile = PyObject_GetAttrString(pyCompile, "compile");
+    PyObject *cacheFromSource = PyObject_GetAttrString(importUtil, "cache_from_source");
+    PyObject *invalidationModes = PyObject_GetAttrString(pyCompile, "PycInvalidationMode");
+    PyObject *checkedHash = invalidationModes == NULL
+                            ? NULL
+                            : PyObject_GetAttrString(invalidationModes, "CHECKED_HASH");
+    if (compile == NULL || cacheFromSource == NULL || checkedHash == NULL) {
+        auto error = getError();
+        Py_XDECREF(compile);
+        Py_XDECREF(cacheFromSource);
+        Py_XDECREF(invalidationModes);
+        Py_DECREF(importUtil);
+        Py_DECREF(pyCompile);
+        PyGILState_Release(gstate);
+        throw std::runtime_error(error);
+    }
+
+    for (auto &file: files) {
+        if (!force) {
+            PyObject *cached = PyObject_CallFunction(cacheFromSource, "s", file.c_str());
+            if (cached == NULL) {
+                PyErr_Clear();
+                continue;
+            }
+            auto cachedPath = std::filesystem::u8path(PyUnicode_AsUTF8(cached));
+            Py_DECREF(cached);
+
+            std::error_code ec;
+            if (std::filesystem::exists(cachedPath, ec)) {
+                continue;
+            }
+
+            // The build compiles the system libraries into __pycache__, which is not read when a cache prefix is set.
+            // Checked hash bytecode stays valid when copied because it is validated against the source on import.
+            auto builtPath = std::filesystem::u8path(file).parent_path() / "__pycache__" / cachedPath.filename();
+            if (builtPath != cachedPath && std::filesystem::exists(builtPath, ec)) {
+                std::filesystem::create_directories(cachedPath.parent_path(), ec);
+                if (!ec && std::filesystem::copy_file(builtPath, cachedPath, ec)) {
+                    continue;
+                }
+            }
+        }
+
+        PyObject *args = Py_BuildValue("(s)", file.c_str());
+        PyObject *kwargs = Py_BuildValue("{s:O,s:i}", "invalidation_mode", checkedHash, "doraise", 0);
+        PyObject *result = PyObject_Call(compile, args, kwargs);
+        if (result == NULL) {
+            PyErr_Clear();
+        }
+        Py_XDECREF(result);
+        Py_DECREF(kwargs);
+        Py_DECREF(args);
+    }
+
+    Py_DECREF(checkedHash);
+    Py_DECREF(invalidationModes);
+    Py_DECREF(cacheFromSource);
+    Py_DECREF(compile);
+    Py_DECREF(importUtil);
+    Py_DECREF(pyCompile);
+
+    PyGILState_Release(gstate);
+}
+
 static std::function<void(const std::string &)> _outCallback;
 static std::function<void(const std::string &)> _errCallback;
 
@@ -361,6 +490,10 @@ std::string Interpreter::getVersion() {
     return ret;
 }
 
+std::string Interpreter::getLibraryVersion() {
+    return Py_GetVersion();
+}
+
 std::string Interpreter::getCopyright() {
     PyGILState_STATE gstate;
     gstate = PyGILState_Ensure();
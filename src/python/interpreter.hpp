@@ -36,6 +36,12 @@ namespace Interpreter {
         FUNC_TYPE_INPUT
     };
 
+    /**
+     * Set the directory in which the interpreter reads and writes bytecode instead of the __pycache__ directories,
+     * must be called before initialize().
+     */
+    void setCachePrefix(const std::string &directory);
+
     void initialize();
 
     void finalize();
@@ -64,14 +70,36 @@ namespace Interpreter {
 
     int runInteractiveLoop();
 
+    /**
+     * Run the python source in the context module.
+     * The compiled code object is cached so running the same source again does not parse and compile it again.
+     */
     void runString(const std::string &expression,
                    ParseStyle style = SINGLE_INPUT,
                    const std::string &context = "__main__");
 
     void callFunctionNoArgs(const std::string &module, const std::string &function);
 
+    /**
+     * Import the module without calling anything in it, subsequent imports of the module are served from sys.modules.
+     *
+     * @param module The fully qualified module name
+     */
+    void importModule(const std::string &module);
+
     void reloadModule(const std::string &module);
 
+    /**
+     * Compile the python source files to bytecode in the cache directory of the interpreter.
+     * The bytecode is validated against the hash of the source when imported instead of the modification time.
+     * Files which fail to compile are reported on stderr and skipped.
+     *
+     * @param files The paths of the python source files
+     * @param force If false files which already have bytecode in the cache directory are skipped,
+     * and bytecode which was compiled into the __pycache__ directory next to the source is copied instead of compiling the file.
+     */
+    void compileFiles(const std::vector<std::string> &files, bool force = true);
+
     void setStdStreams(std::function<void(const std::string &)> outCallback,
                        std::function<void(const std::string &)> errCallback);
 
@@ -81,6 +109,14 @@ namespace Interpreter {
 
     std::string getVersion();
 
+    /**
+     * Return the version string of the linked python library.
+     * Unlike getVersion this does not require the interpreter to be initialized.
+     *
+     * @return The version string as returned by Py_GetVersion
+     */
+    std::string getLibraryVersion();
+
     std::string getCopyright();
 
     std::string getCompiler();
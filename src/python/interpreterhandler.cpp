@@ -28,13 +28,18 @@
 #include <QMessageBox>
 #include <QPushButton>
 #include <QFile>
+#include <QFileInfo>
 
 #include <utility>
+#include <chrono>
+
+#include "json.hpp"
 
 
 #include "python/modules/stdredirmodule.hpp"
 #include "python/modules/exprtkmodule.hpp"
 #include "python/interpreter.hpp"
+#include "python/interpreterpool.hpp"
 
 #include "io/paths.hpp"
 
@@ -42,6 +47,7 @@
 #include "settings/settingconstants.hpp"
 
 #include "io/serializer.hpp"
+#include "io/fileoperations.hpp"
 
 static bool threadRunning = false;
 
@@ -62,6 +68,11 @@ static std::function<void()> tableChangeCallback;
 static std::function<void(const std::string &)> outCallback;
 static std::function<void(const std::string &)> errCallback;
 
+static long long initCheckTimeSaved = 0;
+
+static std::set<std::string> prefetchModules;
+static std::map<std::string, double> prefetchTimes;
+
 static std::wstring getUserPythonPath(Settings &settings) {
     std::string str;
 
@@ -89,6 +100,66 @@ static bool checkPythonInit(std::string &stdErr) {
     return !ret;
 }
 
+/**
+ * The fingerprint identifies the conditions under which a successful init check result stays valid.
+ * If the python path, the linked python library or the application binary change the check has to be rerun.
+ */
+static nlohmann::json getInitCheckFingerprint(Settings &settings) {
+    std::string pythonPath;
+    if (settings.check(SETTING_PYTHON_PATH.key)) {
+        pythonPath = settings.value(SETTING_PYTHON_PATH.key).toString();
+    }
+
+    QFileInfo binary(QApplication::applicationFilePath());
+
+    nlohmann::json ret;
+    ret["pythonPath"] = pythonPath;
+    ret["pythonVersion"] = Interpreter::getLibraryVersion();
+    ret["binaryModified"] = binary.lastModified().toMSecsSinceEpoch();
+    ret["binarySize"] = binary.size();
+    return ret;
+}
+
+/**
+ * Run the init check subprocess only if there is no cached successful result with a matching fingerprint.
+ * Failed checks are never cached so that fixing the python installation does not require clearing the cache.
+ */
+static bool checkPythonInitCached(Settings &settings, std::string &stdErr) {
+    auto fingerprint = getInitCheckFingerprint(settings);
+    auto cacheFile = Paths::getPythonInitCheckFile();
+
+    try {
+        FileOperations::MappedFile file(cacheFile);
+        auto cache = nlohmann::json::parse(file.data(), file.data() + file.size());
+        if (cache.value("fingerprint", nlohmann::json()) == fingerprint && cache.value("ok", false)) {
+            initCheckTimeSaved = cache.value("duration", 0LL);
+            return true;
+        }
+    } catch (const std::exception &e) {
+        // Missing or corrupt cache file, run the check.
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto ret = checkPythonInit(stdErr);
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    if (ret) {
+        nlohmann::json cache;
+        cache["fingerprint"] = fingerprint;
+        cache["ok"] = true;
+        cache["duration"] = static_cast<long long>(duration.count());
+        try {
+            FileOperations::fileWriteAll(cacheFile, nlohmann::to_string(cache));
+        } catch (const std::exception &e) {
+            // The cache is only an optimization, failing to write it is not an error.
+        }
+    } else {
+        QFile::remove(cacheFile.c_str());
+    }
+
+    return ret;
+}
+
 static void initializePython(const std::wstring &pythonPath) {
     if (!pythonPath.empty()) {
         Interpreter::setPath(pythonPath);
@@ -96,9 +167,37 @@ static void initializePython(const std::wstring &pythonPath) {
 
     StdRedirModule::initialize();
     ExprtkModule::initialize();
+    Interpreter::setCachePrefix(Paths::getPythonCacheDirectory());
     Interpreter::initialize();
     Interpreter::addModuleDir(Paths::getLibDirectory());
     Interpreter::addModuleDir(Paths::getAddonDirectory());
+
+    // Write checked hash bytecode for the sources which have none in the cache directory yet,
+    // before their first import writes timestamp based bytecode.
+    try {
+        Interpreter::compileFiles(FileOperations::findFilesInDirectory(Paths::getLibDirectory(), ".py", true), false);
+        Interpreter::compileFiles(FileOperations::findFilesInDirectory(Paths::getAddonDirectory(), ".py", true), false);
+    } catch (const std::exception &e) {
+        // The bytecode is only an optimization, the imports compile the sources instead.
+    }
+}
+
+/**
+ * Import the modules of eagerly loaded addons on the interpreter thread
+ * so that the work overlaps with the construction of the main window.
+ */
+static void prefetchImports() {
+    for (auto &module: prefetchModules) {
+        auto start = std::chrono::steady_clock::now();
+        try {
+            Interpreter::importModule(module);
+        } catch (const std::exception &e) {
+            // The error is reported when the addon is loaded.
+            continue;
+        }
+        prefetchTimes[module] = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+    }
 }
 
 static void threadLoop() {
@@ -109,7 +208,7 @@ static void threadLoop() {
 
     std::string stdErr;
 
-    auto pythonOk = checkPythonInit(stdErr);
+    auto pythonOk = checkPythonInitCached(settings, stdErr);
 
     if (pythonOk) {
         initializePython(pythonPath);
@@ -122,6 +221,12 @@ static void threadLoop() {
 
         ExprtkModule::setGlobalTable(*symbolTable, tableChangeCallback);
 
+        prefetchImports();
+
+        if (InterpreterPool::isSupported()) {
+            InterpreterPool::start(settings.value(SETTING_SCRIPT_WORKERS).toInt());
+        }
+
         Interpreter::saveThreadState();
     }
 
@@ -142,7 +247,8 @@ void InterpreterHandler::initialize(std::function<void()> onInitializedCallback,
                                     SymbolTable *globalTable,
                                     std::function<void()> tableChangeCallbackArg,
                                     std::function<void(const std::string &)> stdOutCallback,
-                                    std::function<void(const std::string &)> stdErrCallback) {
+                                    std::function<void(const std::string &)> stdErrCallback,
+                                    std::set<std::string> prefetchModulesArg) {
     if (threadRunning) {
         throw std::runtime_error("Interpreter already initializing.");
     }
@@ -157,6 +263,8 @@ void InterpreterHandler::initialize(std::function<void()> onInitializedCallback,
     outCallback = std::move(stdOutCallback);
     errCallback = std::move(stdErrCallback);
 
+    prefetchModules = std::move(prefetchModulesArg);
+
     thread = std::thread(threadLoop);
 }
 
@@ -167,6 +275,20 @@ void InterpreterHandler::finalize() {
     }
     quitThreadCondition.notify_all();
     thread.join();
+
+    InterpreterPool::stop();
+
+    if (Interpreter::isInitialized()) {
+        Interpreter::clearStdStreams();
+    }
+}
+
+long long InterpreterHandler::getInitCheckTimeSaved() {
+    return initCheckTimeSaved;
+}
+
+std::map<std::string, double> InterpreterHandler::getPrefetchTimes() {
+    return prefetchTimes;
 }
 
 bool InterpreterHandler::isInitialized() {
@@ -23,6 +23,7 @@
 #include <functional>
 #include <string>
 #include <set>
+#include <map>
 
 #include "calculator/symboltable.hpp"
 
@@ -34,12 +35,27 @@ namespace InterpreterHandler {
                     SymbolTable *globalTable,
                     std::function<void()> tableChangeCallback,
                     std::function<void(const std::string &)> stdOutCallback,
-                    std::function<void(const std::string &)> stdErrCallback);
+                    std::function<void(const std::string &)> stdErrCallback,
+                    std::set<std::string> prefetchModules = {});
 
     void finalize();
 
     bool isInitialized();
 
+    /**
+     * @return The duration in milliseconds of the init check subprocess that was skipped
+     * because a cached result was used, or 0 if the check was run.
+     */
+    long long getInitCheckTimeSaved();
+
+    /**
+     * The interpreter thread imports the prefetch modules passed to initialize before invoking the initialized callback.
+     * Modules which failed to import are not included.
+     *
+     * @return The import time in milliseconds of each prefetched module.
+     */
+    std::map<std::string, double> getPrefetchTimes();
+
     bool waitForInitialization(bool interruptable = true);
 }
 
@@ -0,0 +1,625 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "python/interpreterpool.hpp"
+
+#include <map>
+#include <algorithm>
+#include <set>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <future>
+#include <memory>
+#include <atomic>
+#include <stdexcept>
+#include <condition_variable>
+
+#include "python/pythoninclude.hpp"
+#include "python/interpreter.hpp"
+
+#include "calculator/scriptwatchdog.hpp"
+
+namespace {
+    /**
+     * The location of a callback which is used to look up the callback in the worker interpreters.
+     */
+    struct FunctionInfo {
+        bool replicable = false;
+        std::string module;
+        std::string qualifiedName;
+    };
+
+    struct JobResult {
+        enum Status {
+            OK,
+            UNAVAILABLE, // The callback could not be replicated into the worker interpreter
+            FAILED
+        } status = OK;
+        std::vector<std::string> values;
+        std::string error;
+    };
+
+    struct Job {
+        FunctionInfo function;
+        std::string name;
+        std::vector<std::vector<std::string>> arguments; // The arguments of each call in the batch
+        ScriptWatchdog::EvaluationState evaluation;
+        std::promise<JobResult> promise;
+    };
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::unique_ptr<Job>> jobs;
+    std::vector<std::thread> workers;
+    std::vector<std::string> modulePaths;
+    unsigned long generation = 0;
+    int liveWorkers = 0;
+    bool stopping = false;
+
+    std::atomic<bool> running{false};
+
+    std::mutex functionsMutex;
+    std::map<PyObject *, FunctionInfo> functions;
+
+    FunctionInfo getFunctionInfo(PyObject *callback) {
+        {
+            std::lock_guard<std::mutex> guard(functionsMutex);
+            auto it = functions.find(callback);
+            if (it != functions.end()) {
+                return it->second;
+            }
+        }
+
+        FunctionInfo info;
+
+        PyGILState_STATE gstate = PyGILState_Ensure();
+
+        // Bound methods and callable objects carry state which is not recreated by importing the module.
+        if (PyFunction_Check(callback)) {
+            PyObject *module = PyObject_GetAttrString(callback, "__module__");
+            PyObject *qualifiedName = PyObject_GetAttrString(callback, "__qualname__");
+            if (module != NULL && qualifiedName != NULL
+                && PyUnicode_Check(module) && PyUnicode_Check(qualifiedName)) {
+                info.module = PyUnicode_AsUTF8(module);
+                info.qualifiedName = PyUnicode_AsUTF8(qualifiedName);
+                // Lambdas and nested functions have a qualified name containing <lambda> or <locals>.
+                info.replicable = info.module != "__main__"
+                                  && info.qualifiedName.find('<') == std::string::npos;
+            }
+            Py_XDECREF(module);
+            Py_XDECREF(qualifiedName);
+            PyErr_Clear();
+        }
+
+        PyGILState_Release(gstate);
+
+        std::lock_guard<std::mutex> guard(functionsMutex);
+        functions[callback] = info;
+        return info;
+    }
+
+    void setUnavailable(PyObject *callback) {
+        std::lock_guard<std::mutex> guard(functionsMutex);
+        functions[callback].replicable = false;
+    }
+
+    std::vector<std::string> toStrings(const std::vector<decimal::Decimal> &values) {
+        std::vector<std::string> ret;
+        ret.reserve(values.size());
+        for (auto &value: values) {
+            ret.emplace_back(value.to_sci());
+        }
+        return ret;
+    }
+
+    /**
+     * Returns false if the pool is not running, the job is then not queued.
+     */
+    bool enqueue(std::unique_ptr<Job> job) {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (stopping || liveWorkers == 0) {
+                return false;
+            }
+            jobs.emplace_back(std::move(job));
+        }
+        condition.notify_one();
+        return true;
+    }
+
+#if PY_VERSION_HEX >= 0x030C0000
+    /**
+     * Format the current python error like Interpreter::getError without using the GIL state api,
+     * which only supports the main interpreter.
+     */
+    std::string fetchError() {
+        PyObject *type, *value, *traceback;
+        PyErr_Fetch(&type, &value, &traceback);
+
+        std::string ret;
+        for (auto *object: {traceback, type, value}) {
+            if (!ret.empty())
+                ret += "\n\t";
+            PyObject *str = object == NULL ? NULL : PyObject_Str(object);
+            if (str != NULL) {
+                const char *utf8 = PyUnicode_AsUTF8(str);
+                ret += utf8 == NULL ? "" : utf8;
+                Py_DECREF(str);
+            } else {
+                ret += object == traceback ? "NoTraceback" : (object == type ? "NoType" : "NoValue");
+            }
+            Py_XDECREF(object);
+        }
+        PyErr_Clear();
+        return ret;
+    }
+
+    /**
+     * The state of a worker interpreter, must only be used by the worker thread while holding the worker GIL.
+     */
+    class WorkerInterpreter {
+    public:
+        WorkerInterpreter(const std::vector<std::string> &paths, unsigned long generation)
+                : generation(generation) {
+            PyObject *sysPath = PySys_GetObject("path"); //Borrowed
+            if (sysPath != NULL && PyList_Check(sysPath)) {
+                PyList_SetSlice(sysPath, 0, PyList_GET_SIZE(sysPath), NULL);
+                for (auto &path: paths) {
+                    PyObject *str = PyUnicode_FromString(path.c_str());
+                    PyList_Append(sysPath, str);
+                    Py_DECREF(str);
+                }
+            }
+
+#if PY_VERSION_HEX < 0x030D0000
+            // The C implementation of the decimal module only supports isolated interpreters since Python 3.13.
+            // Before that its init function modifies process global state before the import is rejected,
+            // which corrupts the decimal state of the other interpreters. Blocking the import makes the decimal
+            // module fall back to the python implementation.
+            PyDict_SetItemString(PyImport_GetModuleDict(), "_decimal", Py_None);
+#endif
+
+            PyObject *module = PyImport_ImportModule("decimal");
+            if (module != NULL) {
+                decimalType = PyObject_GetAttrString(module, "Decimal");
+                Py_DECREF(module);
+            }
+            PyErr_Clear();
+        }
+
+        ~WorkerInterpreter() {
+            clearFunctions();
+            Py_XDECREF(decimalType);
+        }
+
+        JobResult execute(const Job &job, unsigned long currentGeneration) {
+            if (currentGeneration != generation) {
+                clearFunctions();
+                staleModules = importedModules;
+                generation = currentGeneration;
+            }
+
+            JobResult ret;
+
+            PyObject *callback = resolve(job.function);
+            if (callback == NULL || decimalType == NULL) {
+                ret.status = JobResult::UNAVAILABLE;
+                return ret;
+            }
+
+            try {
+                ScriptWatchdog::Call call(job.name, job.evaluation);
+
+                PyObject *args = createArguments(job);
+                if (args == NULL) {
+                    ret.status = JobResult::FAILED;
+                    ret.error = fetchError();
+                    return ret;
+                }
+
+                PyObject *pyRet = PyObject_CallOneArg(callback, args);
+                Py_DECREF(args);
+
+                if (call.timedOut()) {
+                    Py_XDECREF(pyRet);
+                    PyErr_Clear();
+                    ret.status = JobResult::FAILED;
+                    ret.error = call.getTimeoutMessage();
+                    return ret;
+                }
+
+                if (pyRet == NULL) {
+                    ret.status = JobResult::FAILED;
+                    ret.error = fetchError();
+                    return ret;
+                }
+
+                convertResult(job, pyRet, ret);
+                Py_DECREF(pyRet);
+            } catch (const std::exception &e) {
+                ret.status = JobResult::FAILED;
+                ret.error = e.what();
+            }
+
+            return ret;
+        }
+
+    private:
+        void clearFunctions() {
+            for (auto &pair: functions) {
+                Py_DECREF(pair.second);
+            }
+            functions.clear();
+        }
+
+        /**
+         * @return The borrowed callback or NULL if the module could not be imported in the worker.
+         */
+        PyObject *resolve(const FunctionInfo &function) {
+            auto key = function.module + ":" + function.qualifiedName;
+            auto it = functions.find(key);
+            if (it != functions.end()) {
+                return it->second;
+            }
+
+            PyObject *object = PyImport_ImportModule(function.module.c_str());
+            if (object != NULL && staleModules.erase(function.module) > 0) {
+                PyObject *reloaded = PyImport_ReloadModule(object);
+                Py_DECREF(object);
+                object = reloaded;
+            }
+
+            if (object == NULL) {
+                PyErr_Clear();
+                return NULL;
+            }
+
+            importedModules.insert(function.module);
+
+            size_t begin = 0;
+            while (object != NULL && begin <= function.qualifiedName.size()) {
+                auto end = function.qualifiedName.find('.', begin);
+                if (end == std::string::npos)
+                    end = function.qualifiedName.size();
+                PyObject *attribute = PyObject_GetAttrString(object,
+                                                             function.qualifiedName.substr(begin, end - begin).c_str());
+                Py_DECREF(object);
+                object = attribute;
+                begin = end + 1;
+            }
+
+            if (object == NULL || !PyCallable_Check(object)) {
+                Py_XDECREF(object);
+                PyErr_Clear();
+                return NULL;
+            }
+
+            functions[key] = object;
+            return object;
+        }
+
+        PyObject *createTuple(const std::vector<std::string> &values) {
+            PyObject *ret = PyTuple_New(static_cast<Py_ssize_t>(values.size()));
+            for (size_t i = 0; i < values.size(); i++) {
+                PyObject *value = PyObject_CallFunction(decimalType, "s", values.at(i).c_str());
+                if (value == NULL) {
+                    Py_DECREF(ret);
+                    return NULL;
+                }
+                PyTuple_SET_ITEM(ret, i, value);
+            }
+            return ret;
+        }
+
+        PyObject *createArguments(const Job &job) {
+            PyObject *batch = PyList_New(static_cast<Py_ssize_t>(job.arguments.size()));
+            for (size_t i = 0; i < job.arguments.size(); i++) {
+                PyObject *args = createTuple(job.arguments.at(i));
+                if (args == NULL) {
+                    Py_DECREF(batch);
+                    return NULL;
+                }
+                PyList_SET_ITEM(batch, i, args);
+            }
+            return batch;
+        }
+
+        bool convertValue(PyObject *value, JobResult &result) {
+            if (PyUnicode_Check(value)) {
+                result.values.emplace_back(PyUnicode_AsUTF8(value));
+                return true;
+            }
+
+            if (!PyLong_Check(value)
+                && !PyFloat_Check(value)
+                && !PyObject_TypeCheck(value, reinterpret_cast<PyTypeObject *>(decimalType))) {
+                result.status = JobResult::FAILED;
+                result.error = "Value must be decimal, string, float or long";
+                return false;
+            }
+
+            PyObject *str = PyObject_Str(value);
+            if (str == NULL) {
+                result.status = JobResult::FAILED;
+                result.error = fetchError();
+                return false;
+            }
+            result.values.emplace_back(PyUnicode_AsUTF8(str));
+            Py_DECREF(str);
+            return true;
+        }
+
+        void convertResult(const Job &job, PyObject *value, JobResult &result) {
+            PyObject *sequence = PySequence_Fast(value, "Batched script must return a sequence");
+            if (sequence == NULL) {
+                result.status = JobResult::FAILED;
+                result.error = fetchError();
+                return;
+            }
+
+            auto size = PySequence_Fast_GET_SIZE(sequence);
+            if (size != static_cast<Py_ssize_t>(job.arguments.size())) {
+                result.status = JobResult::FAILED;
+                result.error = "Batched script returned "
+                               + std::to_string(size)
+                               + " results for "
+                               + std::to_string(job.arguments.size())
+                               + " calls";
+            } else {
+                for (Py_ssize_t i = 0; i < size; i++) {
+                    if (!convertValue(PySequence_Fast_GET_ITEM(sequence, i), result)) //Borrowed
+                        break;
+                }
+            }
+
+            Py_DECREF(sequence);
+        }
+
+        unsigned long generation;
+        PyObject *decimalType = nullptr;
+        std::map<std::string, PyObject *> functions;
+        std::set<std::string> importedModules;
+        std::set<std::string> staleModules; // Imported before the last invalidation, reloaded on the next import
+    };
+
+    /**
+     * Fail the queued jobs if no worker is left to run them.
+     */
+    void workerExited() {
+        std::deque<std::unique_ptr<Job>> orphaned;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (--liveWorkers == 0) {
+                running = false;
+                orphaned.swap(jobs);
+            }
+        }
+        for (auto &job: orphaned) {
+            JobResult result;
+            result.status = JobResult::UNAVAILABLE;
+            job->promise.set_value(result);
+        }
+    }
+
+    void workerLoop() {
+        // The sub interpreter is created from a thread state of the main interpreter.
+        PyThreadState *mainState = PyThreadState_New(PyInterpreterState_Main());
+        PyEval_RestoreThread(mainState);
+
+        PyInterpreterConfig config{};
+        config.use_main_obmalloc = 0;
+        config.allow_fork = 0;
+        config.allow_exec = 0;
+        config.allow_threads = 1;
+        config.allow_daemon_threads = 0;
+        config.check_multi_interp_extensions = 1;
+        config.gil = PyInterpreterConfig_OWN_GIL;
+
+        PyThreadState *state = NULL;
+        PyStatus status = Py_NewInterpreterFromConfig(&state, &config);
+        if (PyStatus_Exception(status)) {
+            PyThreadState_Clear(mainState);
+            PyThreadState_DeleteCurrent();
+            workerExited();
+            return;
+        }
+
+        // The new interpreter is current and holds its own GIL, the GIL of the main interpreter was released.
+        std::unique_ptr<WorkerInterpreter> interpreter;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            auto paths = modulePaths;
+            auto currentGeneration = generation;
+            lock.unlock();
+            interpreter = std::make_unique<WorkerInterpreter>(paths, currentGeneration);
+        }
+
+        while (true) {
+            // The GIL is released while waiting so that the watchdog can always acquire it.
+            PyThreadState *saved = PyEval_SaveThread();
+
+            std::unique_ptr<Job> job;
+            unsigned long currentGeneration;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, []() { return stopping || !jobs.empty(); });
+                if (jobs.empty()) {
+                    break;
+                }
+                job = std::move(jobs.front());
+                jobs.pop_front();
+                currentGeneration = generation;
+            }
+
+            PyEval_RestoreThread(saved);
+
+            job->promise.set_value(interpreter->execute(*job, currentGeneration));
+        }
+
+        // The loop exits with the GIL of the worker released.
+        ScriptWatchdog::releaseInterpreter(PyThreadState_GetInterpreter(state));
+
+        PyEval_RestoreThread(state);
+        interpreter.reset();
+        Py_EndInterpreter(state);
+
+        PyEval_RestoreThread(mainState);
+        PyThreadState_Clear(mainState);
+        PyThreadState_DeleteCurrent();
+
+        workerExited();
+    }
+#endif
+}
+
+bool InterpreterPool::isSupported() {
+#if PY_VERSION_HEX >= 0x030C0000
+    return true;
+#else
+    return false;
+#endif
+}
+
+void InterpreterPool::start(int size) {
+#if PY_VERSION_HEX >= 0x030C0000
+    if (size <= 0 || !workers.empty()) {
+        return;
+    }
+
+    auto paths = Interpreter::getModuleDirs();
+
+    std::lock_guard<std::mutex> guard(mutex);
+    modulePaths = paths;
+    stopping = false;
+    liveWorkers = size;
+    running = true;
+    for (int i = 0; i < size; i++) {
+        workers.emplace_back(workerLoop);
+    }
+#endif
+}
+
+void InterpreterPool::stop() {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+
+    for (auto &worker: workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    std::lock_guard<std::mutex> guard(functionsMutex);
+    functions.clear();
+}
+
+bool InterpreterPool::isRunning() {
+    return running;
+}
+
+int InterpreterPool::getSize() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return liveWorkers;
+}
+
+void InterpreterPool::invalidate() {
+    {
+        std::lock_guard<std::mutex> guard(functionsMutex);
+        functions.clear();
+    }
+    std::lock_guard<std::mutex> guard(mutex);
+    generation++;
+}
+
+bool InterpreterPool::runBatch(PyObject *callback,
+                               const std::string &name,
+                               const std::vector<std::vector<decimal::Decimal>> &args,
+                               std::vector<decimal::Decimal> &results) {
+    if (!running || args.empty()) {
+        return false;
+    }
+
+    auto function = getFunctionInfo(callback);
+    if (!function.replicable) {
+        return false;
+    }
+
+    auto evaluation = ScriptWatchdog::getEvaluationState();
+
+    size_t chunks = std::min(args.size(), static_cast<size_t>(std::max(getSize(), 1)));
+    size_t chunkSize = (args.size() + chunks - 1) / chunks;
+
+    std::vector<std::future<JobResult>> futures;
+    for (size_t begin = 0; begin < args.size(); begin += chunkSize) {
+        auto job = std::make_unique<Job>();
+        job->function = function;
+        job->name = name;
+        job->evaluation = evaluation;
+        for (size_t i = begin; i < std::min(begin + chunkSize, args.size()); i++) {
+            job->arguments.emplace_back(toStrings(args.at(i)));
+        }
+
+        futures.emplace_back(job->promise.get_future());
+        if (!enqueue(std::move(job))) {
+            futures.pop_back();
+            break;
+        }
+    }
+
+    // Wait for all chunks before reporting errors so that no chunk of a failed call is still running afterwards.
+    std::vector<JobResult> jobResults;
+    for (auto &future: futures) {
+        jobResults.emplace_back(future.get());
+    }
+
+    if (futures.empty()) {
+        return false;
+    }
+
+    bool available = jobResults.size() * chunkSize >= args.size();
+    for (auto &jobResult: jobResults) {
+        if (jobResult.status == JobResult::UNAVAILABLE) {
+            setUnavailable(callback);
+            available = false;
+        }
+    }
+
+    if (!available) {
+        return false;
+    }
+
+    for (auto &jobResult: jobResults) {
+        if (jobResult.status == JobResult::FAILED) {
+            throw std::runtime_error(jobResult.error);
+        }
+    }
+
+    results.clear();
+    results.reserve(args.size());
+    for (auto &jobResult: jobResults) {
+        for (auto &value: jobResult.values) {
+            results.emplace_back(value);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,102 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_INTERPRETERPOOL_HPP
+#define QCALC_INTERPRETERPOOL_HPP
+
+#include <string>
+#include <vector>
+
+#include <decimal.hh>
+
+struct _object;
+typedef _object PyObject;
+
+/**
+ * An optional pool of python sub interpreters which each run with their own GIL (Python 3.12 and newer).
+ *
+ * Pure script functions are replicated into the workers by importing the module of the callback
+ * in the worker interpreter and looking up the qualified name of the callback.
+ * The argument sets of batched calls are distributed across the workers
+ * so that cpu bound scripts are not serialized by the GIL of the main interpreter.
+ *
+ * Callbacks which cannot be replicated (lambdas, nested functions, modules which fail to import in a
+ * sub interpreter, eg. because they depend on native modules without sub interpreter support) are reported as
+ * unavailable and have to be run in the main interpreter.
+ *
+ * Arguments and results are passed between the interpreters as strings,
+ * python objects are never shared between interpreters.
+ *
+ * With Python 3.12 the workers use the python implementation of the decimal module (_pydecimal)
+ * because the C implementation does not support isolated interpreters before Python 3.13.
+ *
+ * When built against Python older than 3.12 the pool is not available, isSupported returns false,
+ * start does nothing and runBatch always returns false so that all script calls run in the main interpreter.
+ */
+namespace InterpreterPool {
+    /**
+     * @return True if the python library supports sub interpreters with their own GIL.
+     */
+    bool isSupported();
+
+    /**
+     * Start the worker threads which each create a sub interpreter.
+     * The sys.path of the main interpreter is copied to the workers.
+     *
+     * Must be called with the GIL of the main interpreter held, the workers finish initializing after it is released.
+     *
+     * @param workers The number of worker interpreters
+     */
+    void start(int workers);
+
+    /**
+     * Stop the workers and end their interpreters, must be called without holding the GIL
+     * and before the main interpreter is finalized.
+     */
+    void stop();
+
+    bool isRunning();
+
+    int getSize();
+
+    /**
+     * Discard the replicated callbacks, modules which were imported by the workers are reloaded on the next call.
+     * Must be called when the scripts of the global symbol table change.
+     */
+    void invalidate();
+
+    /**
+     * Run a batched pure script callback, the argument sets are split into one batch per worker.
+     * Must be called without holding the GIL.
+     *
+     * Throws std::runtime_error if the callback raised an exception or exceeded its time budget.
+     *
+     * @param callback The python callable in the main interpreter
+     * @param name The name of the script
+     * @param args The argument values of each call
+     * @param results Set to the result values if the calls were run
+     * @return False if the callback cannot be run in the pool.
+     */
+    bool runBatch(PyObject *callback,
+                  const std::string &name,
+                  const std::vector<std::vector<decimal::Decimal>> &args,
+                  std::vector<decimal::Decimal> &results);
+}
+
+#endif //QCALC_INTERPRETERPOOL_HPP
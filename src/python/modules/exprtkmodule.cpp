@@ -20,11 +20,22 @@
 #include "exprtkmodule.hpp"
 
 #include <utility>
+#include <map>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <exception>
 
 #include "python/pythoninclude.hpp"
 #include "python/symboltableutil.hpp"
+#include "python/decimalutil.hpp"
+#include "python/interpreterpool.hpp"
 
 #include "calculator/expressionparser.hpp"
+#include "calculator/compiledexpression.hpp"
+#include "calculator/memocache.hpp"
+#include "calculator/runtimestatistics.hpp"
 
 #include "modulecommon.hpp"
 
@@ -33,6 +44,692 @@
 static SymbolTable *symbolTable = nullptr;
 static std::function<void()> symbolTableCallback;
 
+static std::mutex contextMutex;
+static std::unique_ptr<decimal::Context> evaluationContext;
+
+/**
+ * Invoke f with the GIL released and the evaluation context applied to the decimal context of the calling thread.
+ * Script callbacks invoked by f reacquire the GIL through the ScriptHandler.
+ * Exceptions thrown by f are rethrown after the GIL was reacquired.
+ */
+template<typename F>
+static void runWithoutGil(F f) {
+    std::exception_ptr error;
+    Py_BEGIN_ALLOW_THREADS
+        try {
+            {
+                std::lock_guard<std::mutex> guard(contextMutex);
+                if (evaluationContext) {
+                    decimal::context = *evaluationContext;
+                }
+            }
+            f();
+        } catch (...) {
+            error = std::current_exception();
+        }
+    Py_END_ALLOW_THREADS
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+/**
+ * A change of a single symbol which is applied to the global symbol table when the view is committed.
+ */
+struct PendingSymbol {
+    enum Type {
+        REMOVED,
+        VARIABLE,
+        CONSTANT,
+        FUNCTION,
+        SCRIPT
+    };
+
+    Type type = REMOVED;
+    decimal::Decimal value;
+    Function function;
+    Script script; // Holds a reference to the callback which is transferred to the global table on commit
+};
+
+/**
+ * The SymbolTable type of the _exprtk module is a live view of the global symbol table.
+ *
+ * Symbols are converted to python objects individually when they are accessed.
+ * Modifications are recorded per symbol name and only applied to the global table when commit() is called,
+ * until then they are only visible to the view which recorded them.
+ */
+typedef struct {
+    PyObject_HEAD
+    std::map<std::string, PendingSymbol> *pending;
+} SymbolTableViewObject;
+
+static PyTypeObject SymbolTableViewType = {
+        PyVarObject_HEAD_INIT(NULL, 0)
+};
+
+static SymbolTable &getGlobalTable() {
+    if (symbolTable == nullptr) {
+        throw std::runtime_error("Global symbol table not set");
+    }
+    return *symbolTable;
+}
+
+static void discardPending(SymbolTableViewObject *self) {
+    for (auto &pair: *self->pending) {
+        if (pair.second.type == PendingSymbol::SCRIPT) {
+            Py_XDECREF(pair.second.script.callback);
+        }
+    }
+    self->pending->clear();
+}
+
+static void setPending(SymbolTableViewObject *self, const std::string &name, PendingSymbol symbol) {
+    if (name.empty()) {
+        if (symbol.type == PendingSymbol::SCRIPT) {
+            Py_XDECREF(symbol.script.callback);
+        }
+        throw std::runtime_error("Symbol name cannot be empty.");
+    }
+    auto it = self->pending->find(name);
+    if (it != self->pending->end() && it->second.type == PendingSymbol::SCRIPT) {
+        Py_XDECREF(it->second.script.callback);
+    }
+    (*self->pending)[name] = std::move(symbol);
+}
+
+/**
+ * Apply the pending changes of the view to the global table.
+ */
+static void commitPending(SymbolTableViewObject *self) {
+    auto &table = getGlobalTable();
+
+    bool symbolsChanged = false;
+    bool scriptsChanged = false;
+
+    for (auto &pair: *self->pending) {
+        auto &name = pair.first;
+        auto &symbol = pair.second;
+
+        auto scriptIt = table.getScripts().find(name);
+        bool wasScript = scriptIt != table.getScripts().end();
+        PyObject *replacedCallback = wasScript ? scriptIt->second.callback : nullptr;
+        bool wasSymbol = table.getVariables().find(name) != table.getVariables().end()
+                         || table.getConstants().find(name) != table.getConstants().end()
+                         || table.getFunctions().find(name) != table.getFunctions().end();
+
+        switch (symbol.type) {
+            case PendingSymbol::REMOVED:
+                if (!wasScript && !wasSymbol)
+                    continue;
+                table.remove(name);
+                break;
+            case PendingSymbol::VARIABLE: {
+                auto it = table.getVariables().find(name);
+                if (it != table.getVariables().end() && it->second == symbol.value)
+                    continue;
+                table.setVariable(name, symbol.value);
+                break;
+            }
+            case PendingSymbol::CONSTANT: {
+                auto it = table.getConstants().find(name);
+                if (it != table.getConstants().end() && it->second == symbol.value)
+                    continue;
+                table.setConstant(name, symbol.value);
+                break;
+            }
+            case PendingSymbol::FUNCTION: {
+                auto it = table.getFunctions().find(name);
+                if (it != table.getFunctions().end() && it->second == symbol.function)
+                    continue;
+                table.setFunction(name, symbol.function);
+                break;
+            }
+            case PendingSymbol::SCRIPT:
+                table.setScript(name, symbol.script);
+                break;
+        }
+
+        // The global table owned a reference to the callback of the replaced or removed script.
+        Py_XDECREF(replacedCallback);
+
+        scriptsChanged = scriptsChanged || wasScript || symbol.type == PendingSymbol::SCRIPT;
+        symbolsChanged = symbolsChanged
+                         || wasSymbol
+                         || (symbol.type != PendingSymbol::REMOVED && symbol.type != PendingSymbol::SCRIPT);
+    }
+
+    // The references to the script callbacks are now owned by the global table.
+    self->pending->clear();
+
+    // Callback addresses may be reused by new script objects, therefore cached results are discarded.
+    if (scriptsChanged) {
+        MemoCache::clearAll();
+        InterpreterPool::invalidate();
+    }
+
+    if (symbolsChanged && symbolTableCallback) {
+        symbolTableCallback();
+    }
+}
+
+/**
+ * @return A copy of the global table with the pending changes of the view applied,
+ * the references to the script callbacks in the returned table are incremented.
+ */
+static SymbolTable materialize(SymbolTableViewObject *self) {
+    SymbolTable ret = getGlobalTable();
+    for (auto &pair: *self->pending) {
+        switch (pair.second.type) {
+            case PendingSymbol::REMOVED:
+                ret.remove(pair.first);
+                break;
+            case PendingSymbol::VARIABLE:
+                ret.setVariable(pair.first, pair.second.value);
+                break;
+            case PendingSymbol::CONSTANT:
+                ret.setConstant(pair.first, pair.second.value);
+                break;
+            case PendingSymbol::FUNCTION:
+                ret.setFunction(pair.first, pair.second.function);
+                break;
+            case PendingSymbol::SCRIPT:
+                ret.setScript(pair.first, pair.second.script);
+                break;
+        }
+    }
+    for (auto &script: ret.getScripts()) {
+        Py_INCREF(script.second.callback);
+    }
+    return ret;
+}
+
+/**
+ * Lookup a symbol in the pending changes of the view and then in the global table.
+ *
+ * @return The new python object or NULL with a KeyError set if no symbol of the given type exists.
+ */
+template<typename T, typename Convert>
+static PyObject *lookupSymbol(SymbolTableViewObject *self,
+                              PyObject *args,
+                              PendingSymbol::Type type,
+                              const std::map<std::string, T> &(SymbolTable::*getter)() const,
+                              T PendingSymbol::*member,
+                              Convert convert) {
+    const char *name;
+    if (!PyArg_ParseTuple(args, "s:", &name)) {
+        return NULL;
+    }
+
+    auto it = self->pending->find(name);
+    if (it != self->pending->end()) {
+        if (it->second.type == type) {
+            return convert(it->second.*member);
+        }
+    } else {
+        auto &symbols = (getGlobalTable().*getter)();
+        auto symbol = symbols.find(name);
+        if (symbol != symbols.end()) {
+            return convert(symbol->second);
+        }
+    }
+
+    PyErr_SetString(PyExc_KeyError, name);
+    return NULL;
+}
+
+/**
+ * @return A new list containing the names of the symbols of the given type in the view.
+ */
+template<typename T>
+static PyObject *listNames(SymbolTableViewObject *self,
+                           PendingSymbol::Type type,
+                           const std::map<std::string, T> &(SymbolTable::*getter)() const) {
+    PyObject *ret = PyList_New(0);
+    for (auto &pair: (getGlobalTable().*getter)()) {
+        if (self->pending->find(pair.first) != self->pending->end())
+            continue;
+        PyObject *name = PyUnicode_FromString(pair.first.c_str());
+        PyList_Append(ret, name);
+        Py_DECREF(name);
+    }
+    for (auto &pair: *self->pending) {
+        if (pair.second.type != type)
+            continue;
+        PyObject *name = PyUnicode_FromString(pair.first.c_str());
+        PyList_Append(ret, name);
+        Py_DECREF(name);
+    }
+    return ret;
+}
+
+static PyObject *SymbolTableView_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
+    auto *self = reinterpret_cast<SymbolTableViewObject *>(type->tp_alloc(type, 0));
+    if (self != NULL) {
+        self->pending = new std::map<std::string, PendingSymbol>();
+    }
+    return reinterpret_cast<PyObject *>(self);
+}
+
+static void SymbolTableView_dealloc(SymbolTableViewObject *self) {
+    if (self->pending != nullptr) {
+        discardPending(self);
+        delete self->pending;
+    }
+    Py_TYPE(self)->tp_free(reinterpret_cast<PyObject *>(self));
+}
+
+static PyObject *SymbolTableView_get_variable_names(SymbolTableViewObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+        return listNames(self, PendingSymbol::VARIABLE, &SymbolTable::getVariables);
+    MODULE_FUNC_CATCH
+}
+
+static PyObject *SymbolTableView_get_variable(SymbolTableViewObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+        return lookupSymbol(self, args, PendingSymbol::VARIABLE, &SymbolTable::getVariables, &PendingSymbol::value,
+                            DecimalUtil::New);
+    MODULE_FUNC_CATCH
+}
+
+static PyObject *SymbolTableView_set_variable(SymbolTableViewObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+        const char *name;
+        PyObject *value;
+        if (!PyArg_ParseTuple(args, "sO:", &name, &value)) {
+            return NULL;
+        }
+        PendingSymbol symbol;
+        symbol.type = PendingSymbol::VARIABLE;
+        symbol.value = DecimalUtil::Convert(value);
+        setPending(self, name, std::move(symbol));
+        Py_RETURN_NONE;
+    MODULE_FUNC_CATCH
+}
+
+static PyObject *SymbolTableView_get_constant_names(SymbolTableViewObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+        return listNames(self, PendingSymbol::CONSTANT, &SymbolTable::getConstants);
+    MODULE_FUNC_CATCH
+}
+
+static PyObject *SymbolTableView_get_constant(SymbolTableViewObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+        return lookupSymbol(self, args, PendingSymbol::CONSTANT, &SymbolTable::getConstants, &PendingSymbol::value,
+                            DecimalUtil::New);
+    MODULE_FUNC_CATCH
+}
+
+static PyObject *SymbolTableView_set_constant(SymbolTableViewObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+        const char *name;
+        PyObject *value;
+        if (!PyArg_ParseTuple(args, "sO:", &name, &value)) {
+            return NULL;
+        }
+        PendingSymbol symbol;
+        symbol.type = PendingSymbol::CONSTANT;
+        symbol.value = DecimalUtil::Convert(value);
+        setPending(self, name, std::move(symbol));
+        Py_RETURN_NONE;
+    MODULE_FUNC_CATCH
+}
+
+static PyObject *SymbolTableView_get_function_names(SymbolTableViewObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+        return listNames(self, PendingSymbol::FUNCTION, &SymbolTable::getFunctions);
+    MODULE_FUNC_CATCH
+}
+
+static PyObject *SymbolTableView_get_function(SymbolTableViewObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+        return lookupSymbol(self, args, PendingSymbol::FUNCTION, &SymbolTable::getFunctions, &PendingSymbol::function,
+                            SymbolTableUtil::NewFunction);
+    MODULE_FUNC_CATCH
+}
+
+static PyObject *SymbolTableView_set_function(SymbolTableViewObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+        const char *name;
+        PyObject *value;
+        if (!PyArg_ParseTuple(args, "sO:", &name, &value)) {
+            return NULL;
+        }
+        PendingSymbol symbol;
+        symbol.type = PendingSymbol::FUNCTION;
+        symbol.function = SymbolTableUtil::ConvertFunction(value);
+        setPending(self, name, std::move(symbol));
+        Py_RETURN_NONE;
+    MODULE_FUNC_CATCH
+}
+
+static PyObject *SymbolTableView_get_script_names(SymbolTableViewObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+        return listNames(self, PendingSymbol::SCRIPT, &SymbolTable::getScripts);
+    MODULE_FUNC_CATCH
+}
+
+static PyObject *SymbolTableView_get_script(SymbolTableViewObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+        return lookupSymbol(self, args, PendingSymbol::SCRIPT, &SymbolTable::getScripts, &PendingSymbol::script,
+                            SymbolTableUtil::NewScript);
+    MODULE_FUNC_CATCH
+}
+
+static PyObject *SymbolTableView_set_script(SymbolTableViewObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+        const char *name;
+        PyObject *value;
+        if (!PyArg_ParseTuple(args, "sO:", &name, &value)) {
+            return NULL;
+        }
+        PendingSymbol symbol;
+        symbol.type = PendingSymbol::SCRIPT;
+        symbol.script = SymbolTableUtil::ConvertScript(value);
+        setPending(self, name, std::move(symbol));
+        Py_RETURN_NONE;
+    MODULE_FUNC_CATCH
+}
+
+static PyObject *SymbolTableView_set_script_noargs(SymbolTableViewObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+        const char *name;
+        PyObject *callback;
+        if (!PyArg_ParseTuple(args, "sO:", &name, &callback)) {
+            return NULL;
+        }
+        PendingSymbol symbol;
+        symbol.type = PendingSymbol::SCRIPT;
+        Py_INCREF(callback);
+        symbol.script.callback = callback;
+        setPending(self, name, std::move(symbol));
+        Py_RETURN_NONE;
+    MODULE_FUNC_CATCH
+}
+
+static PyObject *SymbolTableView_remove(SymbolTableViewObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+        const char *name;
+        if (!PyArg_ParseTuple(args, "s:", &name)) {
+            return NULL;
+        }
+        setPending(self, name, PendingSymbol());
+        Py_RETURN_NONE;
+    MODULE_FUNC_CATCH
+}
+
+static PyObject *SymbolTableView_commit(SymbolTableViewObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+        commitPending(self);
+        Py_RETURN_NONE;
+    MODULE_FUNC_CATCH
+}
+
+static PyObject *SymbolTableView_rollback(SymbolTableViewObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+        discardPending(self);
+        Py_RETURN_NONE;
+    MODULE_FUNC_CATCH
+}
+
+static PyObject *SymbolTableView_enter(SymbolTableViewObject *self, PyObject *args) {
+    Py_INCREF(self);
+    return reinterpret_cast<PyObject *>(self);
+}
+
+static PyObject *SymbolTableView_exit(SymbolTableViewObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+        PyObject *type;
+        PyObject *value;
+        PyObject *traceback;
+        if (!PyArg_ParseTuple(args, "OOO:", &type, &value, &traceback)) {
+            return NULL;
+        }
+        if (type == Py_None) {
+            commitPending(self);
+        } else {
+            discardPending(self);
+        }
+        Py_RETURN_FALSE;
+    MODULE_FUNC_CATCH
+}
+
+static PyMethodDef SymbolTableViewMethods[] = {
+        {"get_variable_names", (PyCFunction) SymbolTableView_get_variable_names, METH_NOARGS,  "."},
+        {"get_variable",       (PyCFunction) SymbolTableView_get_variable,       METH_VARARGS, "."},
+        {"set_variable",       (PyCFunction) SymbolTableView_set_variable,       METH_VARARGS, "."},
+        {"get_constant_names", (PyCFunction) SymbolTableView_get_constant_names, METH_NOARGS,  "."},
+        {"get_constant",       (PyCFunction) SymbolTableView_get_constant,       METH_VARARGS, "."},
+        {"set_constant",       (PyCFunction) SymbolTableView_set_constant,       METH_VARARGS, "."},
+        {"get_function_names", (PyCFunction) SymbolTableView_get_function_names, METH_NOARGS,  "."},
+        {"get_function",       (PyCFunction) SymbolTableView_get_function,       METH_VARARGS, "."},
+        {"set_function",       (PyCFunction) SymbolTableView_set_function,       METH_VARARGS, "."},
+        {"get_script_names",   (PyCFunction) SymbolTableView_get_script_names,   METH_NOARGS,  "."},
+        {"get_script",         (PyCFunction) SymbolTableView_get_script,         METH_VARARGS, "."},
+        {"set_script",         (PyCFunction) SymbolTableView_set_script,         METH_VARARGS, "."},
+        {"set_script_noargs",  (PyCFunction) SymbolTableView_set_script_noargs,  METH_VARARGS, "."},
+        {"remove",             (PyCFunction) SymbolTableView_remove,             METH_VARARGS, "."},
+        {"commit",             (PyCFunction) SymbolTableView_commit,             METH_NOARGS,  "."},
+        {"rollback",           (PyCFunction) SymbolTableView_rollback,           METH_NOARGS,  "."},
+        {"__enter__",          (PyCFunction) SymbolTableView_enter,              METH_NOARGS,  "."},
+        {"__exit__",           (PyCFunction) SymbolTableView_exit,               METH_VARARGS, "."},
+        {NULL, NULL, 0, NULL}
+};
+
+/**
+ * Serializes the access to a compiled expression from multiple threads.
+ *
+ * Script functions called during an evaluation run on the evaluating thread. If one of them accesses the same
+ * expression again, a python error is raised instead of waiting for the lock which is held further up its own stack.
+ */
+class ExpressionLock {
+public:
+    /**
+     * Run f with the GIL released while holding the lock.
+     */
+    template<typename F>
+    void run(F f) {
+        if (owner.load() == std::this_thread::get_id())
+            throw std::runtime_error("The compiled expression cannot be accessed while it is being evaluated");
+        runWithoutGil([&]() {
+            std::lock_guard<std::mutex> guard(mutex);
+            owner = std::this_thread::get_id();
+            try {
+                f();
+            } catch (...) {
+                owner = std::thread::id();
+                throw;
+            }
+            owner = std::thread::id();
+        });
+    }
+
+private:
+    std::mutex mutex;
+    std::atomic<std::thread::id> owner{};
+};
+
+/**
+ * The CompiledExpression type of the _exprtk module is a handle to an expression which was compiled by compile().
+ *
+ * The variables of the symbol table can be read and assigned by name using the subscript operator
+ * and value() evaluates the expression using the current variable values.
+ */
+typedef struct {
+    PyObject_HEAD
+    CompiledExpression *expression;
+    SymbolTable *table; // Holds the references to the script callbacks used by the expression
+    ExpressionLock *lock;
+} CompiledExpressionObject;
+
+static PyTypeObject CompiledExpressionType = {
+        PyVarObject_HEAD_INIT(NULL, 0)
+};
+
+static void CompiledExpression_dealloc(CompiledExpressionObject *self) {
+    delete self->expression;
+    delete self->lock;
+    if (self->table != nullptr) {
+        try {
+            SymbolTableUtil::Cleanup(*self->table);
+        } catch (const std::exception &e) {}
+        delete self->table;
+    }
+    Py_TYPE(self)->tp_free(reinterpret_cast<PyObject *>(self));
+}
+
+static PyObject *CompiledExpression_value(CompiledExpressionObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+        decimal::Decimal value;
+        self->lock->run([&]() {
+            value = self->expression->value();
+        });
+        return DecimalUtil::New(value);
+    MODULE_FUNC_CATCH
+}
+
+static PyObject *CompiledExpression_variables(CompiledExpressionObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+        std::map<std::string, decimal::Decimal> variables;
+        self->lock->run([&]() {
+            variables = self->expression->getVariables();
+        });
+        PyObject *ret = PyDict_New();
+        for (auto &pair: variables) {
+            PyObject *value = DecimalUtil::New(pair.second);
+            PyDict_SetItemString(ret, pair.first.c_str(), value);
+            Py_DECREF(value);
+        }
+        return ret;
+    MODULE_FUNC_CATCH
+}
+
+static Py_ssize_t CompiledExpression_length(CompiledExpressionObject *self) {
+    try {
+        size_t size = 0;
+        self->lock->run([&]() {
+            size = self->expression->getVariables().size();
+        });
+        return static_cast<Py_ssize_t>(size);
+    } catch (const std::exception &e) {
+        PyErr_SetString(PyExc_RuntimeError, e.what());
+        return -1;
+    }
+}
+
+static PyObject *CompiledExpression_subscript(CompiledExpressionObject *self, PyObject *key) {
+    MODULE_FUNC_TRY
+        const char *name = PyUnicode_AsUTF8(key);
+        if (name == NULL) {
+            return NULL;
+        }
+        bool found = false;
+        decimal::Decimal value;
+        self->lock->run([&]() {
+            auto &variables = self->expression->getVariables();
+            auto it = variables.find(name);
+            if (it != variables.end()) {
+                found = true;
+                value = it->second;
+            }
+        });
+        if (!found) {
+            PyErr_SetObject(PyExc_KeyError, key);
+            return NULL;
+        }
+        return DecimalUtil::New(value);
+    MODULE_FUNC_CATCH
+}
+
+static int CompiledExpression_ass_subscript(CompiledExpressionObject *self, PyObject *key, PyObject *value) {
+    try {
+        if (value == NULL) {
+            PyErr_SetString(PyExc_TypeError, "Variables of a compiled expression cannot be deleted");
+            return -1;
+        }
+        const char *name = PyUnicode_AsUTF8(key);
+        if (name == NULL) {
+            return -1;
+        }
+        decimal::Decimal v = DecimalUtil::Convert(value);
+        bool found = false;
+        self->lock->run([&]() {
+            auto &variables = self->expression->getVariables();
+            if (variables.find(name) != variables.end()) {
+                found = true;
+                self->expression->setVariable(name, v);
+            }
+        });
+        if (!found) {
+            PyErr_SetObject(PyExc_KeyError, key);
+            return -1;
+        }
+        return 0;
+    } catch (const std::exception &e) {
+        PyErr_SetString(PyExc_RuntimeError, e.what());
+        return -1;
+    }
+}
+
+static PyMappingMethods CompiledExpressionMapping = {
+        (lenfunc) CompiledExpression_length,
+        (binaryfunc) CompiledExpression_subscript,
+        (objobjargproc) CompiledExpression_ass_subscript
+};
+
+static PyMethodDef CompiledExpressionMethods[] = {
+        {"value",     (PyCFunction) CompiledExpression_value,     METH_NOARGS, "."},
+        {"variables", (PyCFunction) CompiledExpression_variables, METH_NOARGS, "."},
+        {NULL, NULL, 0, NULL}
+};
+
+PyObject *compile(PyObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+
+        PyObject *pyExpression;
+        PyObject *pySymTable;
+
+        if (!PyArg_ParseTuple(args, "OO:", &pyExpression, &pySymTable)) {
+            return NULL;
+        }
+
+        const char *expression = PyUnicode_AsUTF8(pyExpression);
+        if (expression == NULL) {
+            return NULL;
+        }
+
+        auto table = std::make_unique<SymbolTable>();
+        if (PyObject_TypeCheck(pySymTable, &SymbolTableViewType)) {
+            *table = materialize(reinterpret_cast<SymbolTableViewObject *>(pySymTable));
+        } else {
+            *table = SymbolTableUtil::Convert(pySymTable);
+        }
+
+        std::unique_ptr<CompiledExpression> compiled;
+        try {
+            std::string expr(expression);
+            runWithoutGil([&]() {
+                compiled = std::make_unique<CompiledExpression>(expr, *table);
+            });
+        } catch (const std::exception &e) {
+            SymbolTableUtil::Cleanup(*table);
+            throw;
+        }
+
+        auto *ret = PyObject_New(CompiledExpressionObject, &CompiledExpressionType);
+        if (ret == NULL) {
+            SymbolTableUtil::Cleanup(*table);
+            return NULL;
+        }
+
+        ret->expression = compiled.release();
+        ret->table = table.release();
+        ret->lock = new ExpressionLock();
+
+        return reinterpret_cast<PyObject *>(ret);
+
+    MODULE_FUNC_CATCH
+}
+
 PyObject *evaluate(PyObject *self, PyObject *args) {
     MODULE_FUNC_TRY
 
@@ -48,13 +745,27 @@ PyObject *evaluate(PyObject *self, PyObject *args) {
             return NULL;
         }
 
-        SymbolTable symTable = SymbolTableUtil::Convert(pySymTable);
+        SymbolTable symTable;
+        if (PyObject_TypeCheck(pySymTable, &SymbolTableViewType)) {
+            symTable = materialize(reinterpret_cast<SymbolTableViewObject *>(pySymTable));
+        } else {
+            symTable = SymbolTableUtil::Convert(pySymTable);
+        }
 
-        decimal::Decimal value = ExpressionParser::evaluate(expression, symTable);
+        std::string expr(expression);
+        decimal::Decimal value;
+        try {
+            runWithoutGil([&]() {
+                value = ExpressionParser::evaluate(expr, symTable);
+            });
+        } catch (const std::exception &e) {
+            SymbolTableUtil::Cleanup(symTable);
+            throw;
+        }
 
         PyObject *ret = PyTuple_New(2);
 
-        PyTuple_SetItem(ret, 0, PyFloat_FromDouble(std::stod(value.format("f"))));
+        PyTuple_SetItem(ret, 0, DecimalUtil::New(value));
         PyTuple_SetItem(ret, 1, SymbolTableUtil::New(symTable));
 
         SymbolTableUtil::Cleanup(symTable);
@@ -70,7 +781,7 @@ PyObject *get_global_symtable(PyObject *self, PyObject *args) {
         if (symbolTable == nullptr)
             return nullptr;
         else
-            return SymbolTableUtil::New(*symbolTable);
+            return PyObject_CallNoArgs(reinterpret_cast<PyObject *>(&SymbolTableViewType));
 
     MODULE_FUNC_CATCH
 }
@@ -82,6 +793,11 @@ PyObject *set_global_symtable(PyObject *self, PyObject *args) {
         if (!PyArg_ParseTuple(args, "O:", &pysym)) {
             return NULL;
         }
+        if (PyObject_TypeCheck(pysym, &SymbolTableViewType)) {
+            commitPending(reinterpret_cast<SymbolTableViewObject *>(pysym));
+            return PyLong_FromLong(0);
+        }
+
         SymbolTable &t = *symbolTable;
         auto table = SymbolTableUtil::Convert(pysym);
 
@@ -90,6 +806,12 @@ PyObject *set_global_symtable(PyObject *self, PyObject *args) {
             symbolTableCallback();
         }
 
+        // Callback addresses may be reused by new script objects, therefore cached results are discarded.
+        if (table.getScripts() != t.getScripts()) {
+            MemoCache::clearAll();
+            InterpreterPool::invalidate();
+        }
+
         t = table;
 
         return PyLong_FromLong(0);
@@ -97,10 +819,82 @@ PyObject *set_global_symtable(PyObject *self, PyObject *args) {
     MODULE_FUNC_CATCH
 }
 
+PyObject *get_memo_statistics(PyObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+
+        PyObject *ret = PyDict_New();
+        for (auto &pair: MemoCache::getStatistics()) {
+            PyObject *stats = Py_BuildValue("(nnn)",
+                                            static_cast<Py_ssize_t>(pair.second.hits),
+                                            static_cast<Py_ssize_t>(pair.second.misses),
+                                            static_cast<Py_ssize_t>(pair.second.entries));
+            PyDict_SetItemString(ret, pair.first.c_str(), stats);
+            Py_DECREF(stats);
+        }
+        return ret;
+
+    MODULE_FUNC_CATCH
+}
+
+PyObject *clear_memo_cache(PyObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+
+        MemoCache::clearAll();
+        return PyLong_FromLong(0);
+
+    MODULE_FUNC_CATCH
+}
+
+PyObject *get_runtime_statistics(PyObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+
+        auto entries = RuntimeStatistics::getEntries();
+        PyObject *ret = PyList_New(static_cast<Py_ssize_t>(entries.size()));
+        for (size_t i = 0; i < entries.size(); i++) {
+            auto &entry = entries.at(i);
+            PyObject *stats = Py_BuildValue("{s:s,s:s,s:n,s:n,s:n,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d}",
+                                            "kind", RuntimeStatistics::getKindName(entry.kind).c_str(),
+                                            "name", entry.name.c_str(),
+                                            "calls", static_cast<Py_ssize_t>(entry.calls),
+                                            "failures", static_cast<Py_ssize_t>(entry.failures),
+                                            "timeouts", static_cast<Py_ssize_t>(entry.timeouts),
+                                            "total_ms", entry.totalTime,
+                                            "mean_ms", entry.meanTime(),
+                                            "max_ms", entry.maxTime,
+                                            "p50_ms", entry.p50,
+                                            "p90_ms", entry.p90,
+                                            "p99_ms", entry.p99,
+                                            "marshal_ms", entry.marshalTime,
+                                            "gil_wait_ms", entry.gilWaitTime);
+            if (stats == NULL) {
+                Py_DECREF(ret);
+                return NULL;
+            }
+            PyList_SET_ITEM(ret, static_cast<Py_ssize_t>(i), stats);
+        }
+        return ret;
+
+    MODULE_FUNC_CATCH
+}
+
+PyObject *reset_runtime_statistics(PyObject *self, PyObject *args) {
+    MODULE_FUNC_TRY
+
+        RuntimeStatistics::reset();
+        return PyLong_FromLong(0);
+
+    MODULE_FUNC_CATCH
+}
+
 static PyMethodDef MethodDef[] = {
         {"evaluate",            evaluate,            METH_VARARGS, "."},
+        {"compile",             compile,             METH_VARARGS, "."},
         {"get_global_symtable", get_global_symtable, METH_NOARGS,  "."},
         {"set_global_symtable", set_global_symtable, METH_VARARGS, "."},
+        {"get_memo_statistics", get_memo_statistics, METH_NOARGS,  "."},
+        {"clear_memo_cache",    clear_memo_cache,    METH_NOARGS,  "."},
+        {"get_runtime_statistics", get_runtime_statistics, METH_NOARGS, "."},
+        {"reset_runtime_statistics", reset_runtime_statistics, METH_NOARGS, "."},
         {NULL, NULL, 0, NULL}
 };
 
@@ -114,12 +908,50 @@ static PyModuleDef ModuleDef = {
 };
 
 static PyObject *PyInit() {
+    SymbolTableViewType.tp_name = MODULE_NAME ".SymbolTable";
+    SymbolTableViewType.tp_doc = "A live view of the global symbol table.";
+    SymbolTableViewType.tp_basicsize = sizeof(SymbolTableViewObject);
+    SymbolTableViewType.tp_itemsize = 0;
+    SymbolTableViewType.tp_flags = Py_TPFLAGS_DEFAULT;
+    SymbolTableViewType.tp_new = SymbolTableView_new;
+    SymbolTableViewType.tp_dealloc = (destructor) SymbolTableView_dealloc;
+    SymbolTableViewType.tp_methods = SymbolTableViewMethods;
+
+    if (PyType_Ready(&SymbolTableViewType) < 0)
+        return NULL;
+
+    CompiledExpressionType.tp_name = MODULE_NAME ".CompiledExpression";
+    CompiledExpressionType.tp_doc = "A compiled expression with bindable variables.";
+    CompiledExpressionType.tp_basicsize = sizeof(CompiledExpressionObject);
+    CompiledExpressionType.tp_itemsize = 0;
+    CompiledExpressionType.tp_flags = Py_TPFLAGS_DEFAULT;
+    CompiledExpressionType.tp_dealloc = (destructor) CompiledExpression_dealloc;
+    CompiledExpressionType.tp_as_mapping = &CompiledExpressionMapping;
+    CompiledExpressionType.tp_methods = CompiledExpressionMethods;
+
+    if (PyType_Ready(&CompiledExpressionType) < 0)
+        return NULL;
+
     PyObject *m;
 
     m = PyModule_Create(&ModuleDef);
     if (m == NULL)
         return NULL;
 
+    Py_INCREF(&SymbolTableViewType);
+    if (PyModule_AddObject(m, "SymbolTable", reinterpret_cast<PyObject *>(&SymbolTableViewType)) < 0) {
+        Py_DECREF(&SymbolTableViewType);
+        Py_DECREF(m);
+        return NULL;
+    }
+
+    Py_INCREF(&CompiledExpressionType);
+    if (PyModule_AddObject(m, "CompiledExpression", reinterpret_cast<PyObject *>(&CompiledExpressionType)) < 0) {
+        Py_DECREF(&CompiledExpressionType);
+        Py_DECREF(m);
+        return NULL;
+    }
+
     return m;
 }
 
@@ -127,6 +959,11 @@ void ExprtkModule::initialize() {
     PyImport_AppendInittab(MODULE_NAME, PyInit);
 }
 
+void ExprtkModule::setContext(const decimal::Context &context) {
+    std::lock_guard<std::mutex> guard(contextMutex);
+    evaluationContext = std::make_unique<decimal::Context>(context);
+}
+
 void ExprtkModule::setGlobalTable(SymbolTable &globalTable, std::function<void()> tableChangeCallback) {
     symbolTable = &globalTable;
     symbolTableCallback = std::move(tableChangeCallback);
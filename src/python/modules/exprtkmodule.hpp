@@ -22,6 +22,8 @@
 
 #include <functional>
 
+#include <decimal.hh>
+
 #include "calculator/symboltable.hpp"
 
 namespace ExprtkModule {
@@ -35,6 +37,12 @@ namespace ExprtkModule {
     void initialize();
 
     void setGlobalTable(SymbolTable &globalTable, std::function<void()> tableChangeCallback);
+
+    /**
+     * Set the decimal context which is applied to the evaluating thread when expressions are evaluated from python.
+     * Evaluations run with the GIL released, therefore python threads can evaluate expressions in parallel.
+     */
+    void setContext(const decimal::Context &context);
 }
 
 #endif //QCALC_EXPRTKMODULE_HPP
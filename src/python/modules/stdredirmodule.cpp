@@ -18,15 +18,157 @@
  */
 
 #include <stdexcept>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
 
 #include "python/modules/stdredirmodule.hpp"
 
 #include "python/pythoninclude.hpp"
 
+/**
+ * Single producer single consumer ring buffer of output records.
+ * Writers are serialized by the GIL so the python side is the only producer and the flush thread the only consumer.
+ *
+ * Each record consists of a one byte stream tag, a four byte length and the data.
+ */
+class OutputRing {
+public:
+    enum Stream : char {
+        STDOUT = 0,
+        STDERR = 1
+    };
+
+    explicit OutputRing(size_t capacity) : buffer(capacity) {}
+
+    /**
+     * Append a record, the data that does not fit into the buffer is dropped and accounted in droppedBytes.
+     * The data is utf-8 and truncated records end on a code point boundary.
+     */
+    void write(Stream stream, const char *data, size_t length) {
+        auto h = head.load(std::memory_order_relaxed);
+        auto t = tail.load(std::memory_order_acquire);
+        auto free = buffer.size() - (h - t);
+
+        if (free <= HEADER_SIZE) {
+            droppedBytes.fetch_add(length, std::memory_order_relaxed);
+            return;
+        }
+
+        auto count = std::min(length, free - HEADER_SIZE);
+        if (count < length) {
+            // Do not split a multi byte sequence, continuation bytes have the bit pattern 10xxxxxx
+            while (count > 0 && (static_cast<unsigned char>(data[count]) & 0xC0) == 0x80) {
+                count--;
+            }
+            if (count == 0) {
+                droppedBytes.fetch_add(length, std::memory_order_relaxed);
+                return;
+            }
+            droppedBytes.fetch_add(length - count, std::memory_order_relaxed);
+        }
+
+        auto size = static_cast<std::uint32_t>(count);
+        char header[HEADER_SIZE];
+        header[0] = stream;
+        std::memcpy(header + 1, &size, sizeof(size));
+
+        copyIn(h, header, HEADER_SIZE);
+        copyIn(h + HEADER_SIZE, data, count);
+
+        head.store(h + HEADER_SIZE + count, std::memory_order_release);
+    }
+
+    /**
+     * Remove all available records and pass runs of records with the same stream to the callback.
+     *
+     * @return True if any data was read
+     */
+    bool read(const std::function<void(Stream, const std::string &)> &callback) {
+        auto h = head.load(std::memory_order_acquire);
+        auto t = tail.load(std::memory_order_relaxed);
+        if (h == t)
+            return false;
+
+        std::string run;
+        Stream runStream = STDOUT;
+        while (t != h) {
+            char header[HEADER_SIZE];
+            copyOut(t, header, HEADER_SIZE);
+            std::uint32_t size;
+            std::memcpy(&size, header + 1, sizeof(size));
+            auto stream = static_cast<Stream>(header[0]);
+
+            if (!run.empty() && stream != runStream) {
+                callback(runStream, run);
+                run.clear();
+            }
+            runStream = stream;
+
+            auto offset = run.size();
+            run.resize(offset + size);
+            copyOut(t + HEADER_SIZE, run.data() + offset, size);
+
+            t += HEADER_SIZE + size;
+        }
+
+        // Release the space before invoking the callback so writers are not blocked by the consumer
+        tail.store(t, std::memory_order_release);
+
+        if (!run.empty())
+            callback(runStream, run);
+
+        return true;
+    }
+
+    size_t takeDroppedBytes() {
+        return droppedBytes.exchange(0, std::memory_order_relaxed);
+    }
+
+private:
+    static const size_t HEADER_SIZE = 1 + sizeof(std::uint32_t);
+
+    void copyIn(size_t position, const char *data, size_t length) {
+        auto offset = position % buffer.size();
+        auto first = std::min(length, buffer.size() - offset);
+        std::memcpy(buffer.data() + offset, data, first);
+        std::memcpy(buffer.data(), data + first, length - first);
+    }
+
+    void copyOut(size_t position, char *data, size_t length) const {
+        auto offset = position % buffer.size();
+        auto first = std::min(length, buffer.size() - offset);
+        std::memcpy(data, buffer.data() + offset, first);
+        std::memcpy(data + first, buffer.data(), length - first);
+    }
+
+    std::vector<char> buffer;
+    std::atomic<size_t> head{0};
+    std::atomic<size_t> tail{0};
+    std::atomic<size_t> droppedBytes{0};
+};
+
+static const size_t RING_CAPACITY = 1024 * 1024;
+
+// The output is forwarded to the callbacks at most once per frame
+static const std::chrono::milliseconds FLUSH_INTERVAL(33);
+
 static bool redirecting = false;
 static std::function<void(const std::string &)> stdOut;
 static std::function<void(const std::string &)> stdErr;
 
+static OutputRing ring(RING_CAPACITY);
+
+static std::thread flushThread;
+static std::mutex flushMutex;
+static std::condition_variable flushCondition;
+static bool quitFlushThread = false;
+
 static const char *MODULE_NAME = "_stdredir";
 
 PyObject *stdredir_stdout(PyObject *self, PyObject *args);
@@ -59,23 +201,50 @@ static PyObject *PyInit() {
 }
 
 PyObject *stdredir_stdout(PyObject *self, PyObject *args) {
-    char *string;
-    if (!PyArg_ParseTuple(args, "s", &string))
+    const char *string;
+    Py_ssize_t length;
+    if (!PyArg_ParseTuple(args, "s#", &string, &length))
         return 0;
-    if (stdOut)
-        stdOut(string);
+    ring.write(OutputRing::STDOUT, string, length);
     return Py_BuildValue("");
 }
 
 PyObject *stdredir_stderr(PyObject *self, PyObject *args) {
-    char *string;
-    if (!PyArg_ParseTuple(args, "s", &string))
+    const char *string;
+    Py_ssize_t length;
+    if (!PyArg_ParseTuple(args, "s#", &string, &length))
         return 0;
-    if (stdErr)
-        stdErr(string);
+    ring.write(OutputRing::STDERR, string, length);
     return Py_BuildValue("");
 }
 
+static void forwardOutput() {
+    ring.read([](OutputRing::Stream stream, const std::string &str) {
+        if (stream == OutputRing::STDERR) {
+            if (stdErr)
+                stdErr(str);
+        } else {
+            if (stdOut)
+                stdOut(str);
+        }
+    });
+
+    auto dropped = ring.takeDroppedBytes();
+    if (dropped > 0 && stdOut) {
+        stdOut("[" + std::to_string(dropped) + " bytes of output dropped]\n");
+    }
+}
+
+static void flushLoop() {
+    std::unique_lock lk(flushMutex);
+    while (!quitFlushThread) {
+        lk.unlock();
+        forwardOutput();
+        lk.lock();
+        flushCondition.wait_for(lk, FLUSH_INTERVAL, [] { return quitFlushThread; });
+    }
+}
+
 static bool initialized = false;
 
 void StdRedirModule::initialize() {
@@ -94,10 +263,18 @@ class StdOut:
     def write(self, s):
         _stdredir.stdout(s)
 
+    def flush(self):
+        # Output is forwarded at a fixed rate by the flush thread
+        pass
+
 class StdErr:
     def write(self, s):
         _stdredir.stderr(s)
 
+    def flush(self):
+        # Output is forwarded at a fixed rate by the flush thread
+        pass
+
 def redirect():
     sys.stdout = StdOut()
     sys.stderr = StdErr()
@@ -116,6 +293,9 @@ void StdRedirModule::startRedirect(std::function<void(const std::string &)> so,
     stdOut = so;
     stdErr = se;
 
+    quitFlushThread = false;
+    flushThread = std::thread(flushLoop);
+
     int r1 = PyRun_SimpleString((code).c_str());
 
     if (r1 < 0) {
@@ -129,9 +309,20 @@ void StdRedirModule::stopRedirect() {
 
     redirecting = false;
 
+    {
+        std::lock_guard lk(flushMutex);
+        quitFlushThread = true;
+    }
+    flushCondition.notify_all();
+    flushThread.join();
+
     stdOut = {};
     stdErr = {};
 
+    // Discard output which was written after the last flush
+    ring.read([](OutputRing::Stream, const std::string &) {});
+    ring.takeDroppedBytes();
+
     /*  int r1 = PyRun_SimpleString((code + "undo_redirect()").c_str());
       if (r1 < 0) {
           throw std::runtime_error("Err");
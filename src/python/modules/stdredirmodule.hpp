@@ -26,6 +26,10 @@
 /**
  * When this module is initialized it redirects the std out and std error of the python interpreter to
  * the specified function objects.
+ *
+ * Python writes are appended to a fixed size ring buffer and forwarded to the function objects
+ * by a flush thread at a fixed rate, consecutive writes to the same stream are coalesced into one call.
+ * Output which does not fit into the buffer is dropped and the number of dropped bytes is reported on std out.
  */
 namespace StdRedirModule {
     /**
@@ -41,6 +45,9 @@ namespace StdRedirModule {
     void startRedirect(std::function<void(const std::string &)> stdOut,
                        std::function<void(const std::string &)> stdErr);
 
+    /**
+     * Stop the flush thread, output which has not been forwarded yet is discarded.
+     */
     void stopRedirect();
 }
 
@@ -21,9 +21,102 @@
 
 #include "python/pythoninclude.hpp"
 #include "python/interpreter.hpp"
+#include "python/decimalutil.hpp"
 
 #include "interpreterhandler.hpp"
 
+static PyObject *getExprtkClass(const char *name) {
+    PyObject *symModule = PyImport_ImportModule("exprtk");
+    if (symModule == NULL) {
+        throw std::runtime_error("Failed to import exprtk module, Error: " + Interpreter::getError());
+    }
+
+    PyObject *ret = PyObject_GetAttrString(symModule, name);
+    Py_DECREF(symModule);
+
+    if (ret == NULL) {
+        throw std::runtime_error("Failed to get " + std::string(name) + " class object");
+    }
+
+    return ret;
+}
+
+static PyObject *newFunction(PyObject *funcClass, const Function &function) {
+    PyObject *funcInstance = PyObject_CallNoArgs(funcClass);
+    if (funcInstance == NULL) {
+        throw std::runtime_error(Interpreter::getError());
+    }
+
+    PyObject *argList = PyList_New(0);
+    for (auto &argName: function.argumentNames) {
+        PyObject *o = PyUnicode_FromString(argName.c_str());
+        PyList_Append(argList, o);
+        Py_DECREF(o);
+    }
+
+    PyObject *o = PyUnicode_FromString(function.expression.c_str());
+
+    PyObject_SetAttrString(funcInstance, "expression", o);
+    PyObject_SetAttrString(funcInstance, "arguments", argList);
+    PyObject_SetAttrString(funcInstance, "pure", function.pure ? Py_True : Py_False);
+
+    Py_DECREF(o);
+    Py_DECREF(argList);
+
+    return funcInstance;
+}
+
+static PyObject *newScript(PyObject *scriptClass, const Script &script) {
+    PyObject *scriptInstance = PyObject_CallNoArgs(scriptClass);
+    if (scriptInstance == NULL) {
+        throw std::runtime_error(Interpreter::getError());
+    }
+
+    // PyObject_SetAttrString increments the reference count of the callback for the attribute.
+    PyObject_SetAttrString(scriptInstance, "callback", script.callback);
+
+    PyObject *args = PyList_New(0);
+    for (auto &argument: script.arguments) {
+        auto *arg = PyUnicode_FromString(argument.c_str());
+        PyList_Append(args, arg);
+        Py_DECREF(arg);
+    }
+
+    PyObject_SetAttrString(scriptInstance, "arguments", args);
+    PyObject_SetAttrString(scriptInstance, "pure", script.pure ? Py_True : Py_False);
+    PyObject_SetAttrString(scriptInstance, "batch", script.batched ? Py_True : Py_False);
+
+    Py_DECREF(args);
+
+    return scriptInstance;
+}
+
+PyObject *SymbolTableUtil::NewFunction(const Function &function) {
+    PyObject *funcClass = getExprtkClass("Function");
+    PyObject *ret;
+    try {
+        ret = newFunction(funcClass, function);
+    } catch (const std::exception &e) {
+        Py_DECREF(funcClass);
+        throw;
+    }
+    Py_DECREF(funcClass);
+    return ret;
+}
+
+PyObject *SymbolTableUtil::NewScript(const Script &script) {
+    PyObject *scriptClass = getExprtkClass("ScriptFunction");
+    PyObject *ret;
+    try {
+        ret = newScript(scriptClass, script);
+    } catch (const std::exception &e) {
+        Py_DECREF(scriptClass);
+        throw;
+    }
+    Py_DECREF(scriptClass);
+    return ret;
+}
+
 PyObject *SymbolTableUtil::New(const SymbolTable &table) {
     if (!InterpreterHandler::waitForInitialization()) {
         throw std::runtime_error("Python is not initialized");
@@ -55,7 +148,7 @@ PyObject *SymbolTableUtil::New(const SymbolTable &table) {
 
     PyObject *vars = PyObject_GetAttrString(symInstance, "variables");
     for (auto &var: table.getVariables()) {
-        PyObject *o = PyUnicode_FromString(var.second.format("f").c_str());
+        PyObject *o = DecimalUtil::New(var.second);
         PyDict_SetItemString(vars, var.first.c_str(), o);
         Py_DECREF(o);
     }
@@ -63,7 +156,7 @@ PyObject *SymbolTableUtil::New(const SymbolTable &table) {
 
     vars = PyObject_GetAttrString(symInstance, "constants");
     for (auto &var: table.getConstants()) {
-        PyObject *o = PyUnicode_FromString(var.second.format("f").c_str());
+        PyObject *o = DecimalUtil::New(var.second);
         PyDict_SetItemString(vars, var.first.c_str(), o);
         Py_DECREF(o);
     }
@@ -71,49 +164,16 @@ PyObject *SymbolTableUtil::New(const SymbolTable &table) {
 
     vars = PyObject_GetAttrString(symInstance, "functions");
     for (auto &var: table.getFunctions()) {
-        PyObject *funcInstance = PyObject_CallNoArgs(funcClass);
-
-        PyObject *argList = PyList_New(0);
-        for (auto &argName: var.second.argumentNames) {
-            PyObject *o = PyUnicode_FromString(argName.c_str());
-            PyList_Append(argList, o);
-            Py_DECREF(o);
-        }
-
-        PyObject *o = PyUnicode_FromString(var.second.expression.c_str());
-
-        PyObject_SetAttrString(funcInstance, "expression", o);
-        PyObject_SetAttrString(funcInstance, "arguments", argList);
-
+        PyObject *funcInstance = newFunction(funcClass, var.second);
         PyDict_SetItemString(vars, var.first.c_str(), funcInstance);
-
-        Py_DECREF(o);
-        Py_DECREF(argList);
         Py_DECREF(funcInstance);
     }
     Py_DECREF(vars);
 
     vars = PyObject_GetAttrString(symInstance, "scripts");
     for (auto &var: table.getScripts()) {
-        PyObject *scriptInstance = PyObject_CallNoArgs(scriptClass);
-
-        // PyObject_SetAttrString increments reference on passed object, we dont decrement because the returned
-        // symbol table holds a new reference to the callback and therefore
-        // has to be cleaned up by calling SymbolTableUtil::Cleanup
-        PyObject_SetAttrString(scriptInstance, "callback", var.second.callback);
-
-        PyObject *args = PyList_New(0);
-        for (auto i = 0; i < var.second.arguments.size(); i++) {
-            auto *arg = PyUnicode_FromString(var.second.arguments.at(i).c_str());
-            PyList_Append(args, arg);
-            Py_DECREF(arg);
-        }
-
-        PyObject_SetAttrString(scriptInstance, "arguments", args);
-
+        PyObject *scriptInstance = newScript(scriptClass, var.second);
         PyDict_SetItemString(vars, var.first.c_str(), scriptInstance);
-
-        Py_DECREF(args);
         Py_DECREF(scriptInstance);
     }
     Py_DECREF(vars);
@@ -153,22 +213,20 @@ void setVariables(PyObject *o, SymbolTable &ret) {
         }
 
         decimal::Decimal v;
-        if (PyUnicode_Check(value)) {
-            v = decimal::Decimal(PyUnicode_AsUTF8(value));
-        } else if (PyFloat_Check(value)) {
-            v = decimal::Decimal(std::to_string(PyFloat_AsDouble(value)));
-        } else if (PyLong_Check(value)) {
-            v = decimal::Decimal(std::to_string(PyLong_AsDouble(value)));
-        } else {
+        try {
+            v = DecimalUtil::Convert(value);
+        } catch (const std::exception &e) {
+            Py_DECREF(keys);
             Py_DECREF(attr);
-            throw std::runtime_error("Variable value must be string, float or long");
+            throw std::runtime_error("Variable value must be decimal, string, float or long: " + std::string(e.what()));
         }
 
         try {
             ret.setVariable(k, v);
-        } catch (const std::exception &e) {
+        } catch (...) {
+            Py_DECREF(keys);
             Py_DECREF(attr);
-            throw e;
+            throw;
         }
     }
     Py_DECREF(keys);
@@ -205,29 +263,144 @@ void setConstants(PyObject *o, SymbolTable &ret) {
         }
 
         decimal::Decimal v;
-        if (PyUnicode_Check(value)) {
-            v = decimal::Decimal(PyUnicode_AsUTF8(value));
-        } else if (PyFloat_Check(value)) {
-            v = decimal::Decimal(std::to_string(PyFloat_AsDouble(value)));
-        } else if (PyLong_Check(value)) {
-            v = decimal::Decimal(std::to_string(PyLong_AsDouble(value)));
-        } else {
+        try {
+            v = DecimalUtil::Convert(value);
+        } catch (const std::exception &e) {
+            Py_DECREF(keys);
             Py_DECREF(attr);
-            throw std::runtime_error("Variable value must be float or long");
+            throw std::runtime_error("Constant value must be decimal, string, float or long: " + std::string(e.what()));
         }
 
         try {
             ret.setConstant(k, v);
-        }
-        catch (const std::exception &e) {
+        } catch (...) {
+            Py_DECREF(keys);
             Py_DECREF(attr);
-            throw e;
+            throw;
         }
     }
     Py_DECREF(keys);
     Py_DECREF(attr);
 }
 
+/**
+ * @return True if the object has an attribute with the given name which evaluates to true.
+ */
+bool getFlag(PyObject *value, const char *name) {
+    if (!PyObject_HasAttrString(value, name)) {
+        return false;
+    }
+    PyObject *flag = PyObject_GetAttrString(value, name);
+    int ret = PyObject_IsTrue(flag);
+    Py_DECREF(flag);
+    if (ret == -1) {
+        throw std::runtime_error(Interpreter::getError());
+    }
+    return ret == 1;
+}
+
+Function SymbolTableUtil::ConvertFunction(PyObject *value) {
+    Function f;
+    if (!PyObject_HasAttrString(value, "expression")) {
+        throw std::runtime_error("Function value must have expression attribute");
+    } else if (!PyObject_HasAttrString(value, "arguments")) {
+        throw std::runtime_error("Function value must have arguments attribute");
+    }
+
+    PyObject *funcAttr = PyObject_GetAttrString(value, "expression");
+    if (!PyUnicode_Check(funcAttr)) {
+        Py_DECREF(funcAttr);
+        throw std::runtime_error("Function expression must be unicode string");
+    }
+
+    const char *expr = PyUnicode_AsUTF8(funcAttr);
+    if (expr == NULL) {
+        //Should never happen, just in case we will steal the error indicator and throw.
+        Py_DECREF(funcAttr);
+        throw std::runtime_error(Interpreter::getError());
+    }
+
+    f.expression = expr;
+
+    Py_DECREF(funcAttr);
+
+    f.pure = getFlag(value, "pure");
+
+    funcAttr = PyObject_GetAttrString(value, "arguments");
+    if (!PyList_Check(funcAttr)) {
+        Py_DECREF(funcAttr);
+        throw std::runtime_error("Function arguments must be list");
+    }
+
+    size_t argSize = PyList_Size(funcAttr);
+    for (auto argi = 0; argi < argSize; argi++) {
+        PyObject *pyArgName = PyList_GetItem(funcAttr, argi);
+        if (!PyUnicode_Check(pyArgName)) {
+            Py_DECREF(funcAttr);
+            throw std::runtime_error("Function arguments values must be unicode strings");
+        }
+        const char *argumentName = PyUnicode_AsUTF8(pyArgName);
+        if (argumentName == NULL) {
+            //Should never happen, just in case we will steal the error indicator and throw.
+            Py_DECREF(funcAttr);
+            throw std::runtime_error(Interpreter::getError());
+        }
+
+        f.argumentNames.emplace_back(std::string(argumentName));
+    }
+
+    Py_DECREF(funcAttr);
+
+    return f;
+}
+
+Script SymbolTableUtil::ConvertScript(PyObject *value) {
+    if (!PyObject_HasAttrString(value, "callback")) {
+        throw std::runtime_error("Script value must have callback attribute");
+    }
+
+    if (!PyObject_HasAttrString(value, "arguments")) {
+        throw std::runtime_error("Script value must have arguments attribute");
+    }
+
+    PyObject *args = PyObject_GetAttrString(value, "arguments");
+    if (!PyList_Check(args)) {
+        Py_DECREF(args);
+        throw std::runtime_error("Script arguments must be list");
+    }
+
+    std::vector<std::string> arguments;
+    auto argsSize = PyList_Size(args);
+    for (auto argsI = 0; argsI < argsSize; argsI++) {
+        auto *arg = PyList_GetItem(args, argsI);
+        if (arg == nullptr
+            || !PyUnicode_Check(arg)) {
+            Py_DECREF(args);
+            throw std::runtime_error("Script argument at index " + std::to_string(argsI) + " must be string");
+        }
+        auto argString = PyUnicode_AsUTF8(arg);
+        if (argString == nullptr) {
+            Py_DECREF(args);
+            throw std::runtime_error("Argument string is nullptr");
+        }
+        arguments.emplace_back(std::string(argString));
+    }
+
+    Py_DECREF(args);
+
+    Script s;
+    s.arguments = arguments;
+    s.pure = getFlag(value, "pure");
+    s.batched = getFlag(value, "batch");
+
+    // We dont decrement as we want a new pyobject which points to the same callback.
+    // When destroying a SymbolTable object with callbacks we have to decrement the reference counts by calling
+    // Cleanup().
+    s.callback = PyObject_GetAttrString(value, "callback");
+
+    return s;
+}
+
 void setFunctions(PyObject *o, SymbolTable &ret) {
     if (!PyObject_HasAttrString(o, "functions")) {
         throw std::runtime_error("functions attribute must be present");
@@ -246,6 +419,7 @@ void setFunctions(PyObject *o, SymbolTable &ret) {
         PyObject *value = PyDict_GetItem(attr, key);
 
         if (!PyUnicode_Check(key)) {
+            Py_DECREF(keys);
             Py_DECREF(attr);
             throw std::runtime_error("Function key must be unicode string");
         }
@@ -253,78 +427,17 @@ void setFunctions(PyObject *o, SymbolTable &ret) {
         const char *k = PyUnicode_AsUTF8(key);
         if (k == NULL) {
             //Should never happen, just in case we will steal the error indicator and throw.
+            Py_DECREF(keys);
             Py_DECREF(attr);
             throw std::runtime_error(Interpreter::getError());
         }
 
-        Function f;
-        if (!PyObject_HasAttrString(value, "expression")) {
-            Py_DECREF(attr);
-            throw std::runtime_error("Function value must have expression attribute");
-        } else if (!PyObject_HasAttrString(value, "arguments")) {
-            Py_DECREF(attr);
-            throw std::runtime_error("Function value must have arguments attribute");
-        }
-
-        PyObject *funcAttr = PyObject_GetAttrString(value, "expression");
-        if (!PyUnicode_Check(funcAttr)) {
-            Py_DECREF(funcAttr);
-            Py_DECREF(attr);
-            throw std::runtime_error("Function expression must be unicode string");
-        }
-
-        const char *expr = PyUnicode_AsUTF8(funcAttr);
-        if (expr == NULL) {
-            //Should never happen, just in case we will steal the error indicator and throw.
-            Py_DECREF(funcAttr);
-            Py_DECREF(attr);
-            throw std::runtime_error(Interpreter::getError());
-        }
-
-        Py_DECREF(funcAttr);
-
-        f.expression = expr;
-
-        if (!PyObject_HasAttrString(value, "arguments")) {
-            Py_DECREF(attr);
-            throw std::runtime_error("Function must have arguments attribute");
-        }
-
-        funcAttr = PyObject_GetAttrString(value, "arguments");
-        if (PyList_Check(funcAttr)) {
-            size_t argSize = PyList_Size(funcAttr);
-            for (auto argi = 0; argi < argSize; argi++) {
-                PyObject *pyArgName = PyList_GetItem(funcAttr, argi);
-                if (!PyUnicode_Check(pyArgName)) {
-                    Py_DECREF(funcAttr);
-                    Py_DECREF(attr);
-                    throw std::runtime_error("Function arguments values must be unicode strings");
-                }
-                const char *argumentName = PyUnicode_AsUTF8(pyArgName);
-                if (argumentName == NULL) {
-                    //Should never happen, just in case we will steal the error indicator and throw.
-                    Py_DECREF(funcAttr);
-                    Py_DECREF(attr);
-                    throw std::runtime_error(Interpreter::getError());
-                }
-
-                f.argumentNames.emplace_back(std::string(argumentName));
-            }
-
-            Py_DECREF(funcAttr);
-
-            try {
-                ret.setFunction(k, f);
-            } catch (const std::exception &e) {
-                Py_DECREF(keys);
-                Py_DECREF(attr);
-                throw e;
-            }
-        } else {
-            Py_DECREF(funcAttr);
+        try {
+            ret.setFunction(k, SymbolTableUtil::ConvertFunction(value));
+        } catch (const std::exception &e) {
             Py_DECREF(keys);
             Py_DECREF(attr);
-            throw std::runtime_error("Function arguments must be list");
+            throw;
         }
     }
 
@@ -363,72 +476,19 @@ void setScripts(PyObject *o, SymbolTable &ret) {
             throw std::runtime_error(Interpreter::getError());
         }
 
-        Script s;
-        if (PyObject_HasAttrString(value, "callback")) {
-            // We dont decrement as we want a new pyobject which points to the same callback.
-            // When destroying a SymbolTable object with callbacks we have to decrement the reference counts by calling
-            // Cleanup().
-            s.callback = PyObject_GetAttrString(value, "callback");
-        } else {
-            Py_DECREF(keys);
-            Py_DECREF(attr);
-            throw std::runtime_error("Script value must have callback attribute");
-        }
-
-        if (!PyObject_HasAttrString(value, "arguments")) {
-            Py_DECREF(keys);
-            Py_DECREF(attr);
-            throw std::runtime_error("Script value must have arguments attribute");
-        }
-
-        PyObject *args = PyObject_GetAttrString(value, "arguments");
-        if (!PyList_Check(args)) {
-            Py_DECREF(args);
-            Py_DECREF(keys);
-            Py_DECREF(attr);
-            throw std::runtime_error("Script arguments must be list");
-        }
-
-        std::vector<std::string> arguments;
-        auto argsSize = PyList_Size(args);
-        for (auto argsI = 0; argsI < argsSize; argsI++) {
-            auto *arg = PyList_GetItem(args, argsI);
-            if (arg == nullptr
-                || !PyUnicode_Check(arg)) {
-                Py_DECREF(args);
-                Py_DECREF(keys);
-                Py_DECREF(attr);
-                throw std::runtime_error("Script argument at index " + std::to_string(argsI) + " must be string");
-            }
-            auto argString = PyUnicode_AsUTF8(arg);
-            if (argString == nullptr) {
-                Py_DECREF(args);
-                Py_DECREF(keys);
-                Py_DECREF(attr);
-                throw std::runtime_error("Argument string is nullptr");
-            }
-            arguments.emplace_back(std::string(argString));
-        }
-
-        s.arguments = arguments;
-
         try {
-            ret.setScript(k, s);
+            ret.setScript(k, SymbolTableUtil::ConvertScript(value));
         } catch (const std::exception &e) {
-            Py_DECREF(args);
             Py_DECREF(keys);
             Py_DECREF(attr);
-            throw e;
+            throw;
         }
-
-        Py_DECREF(args);
     }
 
     Py_DECREF(keys);
     Py_DECREF(attr);
 }
 
-
 SymbolTable SymbolTableUtil::Convert(PyObject *o) {
     SymbolTable ret;
 
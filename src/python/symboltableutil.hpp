@@ -30,6 +30,9 @@ typedef _object PyObject;
  * Instead of creating a new extension type which contains a symbol table instance
  * we will convert between some python object which has the required attributes and
  * our c++ symbol table.
+ *
+ * The global symbol table is exposed as a live view by the _exprtk.SymbolTable extension type,
+ * which uses the per symbol conversion functions.
  */
 namespace SymbolTableUtil {
     /**
@@ -52,7 +55,7 @@ namespace SymbolTableUtil {
      *
      * All keys have to be unicode strings.
      *
-     * The variable and constant values have to be float or long.
+     * The variable and constant values have to be decimal.Decimal, str, float or int.
      *
      * The function and script values can be any class instance as long as the corresponding
      * attributes are present.
@@ -64,6 +67,40 @@ namespace SymbolTableUtil {
      */
     SymbolTable Convert(PyObject *o);
 
+    /**
+     * Throws on error and does NOT touch python errors in any way.
+     *
+     * @param function
+     * @return A new exprtk.Function instance
+     */
+    PyObject *NewFunction(const Function &function);
+
+    /**
+     * Throws on error and does NOT touch python errors in any way.
+     *
+     * @param script
+     * @return A new exprtk.ScriptFunction instance
+     */
+    PyObject *NewScript(const Script &script);
+
+    /**
+     * Throws on error and does NOT touch python errors in any way.
+     *
+     * @param o Any object with expression, arguments and optionally pure attributes
+     * @return The converted function
+     */
+    Function ConvertFunction(PyObject *o);
+
+    /**
+     * Throws on error and does NOT touch python errors in any way.
+     *
+     * The reference to the script callback is incremented.
+     *
+     * @param o Any object with callback, arguments and optionally pure and batch attributes
+     * @return The converted script
+     */
+    Script ConvertScript(PyObject *o);
+
     /**
      * Decrements all script callback object reference counts in the passed tables script definitions,
      * and returns the new table with the scripts cleared.
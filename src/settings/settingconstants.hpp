@@ -31,5 +31,9 @@ const Setting SETTING_PYTHON_PATH = {"python_path", std::string()};
 const Setting SETTING_SAVE_HISTORY = {"save_history", true};
 const Setting SETTING_CLEAR_RESULT = {"clear_result", true};
 const Setting SETTING_LOAD_RECENT_SYMBOLS = {"load_recent_symbols", false};
+const Setting SETTING_CONSOLE_SCROLLBACK = {"console_scrollback", 10000};
+const Setting SETTING_SCRIPT_CALL_BUDGET = {"script_call_budget", 10000};
+const Setting SETTING_EVALUATION_BUDGET = {"evaluation_budget", 30000};
+const Setting SETTING_SCRIPT_WORKERS = {"script_workers", 0};
 
 #endif //QCALC_SETTINGCONSTANTS_HPP
@@ -28,7 +28,8 @@
 Settings Settings::readSettings() {
     auto path = Paths::getSettingsFile();
     if (QFile(path.c_str()).exists()) {
-        return Serializer::deserializeSettings(FileOperations::fileReadAll(path));
+        FileOperations::MappedFile file(path);
+        return Serializer::deserializeSettings(file.view());
     } else {
         return {};
     }
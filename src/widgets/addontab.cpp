@@ -71,9 +71,15 @@ void AddonTab::setAddons(const std::map<std::string, Addon> &add) {
 
         auto *itemWidget = new AddonItemWidget(listWidget);
         itemWidget->setModuleName(addon.first.c_str());
-        itemWidget->setModuleEnabled(addon.second.isLoaded());
+        itemWidget->setModuleEnabled(addon.second.isLoaded() || addon.second.isActivationPending());
         itemWidget->setModuleDisplayName(displayName.c_str());
-        itemWidget->setModuleDescription((addon.second.getDescription() + " ( " + addon.first + " )").c_str());
+
+        auto description = addon.second.getDescription() + " ( " + addon.first + " )";
+        auto loadTime = AddonWidget::getLoadTimeText(addon.second);
+        if (!loadTime.empty()) {
+            description += "\n" + loadTime;
+        }
+        itemWidget->setModuleDescription(description.c_str());
 
         auto *item = new QListWidgetItem();
         item->setSizeHint(itemWidget->minimumSizeHint());
@@ -122,6 +128,8 @@ AddonTab::AddonTab(QWidget *parent)
 
     addonWidget = new AddonWidget(this);
 
+    statisticsWidget = new RuntimeStatisticsWidget(this);
+
     auto *vLayout = new QVBoxLayout;
     vLayout->addWidget(addonWidget);
     vLayout->addWidget(uninstallButton);
@@ -136,7 +144,8 @@ AddonTab::AddonTab(QWidget *parent)
 
     auto *layout = new QVBoxLayout();
     layout->addLayout(addonHeaderLayout);
-    layout->addLayout(hLayout);
+    layout->addLayout(hLayout, 3);
+    layout->addWidget(statisticsWidget, 2);
     layout->addLayout(btnsLayout);
 
     setLayout(layout);
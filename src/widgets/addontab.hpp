@@ -29,6 +29,7 @@
 
 #include "widgets/addonitemwidget.hpp"
 #include "widgets/addonwidget.hpp"
+#include "widgets/runtimestatisticswidget.hpp"
 
 #include "addon/addon.hpp"
 
@@ -73,6 +74,7 @@ private:
     QListWidget *listWidget;
     QLineEdit *addonSearchEdit;
     AddonWidget *addonWidget;
+    RuntimeStatisticsWidget *statisticsWidget;
 };
 
 #endif //QCALC_ADDONTAB_HPP
@@ -25,6 +25,8 @@
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 
+#include <cstdio>
+
 #include "addon/addon.hpp"
 
 class AddonWidget : public QWidget {
@@ -39,9 +41,13 @@ public:
 
         addonTitleLabel->setWordWrap(true);
 
+        addonLoadTimeLabel = new QLabel(this);
+        addonLoadTimeLabel->setWordWrap(true);
+
         auto *vLayout = new QVBoxLayout();
         vLayout->addWidget(addonTitleLabel);
         vLayout->addWidget(addonDescriptionLabel);
+        vLayout->addWidget(addonLoadTimeLabel);
         vLayout->addStretch(1);
 
         setLayout(vLayout);
@@ -50,11 +56,37 @@ public:
     void setAddon(const Addon &addon) {
         addonTitleLabel->setText(addon.getDisplayName().c_str());
         addonDescriptionLabel->setText(addon.getDescription().c_str());
+        addonLoadTimeLabel->setText(getLoadTimeText(addon).c_str());
+    }
+
+    /**
+     * @return The measured import and load() time of the addon or the activation state of lazy addons.
+     */
+    static std::string getLoadTimeText(const Addon &addon) {
+        if (addon.isActivationPending()) {
+            return "Waiting for activation";
+        } else if (addon.isLoaded() && addon.getLoadTime() >= 0) {
+            std::string ret;
+            if (addon.getImportTime() >= 0) {
+                ret += "Import: " + formatMilliseconds(addon.getImportTime()) + " ";
+            }
+            ret += "Load: " + formatMilliseconds(addon.getLoadTime());
+            return ret;
+        } else {
+            return "";
+        }
     }
 
 private:
+    static std::string formatMilliseconds(double ms) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.1f ms", ms);
+        return buf;
+    }
+
     QLabel *addonTitleLabel;
     QLabel *addonDescriptionLabel;
+    QLabel *addonLoadTimeLabel;
 };
 
 #endif //QCALCULATOR_ADDONWIDGET_HPP
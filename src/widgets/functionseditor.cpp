@@ -44,6 +44,8 @@ FunctionsEditor::FunctionsEditor(QWidget *parent) : QWidget(parent) {
     argEdit3 = new QLineEdit(this);
     argEdit4 = new QLineEdit(this);
 
+    pureCheckBox = new QCheckBox(this);
+
     expressionEdit = new QTextEdit(this);
 
     list->horizontalHeader()->hide();
@@ -60,6 +62,7 @@ FunctionsEditor::FunctionsEditor(QWidget *parent) : QWidget(parent) {
     auto *widgetArgs = new QWidget(this);
     widgetArgs->setLayout(new QHBoxLayout());
     widgetArgs->layout()->addWidget(argsSpinBox);
+    widgetArgs->layout()->addWidget(pureCheckBox);
     widgetArgs->layout()->addItem(new QSpacerItem(0, 0, QSizePolicy::Policy::Expanding));
     widgetArgs->layout()->addWidget(argEdit0);
     widgetArgs->layout()->addWidget(argEdit1);
@@ -89,6 +92,9 @@ FunctionsEditor::FunctionsEditor(QWidget *parent) : QWidget(parent) {
 
     argsSpinBox->setMaximum(5);
 
+    pureCheckBox->setText("Pure");
+    pureCheckBox->setToolTip("Cache the results of the function for previously used arguments.");
+
     connect(addPushButton, SIGNAL(clicked()), this, SLOT(onFunctionAddPressed()));
     connect(addLineEdit, SIGNAL(returnPressed()), this, SLOT(onFunctionAddPressed()));
 
@@ -100,6 +106,7 @@ FunctionsEditor::FunctionsEditor(QWidget *parent) : QWidget(parent) {
 
     connect(argsSpinBox, SIGNAL(valueChanged(int)), this, SLOT(onFunctionArgsSpinBoxChanged(int)));
     connect(expressionEdit, SIGNAL(textChanged()), this, SLOT(onFunctionExpressionChanged()));
+    connect(pureCheckBox, SIGNAL(stateChanged(int)), this, SLOT(onFunctionPureCheckBoxChanged(int)));
 
     connect(list, SIGNAL(cellClicked(int, int)), this, SLOT(onTableCellActivated(int, int)));
     connect(list, SIGNAL(cellChanged(int, int)), this, SLOT(onTableCellChanged(int, int)));
@@ -111,6 +118,7 @@ void FunctionsEditor::setFunctions(const std::map<std::string, Function> &f) {
 
     disconnect(argsSpinBox, SIGNAL(valueChanged(int)), this, SLOT(onFunctionArgsSpinBoxChanged(int)));
     disconnect(expressionEdit, SIGNAL(textChanged()), this, SLOT(onFunctionExpressionChanged()));
+    disconnect(pureCheckBox, SIGNAL(stateChanged(int)), this, SLOT(onFunctionPureCheckBoxChanged(int)));
 
     disconnect(argEdit0, SIGNAL(editingFinished()), this, SLOT(onFunctionArgEditingFinished()));
     disconnect(argEdit1, SIGNAL(editingFinished()), this, SLOT(onFunctionArgEditingFinished()));
@@ -127,6 +135,9 @@ void FunctionsEditor::setFunctions(const std::map<std::string, Function> &f) {
     argsSpinBox->setEnabled(false);
     argsSpinBox->setValue(0);
 
+    pureCheckBox->setEnabled(false);
+    pureCheckBox->setChecked(false);
+
     rowMapping.clear();
     list->clear();
     list->setColumnCount(1);
@@ -143,6 +154,7 @@ void FunctionsEditor::setFunctions(const std::map<std::string, Function> &f) {
 
     connect(expressionEdit, SIGNAL(textChanged()), this, SLOT(onFunctionExpressionChanged()));
     connect(argsSpinBox, SIGNAL(valueChanged(int)), this, SLOT(onFunctionArgsSpinBoxChanged(int)));
+    connect(pureCheckBox, SIGNAL(stateChanged(int)), this, SLOT(onFunctionPureCheckBoxChanged(int)));
 
     connect(argEdit0, SIGNAL(editingFinished()), this, SLOT(onFunctionArgEditingFinished()));
     connect(argEdit1, SIGNAL(editingFinished()), this, SLOT(onFunctionArgEditingFinished()));
@@ -215,6 +227,11 @@ void FunctionsEditor::onTableCellActivated(int row, int column) {
     argsSpinBox->setValue(func.argumentNames.size());
     connect(argsSpinBox, SIGNAL(valueChanged(int)), this, SLOT(onFunctionArgsSpinBoxChanged(int)));
 
+    disconnect(pureCheckBox, SIGNAL(stateChanged(int)), this, SLOT(onFunctionPureCheckBoxChanged(int)));
+    pureCheckBox->setEnabled(true);
+    pureCheckBox->setChecked(func.pure);
+    connect(pureCheckBox, SIGNAL(stateChanged(int)), this, SLOT(onFunctionPureCheckBoxChanged(int)));
+
     applyArgs(func.argumentNames);
 
     emit onCurrentFunctionChanged(currentFunction.c_str());
@@ -247,6 +264,12 @@ void FunctionsEditor::onFunctionExpressionChanged() {
     }
 }
 
+void FunctionsEditor::onFunctionPureCheckBoxChanged(int state) {
+    if (!currentFunction.empty()) {
+        emit onFunctionPureChanged(currentFunction.c_str(), state == Qt::Checked);
+    }
+}
+
 void FunctionsEditor::applyArgs(const std::vector<std::string> &args) {
     switch (args.size()) {
         case 0:
@@ -26,6 +26,7 @@
 #include <QLineEdit>
 #include <QPushButton>
 #include <QTextEdit>
+#include <QCheckBox>
 
 #include "calculator/function.hpp"
 
@@ -50,6 +51,8 @@ signals:
 
     void onFunctionArgsChanged(const QString &name, const std::vector<std::string> &args);
 
+    void onFunctionPureChanged(const QString &name, bool pure);
+
     void onCurrentFunctionChanged(const QString &name);
 
 private slots:
@@ -66,6 +69,8 @@ private slots:
 
     void onFunctionExpressionChanged();
 
+    void onFunctionPureCheckBoxChanged(int state);
+
 private:
     void applyArgs(const std::vector<std::string> &args);
 
@@ -87,6 +92,8 @@ private:
     QLineEdit *argEdit3;
     QLineEdit *argEdit4;
 
+    QCheckBox *pureCheckBox;
+
     QTextEdit *expressionEdit;
 };
 
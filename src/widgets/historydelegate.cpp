@@ -0,0 +1,99 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "widgets/historydelegate.hpp"
+
+#include <QPainter>
+#include <QApplication>
+
+#include <algorithm>
+
+#include "widgets/historymodel.hpp"
+
+static const int ROW_MARGIN = 8;
+static const int ROW_SPACING = 12;
+
+static void getRects(const QRect &rect,
+                     const QFontMetrics &fm,
+                     QRect &expression,
+                     QRect &equals,
+                     QRect &result) {
+    auto content = rect.adjusted(ROW_MARGIN, 0, -ROW_MARGIN, 0);
+    auto equalsWidth = fm.horizontalAdvance('=') + 2 * ROW_MARGIN;
+    auto sideWidth = std::max(0, (content.width() - equalsWidth) / 2);
+    expression = QRect(content.left(), content.top(), sideWidth, content.height());
+    equals = QRect(expression.right() + 1, content.top(), equalsWidth, content.height());
+    result = QRect(equals.right() + 1, content.top(), std::max(0, content.right() - equals.right()), content.height());
+}
+
+HistoryDelegate::HistoryDelegate(QObject *parent) : QStyledItemDelegate(parent) {}
+
+void HistoryDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const {
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+    opt.text.clear();
+
+    auto *style = opt.widget ? opt.widget->style() : QApplication::style();
+    style->drawPrimitive(QStyle::PE_PanelItemViewItem, &opt, painter, opt.widget);
+
+    if (!(opt.state & QStyle::State_Selected) && index.data(HistoryModel::HighlightRole).toBool()) {
+        auto color = opt.palette.color(QPalette::Highlight);
+        color.setAlpha(64);
+        painter->fillRect(opt.rect, color);
+    }
+
+    auto expression = index.data(HistoryModel::ExpressionRole).toString();
+    auto result = index.data(HistoryModel::ResultRole).toString();
+
+    QRect expressionRect, equalsRect, resultRect;
+    getRects(opt.rect, opt.fontMetrics, expressionRect, equalsRect, resultRect);
+
+    painter->save();
+    painter->setFont(opt.font);
+    painter->setPen(opt.palette.color(opt.state & QStyle::State_Selected
+                                      ? QPalette::HighlightedText
+                                      : QPalette::Text));
+    painter->drawText(expressionRect,
+                      Qt::AlignLeft | Qt::AlignVCenter,
+                      opt.fontMetrics.elidedText(expression, Qt::ElideRight, expressionRect.width()));
+    painter->drawText(equalsRect, Qt::AlignHCenter | Qt::AlignVCenter, "=");
+    painter->drawText(resultRect,
+                      Qt::AlignRight | Qt::AlignVCenter,
+                      opt.fontMetrics.elidedText(result, Qt::ElideRight, resultRect.width()));
+    painter->restore();
+}
+
+QSize HistoryDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const {
+    return {option.rect.width(), getRowHeight(option.fontMetrics)};
+}
+
+HistoryDelegate::Part HistoryDelegate::getPartAt(const QRect &rect, const QFontMetrics &fontMetrics, const QPoint &pos) {
+    QRect expressionRect, equalsRect, resultRect;
+    getRects(rect, fontMetrics, expressionRect, equalsRect, resultRect);
+    if (expressionRect.contains(pos))
+        return EXPRESSION;
+    else if (resultRect.contains(pos))
+        return RESULT;
+    else
+        return NONE;
+}
+
+int HistoryDelegate::getRowHeight(const QFontMetrics &fontMetrics) {
+    return fontMetrics.height() + ROW_SPACING;
+}
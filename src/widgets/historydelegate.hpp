@@ -0,0 +1,57 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_HISTORYDELEGATE_HPP
+#define QCALC_HISTORYDELEGATE_HPP
+
+#include <QStyledItemDelegate>
+
+/**
+ * Paints a history row as "expression = result" with both sides elided to half the row width.
+ *
+ * All rows share the same height so the view never has to measure rows that are not visible.
+ * Rows with the highlight role set, for example search matches, are painted with a tinted background.
+ */
+class HistoryDelegate : public QStyledItemDelegate {
+Q_OBJECT
+public:
+    enum Part {
+        NONE,
+        EXPRESSION,
+        RESULT
+    };
+
+    explicit HistoryDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+    /**
+     * @param rect The rectangle of the row in viewport coordinates.
+     * @param fontMetrics The metrics of the view font.
+     * @param pos The position in viewport coordinates.
+     * @return The part of the row at pos.
+     */
+    static Part getPartAt(const QRect &rect, const QFontMetrics &fontMetrics, const QPoint &pos);
+
+    static int getRowHeight(const QFontMetrics &fontMetrics);
+};
+
+#endif //QCALC_HISTORYDELEGATE_HPP
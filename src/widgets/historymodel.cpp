@@ -0,0 +1,111 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "widgets/historymodel.hpp"
+
+#include <algorithm>
+
+HistoryModel::HistoryModel(QObject *parent) : QAbstractListModel(parent) {}
+
+int HistoryModel::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid())
+        return 0;
+    return static_cast<int>(entries.size());
+}
+
+QVariant HistoryModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() < 0 || index.row() >= static_cast<int>(entries.size()))
+        return {};
+    auto &entry = entries.at(index.row());
+    switch (role) {
+        case Qt::DisplayRole:
+        case Qt::ToolTipRole:
+            return entry.expression + " = " + entry.result;
+        case ExpressionRole:
+            return entry.expression;
+        case ResultRole:
+            return entry.result;
+        case HighlightRole:
+            return std::binary_search(highlightedRows.begin(), highlightedRows.end(), index.row());
+        default:
+            return {};
+    }
+}
+
+const HistoryModel::Entry &HistoryModel::getEntry(int row) const {
+    return entries.at(row);
+}
+
+void HistoryModel::setEntries(const std::vector<Entry> &v) {
+    beginResetModel();
+    auto begin = v.begin();
+    if (maxEntries > 0 && v.size() > maxEntries) {
+        begin = v.end() - static_cast<long>(maxEntries);
+    }
+    entries = std::deque<Entry>(begin, v.end());
+    highlightedRows.clear();
+    endResetModel();
+}
+
+void HistoryModel::append(const QString &expression, const QString &result) {
+    auto row = static_cast<int>(entries.size());
+    beginInsertRows(QModelIndex(), row, row);
+    entries.emplace_back(Entry{expression, result});
+    endInsertRows();
+    trim();
+}
+
+void HistoryModel::clear() {
+    beginResetModel();
+    entries.clear();
+    highlightedRows.clear();
+    endResetModel();
+}
+
+void HistoryModel::setMaxEntries(size_t max) {
+    maxEntries = max;
+    trim();
+}
+
+size_t HistoryModel::getMaxEntries() const {
+    return maxEntries;
+}
+
+void HistoryModel::setHighlightedRows(std::vector<int> rows) {
+    if (rows.empty() && highlightedRows.empty())
+        return;
+    highlightedRows = std::move(rows);
+    if (!entries.empty()) {
+        emit dataChanged(index(0), index(static_cast<int>(entries.size()) - 1), {HighlightRole});
+    }
+}
+
+void HistoryModel::trim() {
+    if (maxEntries == 0 || entries.size() <= maxEntries)
+        return;
+    auto count = static_cast<int>(entries.size() - maxEntries);
+    beginRemoveRows(QModelIndex(), 0, count - 1);
+    entries.erase(entries.begin(), entries.begin() + count);
+    highlightedRows.erase(highlightedRows.begin(),
+                          std::lower_bound(highlightedRows.begin(), highlightedRows.end(), count));
+    for (auto &row: highlightedRows) {
+        row -= count;
+    }
+    endRemoveRows();
+}
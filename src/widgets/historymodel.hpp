@@ -0,0 +1,81 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_HISTORYMODEL_HPP
+#define QCALC_HISTORYMODEL_HPP
+
+#include <QAbstractListModel>
+
+#include <deque>
+#include <vector>
+
+/**
+ * Holds the expression / result pairs displayed in the history widget.
+ *
+ * When the number of entries exceeds the maximum the oldest entries are removed.
+ */
+class HistoryModel : public QAbstractListModel {
+Q_OBJECT
+public:
+    enum Role {
+        ExpressionRole = Qt::UserRole,
+        ResultRole,
+        HighlightRole
+    };
+
+    struct Entry {
+        QString expression;
+        QString result;
+    };
+
+    explicit HistoryModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    QVariant data(const QModelIndex &index, int role) const override;
+
+    const Entry &getEntry(int row) const;
+
+    void setEntries(const std::vector<Entry> &entries);
+
+    void append(const QString &expression, const QString &result);
+
+    void clear();
+
+    /**
+     * @param max The maximum number of entries, 0 for unlimited.
+     */
+    void setMaxEntries(size_t max);
+
+    size_t getMaxEntries() const;
+
+    /**
+     * @param rows The rows to highlight in ascending order.
+     */
+    void setHighlightedRows(std::vector<int> rows);
+
+private:
+    void trim();
+
+    std::deque<Entry> entries;
+    size_t maxEntries = 0;
+    std::vector<int> highlightedRows;
+};
+
+#endif //QCALC_HISTORYMODEL_HPP
@@ -0,0 +1,125 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "widgets/historywidget.hpp"
+
+#include <QVBoxLayout>
+#include <QMouseEvent>
+#include <QAction>
+#include <QApplication>
+#include <QClipboard>
+
+#include <algorithm>
+
+HistoryWidget::HistoryWidget(QWidget *parent) : QWidget(parent) {
+    setLayout(new QVBoxLayout());
+    layout()->setMargin(0);
+
+    model = new HistoryModel(this);
+    delegate = new HistoryDelegate(this);
+
+    view = new QListView(this);
+    view->setModel(model);
+    view->setItemDelegate(delegate);
+
+    // Rows all have the same height which allows the view to skip measuring rows that are not visible.
+    view->setUniformItemSizes(true);
+    view->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    view->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    view->setSelectionMode(QAbstractItemView::SingleSelection);
+    view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    view->setFrameShape(QFrame::NoFrame);
+    view->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    view->setStyleSheet("QListView{ background: palette(window); border: none; }");
+    view->viewport()->installEventFilter(this);
+
+    auto *copyAction = new QAction(view);
+    copyAction->setShortcut(QKeySequence::Copy);
+    copyAction->setShortcutContext(Qt::WidgetShortcut);
+    view->addAction(copyAction);
+    connect(copyAction, SIGNAL(triggered(bool)), this, SLOT(onCopy()));
+
+    layout()->addWidget(view);
+}
+
+bool HistoryWidget::eventFilter(QObject *watched, QEvent *event) {
+    if (watched == view->viewport() && event->type() == QEvent::MouseButtonDblClick) {
+        auto *mouseEvent = dynamic_cast<QMouseEvent *>(event);
+        auto index = view->indexAt(mouseEvent->pos());
+        if (index.isValid()) {
+            auto part = HistoryDelegate::getPartAt(view->visualRect(index),
+                                                   view->fontMetrics(),
+                                                   mouseEvent->pos());
+            if (part == HistoryDelegate::EXPRESSION) {
+                emit onTextDoubleClicked(index.data(HistoryModel::ExpressionRole).toString());
+            } else if (part == HistoryDelegate::RESULT) {
+                emit onTextDoubleClicked(index.data(HistoryModel::ResultRole).toString());
+            }
+        }
+        return true;
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+void HistoryWidget::clear() {
+    model->clear();
+}
+
+void HistoryWidget::setContent(const std::vector<HistoryModel::Entry> &entries) {
+    model->setEntries(entries);
+    scrollToBottom();
+}
+
+void HistoryWidget::addContent(const QString &expression, const QString &value) {
+    model->append(expression, value);
+    scrollToBottom();
+}
+
+void HistoryWidget::setMaxEntries(int max) {
+    model->setMaxEntries(static_cast<size_t>(std::max(0, max)));
+}
+
+void HistoryWidget::setHistoryFont(const QFont &font) {
+    view->setFont(font);
+}
+
+void HistoryWidget::setHighlightedRows(std::vector<int> rows) {
+    model->setHighlightedRows(std::move(rows));
+}
+
+void HistoryWidget::setCurrentRow(int row) {
+    if (row < 0 || row >= model->rowCount()) {
+        view->clearSelection();
+        return;
+    }
+    auto index = model->index(row);
+    view->setCurrentIndex(index);
+    view->scrollTo(index, QAbstractItemView::PositionAtCenter);
+}
+
+void HistoryWidget::scrollToBottom() {
+    view->scrollToBottom();
+}
+
+void HistoryWidget::onCopy() {
+    auto index = view->currentIndex();
+    if (index.isValid()) {
+        QApplication::clipboard()->setText(index.data(Qt::DisplayRole).toString());
+    }
+}
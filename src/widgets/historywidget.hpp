@@ -20,135 +20,63 @@
 #ifndef QCALC_HISTORYWIDGET_HPP
 #define QCALC_HISTORYWIDGET_HPP
 
-#include <QScrollArea>
-#include <QHBoxLayout>
-#include <QVBoxLayout>
-#include <QLabel>
-#include <QScrollBar>
-#include <QTimer>
-#include <QCoreApplication>
+#include <QWidget>
+#include <QListView>
 
-#include "widgets/historylabel.hpp"
+#include "widgets/historymodel.hpp"
+#include "widgets/historydelegate.hpp"
 
+/**
+ * Displays the expression history in a list view, only the visible rows are painted.
+ *
+ * Double clicking the expression or result of a row emits onTextDoubleClicked with the clicked text.
+ */
 class HistoryWidget : public QWidget {
 Q_OBJECT
 public:
-    explicit HistoryWidget(QWidget *parent = nullptr) : QWidget(parent) {
-        setLayout(new QVBoxLayout());
-        layout()->setMargin(0);
-
-        scroll = new QScrollArea(this);
-
-        container = new QWidget(this);
-        container->setLayout(new QVBoxLayout());
-        container->layout()->setMargin(0);
-        container->layout()->setSpacing(12);
-
-        scroll->setWidget(container);
-        scroll->setWidgetResizable(true);
-        scroll->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    explicit HistoryWidget(QWidget *parent = nullptr);
 
-        layout()->addWidget(scroll);
-
-        layout()->setMargin(0);
-
-        scroll->setStyleSheet(std::string("QScrollArea{ background: palette(window); border: none; }").c_str());
-
-        container->layout()->addItem(new QSpacerItem(0, 0, QSizePolicy::Minimum, QSizePolicy::Expanding));
-        container->layout()->setContentsMargins(8, 0, 8, 8);
-    }
+    bool eventFilter(QObject *watched, QEvent *event) override;
 
 public slots:
 
-    void clear() {
-        for (auto *p: rows) {
-            delete p;
-        }
-        rows.clear();
-    }
-
-    void setContent(const QList<QPair<QString, QString>> &c) {
-        clear();
-        for (auto &pair: c) {
-            addContent(pair.first, pair.second);
-        }
-    }
-
-    void addContent(const QString &expression, const QString &value) {
-        auto *row = new QWidget(container);
-        auto *expressionLabel = new HistoryLabel(row);
-        auto *equalsLabel = new QLabel(row);
-        auto *resultLabel = new HistoryLabel(row);
-
-        row->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    void clear();
 
-        expressionLabel->setFont(historyFont);
-        equalsLabel->setFont(historyFont);
-        resultLabel->setFont(historyFont);
+    void setContent(const std::vector<HistoryModel::Entry> &entries);
 
-        expressionLabel->setAlignment(Qt::AlignLeft);
-        equalsLabel->setAlignment(Qt::AlignHCenter);
-        resultLabel->setAlignment(Qt::AlignRight);
+    void addContent(const QString &expression, const QString &value);
 
-        auto *layout = new QHBoxLayout();
+    /**
+     * @param max The maximum number of displayed entries, 0 for unlimited.
+     */
+    void setMaxEntries(int max);
 
-        layout->setMargin(0);
+    void setHistoryFont(const QFont &font);
 
-        row->setLayout(layout);
+    /**
+     * @param rows The rows to highlight in ascending order, the oldest entry is row 0.
+     */
+    void setHighlightedRows(std::vector<int> rows);
 
-        layout->addWidget(expressionLabel, 5);
-        layout->addWidget(equalsLabel, 0);
-        layout->addWidget(resultLabel, 5);
+    /**
+     * Select the row and scroll it into view, -1 clears the selection.
+     */
+    void setCurrentRow(int row);
 
-        container->layout()->addWidget(row);
-        container->layout()->invalidate();
-        container->layout()->activate();
-
-        expressionLabel->setText(expression);
-        equalsLabel->setText("=");
-        resultLabel->setText(value);
-
-        expressionLabel->setCursorPosition(0);
-        resultLabel->setCursorPosition(0);
-
-        connect(expressionLabel,
-                SIGNAL(onDoubleClick(const QString &)),
-                this,
-                SIGNAL(onTextDoubleClicked(const QString &)));
-        connect(resultLabel,
-                SIGNAL(onDoubleClick(const QString &)),
-                this,
-                SIGNAL(onTextDoubleClicked(const QString &)));
-
-        rows.emplace_back(row);
-
-        scrollToBottom();
-    }
-
-    void setHistoryFont(const QFont &font) {
-        historyFont = font;
-    }
-
-    void scrollToBottom() {
-        // Call to processEvents is required here to apply previous modifications before scrolling.
-        QCoreApplication::processEvents();
-
-        // Hack to defer scrolling to next event loop iteration https://www.qtcentre.org/threads/18291-Force-a-Scroll-in-a-QScrollArea
-        QTimer::singleShot(0, this, [this]() {
-            scroll->verticalScrollBar()->setSliderPosition(scroll->verticalScrollBar()->maximum());
-        });
-    }
+    void scrollToBottom();
 
 signals:
 
     void onTextDoubleClicked(const QString &text);
 
-private:
-    QScrollArea *scroll;
-    QWidget *container;
-    std::vector<QWidget *> rows;
+private slots:
 
-    QFont historyFont;
+    void onCopy();
+
+private:
+    QListView *view;
+    HistoryModel *model;
+    HistoryDelegate *delegate;
 };
 
 #endif //QCALC_HISTORYWIDGET_HPP
@@ -24,6 +24,8 @@
 #include <QLine>
 #include <QFileDialog>
 
+#include "python/interpreterpool.hpp"
+
 PythonTab::PythonTab(QWidget *parent)
         : QWidget(parent) {
     modLabel = new QLabel(this);
@@ -34,6 +36,56 @@ PythonTab::PythonTab(QWidget *parent)
     pathLabel = new QLabel(this);
     pathEdit = new QLineEdit(this);
 
+    scrollbackLabel = new QLabel(this);
+    scrollbackSpin = new QSpinBox(this);
+
+    scrollbackLabel->setText("Console Scrollback Lines");
+    scrollbackLabel->setToolTip("The number of output lines which are kept in the python console.");
+
+    scrollbackSpin->setRange(100, 10000000);
+    scrollbackSpin->setToolTip("The number of output lines which are kept in the python console.");
+
+    callBudgetLabel = new QLabel(this);
+    callBudgetSpin = new QSpinBox(this);
+
+    callBudgetLabel->setText("Script Call Time Budget");
+    callBudgetLabel->setToolTip("The maximum duration of a single script call, a value of 0 disables the budget.");
+
+    callBudgetSpin->setRange(0, 3600000);
+    callBudgetSpin->setSuffix(" ms");
+    callBudgetSpin->setSpecialValueText("Unlimited");
+    callBudgetSpin->setToolTip("The maximum duration of a single script call, a value of 0 disables the budget.");
+
+    evaluationBudgetLabel = new QLabel(this);
+    evaluationBudgetSpin = new QSpinBox(this);
+
+    evaluationBudgetLabel->setText("Evaluation Time Budget");
+    evaluationBudgetLabel->setToolTip(
+            "The maximum duration of an evaluation which calls scripts, a value of 0 disables the budget.");
+
+    evaluationBudgetSpin->setRange(0, 3600000);
+    evaluationBudgetSpin->setSuffix(" ms");
+    evaluationBudgetSpin->setSpecialValueText("Unlimited");
+    evaluationBudgetSpin->setToolTip(
+            "The maximum duration of an evaluation which calls scripts, a value of 0 disables the budget.");
+
+    workersLabel = new QLabel(this);
+    workersSpin = new QSpinBox(this);
+
+    QString workersToolTip = "The number of python sub interpreters which run pure script functions in parallel,"
+                             " a value of 0 runs all scripts in the main interpreter. (Restart is required to apply changes)";
+    if (!InterpreterPool::isSupported()) {
+        workersToolTip = "Parallel script workers require Python 3.12 or newer.";
+        workersSpin->setEnabled(false);
+    }
+
+    workersLabel->setText("Script Worker Interpreters");
+    workersLabel->setToolTip(workersToolTip);
+
+    workersSpin->setRange(0, 256);
+    workersSpin->setSpecialValueText("Disabled");
+    workersSpin->setToolTip(workersToolTip);
+
     modListWidget->setToolTip(
             "List of paths that are added to the python sys module path (sys.path) after the interpreter initialized.");
 
@@ -64,6 +116,14 @@ PythonTab::PythonTab(QWidget *parent)
     auto *layout = new QVBoxLayout();
     layout->addWidget(pathLabel);
     layout->addWidget(pathEdit);
+    layout->addWidget(scrollbackLabel);
+    layout->addWidget(scrollbackSpin);
+    layout->addWidget(callBudgetLabel);
+    layout->addWidget(callBudgetSpin);
+    layout->addWidget(evaluationBudgetLabel);
+    layout->addWidget(evaluationBudgetSpin);
+    layout->addWidget(workersLabel);
+    layout->addWidget(workersSpin);
     layout->addWidget(pythonModPathContainerWidget);
     layout->addWidget(modListWidget, 1);
 
@@ -98,6 +158,38 @@ std::string PythonTab::getPythonPath() {
     return pathEdit->text().toStdString();
 }
 
+void PythonTab::setConsoleScrollback(int lines) {
+    scrollbackSpin->setValue(lines);
+}
+
+int PythonTab::getConsoleScrollback() {
+    return scrollbackSpin->value();
+}
+
+void PythonTab::setScriptCallBudget(int milliseconds) {
+    callBudgetSpin->setValue(milliseconds);
+}
+
+int PythonTab::getScriptCallBudget() {
+    return callBudgetSpin->value();
+}
+
+void PythonTab::setEvaluationBudget(int milliseconds) {
+    evaluationBudgetSpin->setValue(milliseconds);
+}
+
+int PythonTab::getEvaluationBudget() {
+    return evaluationBudgetSpin->value();
+}
+
+void PythonTab::setScriptWorkers(int workers) {
+    workersSpin->setValue(workers);
+}
+
+int PythonTab::getScriptWorkers() {
+    return workersSpin->value();
+}
+
 void PythonTab::addModDirClick() {
     QFileDialog dialog(this);
     dialog.setFileMode(QFileDialog::Directory);
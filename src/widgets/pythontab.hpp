@@ -40,6 +40,14 @@ public slots:
 
     void setPythonPath(const std::string &path);
 
+    void setConsoleScrollback(int lines);
+
+    void setScriptCallBudget(int milliseconds);
+
+    void setEvaluationBudget(int milliseconds);
+
+    void setScriptWorkers(int workers);
+
 public:
     explicit PythonTab(QWidget *parent = nullptr);
 
@@ -47,6 +55,14 @@ public:
 
     std::string getPythonPath();
 
+    int getConsoleScrollback();
+
+    int getScriptCallBudget();
+
+    int getEvaluationBudget();
+
+    int getScriptWorkers();
+
 private slots:
     void addModDirClick();
 
@@ -60,6 +76,18 @@ private:
     QLabel *pathLabel;
     QLineEdit *pathEdit;
 
+    QLabel *scrollbackLabel;
+    QSpinBox *scrollbackSpin;
+
+    QLabel *callBudgetLabel;
+    QSpinBox *callBudgetSpin;
+
+    QLabel *evaluationBudgetLabel;
+    QSpinBox *evaluationBudgetSpin;
+
+    QLabel *workersLabel;
+    QSpinBox *workersSpin;
+
     QLabel *modLabel;
     QPushButton *modDirAddButton;
     QPushButton *modFileAddButton;
@@ -0,0 +1,163 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "widgets/runtimestatisticswidget.hpp"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QFileDialog>
+#include <QMessageBox>
+
+#include "calculator/runtimestatistics.hpp"
+
+#include "io/fileoperations.hpp"
+
+static const QStringList COLUMNS = {"Kind",
+                                    "Name",
+                                    "Calls",
+                                    "Failures",
+                                    "Timeouts",
+                                    "Total ms",
+                                    "Mean ms",
+                                    "P50 ms",
+                                    "P90 ms",
+                                    "P99 ms",
+                                    "Max ms",
+                                    "Marshal ms",
+                                    "GIL Wait ms"};
+
+static QTableWidgetItem *createItem(const QString &text, bool numeric) {
+    auto *item = new QTableWidgetItem(text);
+    item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+    if (numeric) {
+        item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    return item;
+}
+
+static QTableWidgetItem *createItem(size_t value) {
+    return createItem(QString::number(value), true);
+}
+
+static QTableWidgetItem *createItem(double value) {
+    return createItem(QString::number(value, 'f', 3), true);
+}
+
+RuntimeStatisticsWidget::RuntimeStatisticsWidget(QWidget *parent)
+        : QWidget(parent) {
+    table = new QTableWidget(this);
+    resetButton = new QPushButton(this);
+    exportButton = new QPushButton(this);
+    refreshTimer = new QTimer(this);
+
+    table->setColumnCount(COLUMNS.size());
+    table->setHorizontalHeaderLabels(COLUMNS);
+    table->verticalHeader()->hide();
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    table->horizontalHeader()->setStretchLastSection(true);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->setToolTip("Percentiles are computed from the most recent "
+                      + QString::number(RuntimeStatistics::SAMPLE_COUNT)
+                      + " calls, cached results of pure scripts are not counted.");
+
+    resetButton->setText("Reset");
+    exportButton->setText("Export CSV");
+
+    auto *buttonLayout = new QHBoxLayout;
+    buttonLayout->setMargin(0);
+    buttonLayout->addWidget(new QLabel("Runtime Statistics"), 1);
+    buttonLayout->addWidget(resetButton);
+    buttonLayout->addWidget(exportButton);
+
+    auto *layout = new QVBoxLayout;
+    layout->setMargin(0);
+    layout->addLayout(buttonLayout);
+    layout->addWidget(table, 1);
+    setLayout(layout);
+
+    refreshTimer->setInterval(REFRESH_INTERVAL);
+
+    connect(resetButton, SIGNAL(clicked()), this, SLOT(resetPressed()));
+    connect(exportButton, SIGNAL(clicked()), this, SLOT(exportPressed()));
+    connect(refreshTimer, SIGNAL(timeout()), this, SLOT(refresh()));
+}
+
+void RuntimeStatisticsWidget::refresh() {
+    auto entries = RuntimeStatistics::getEntries();
+
+    table->setSortingEnabled(false);
+    table->setRowCount(static_cast<int>(entries.size()));
+    for (int row = 0; row < static_cast<int>(entries.size()); row++) {
+        auto &entry = entries.at(row);
+        int column = 0;
+        table->setItem(row, column++, createItem(RuntimeStatistics::getKindName(entry.kind).c_str(), false));
+        table->setItem(row, column++, createItem(entry.name.c_str(), false));
+        table->setItem(row, column++, createItem(entry.calls));
+        table->setItem(row, column++, createItem(entry.failures));
+        table->setItem(row, column++, createItem(entry.timeouts));
+        table->setItem(row, column++, createItem(entry.totalTime));
+        table->setItem(row, column++, createItem(entry.meanTime()));
+        table->setItem(row, column++, createItem(entry.p50));
+        table->setItem(row, column++, createItem(entry.p90));
+        table->setItem(row, column++, createItem(entry.p99));
+        table->setItem(row, column++, createItem(entry.maxTime));
+        table->setItem(row, column++, createItem(entry.marshalTime));
+        table->setItem(row, column, createItem(entry.gilWaitTime));
+    }
+}
+
+void RuntimeStatisticsWidget::showEvent(QShowEvent *event) {
+    QWidget::showEvent(event);
+    refresh();
+    refreshTimer->start();
+}
+
+void RuntimeStatisticsWidget::hideEvent(QHideEvent *event) {
+    QWidget::hideEvent(event);
+    refreshTimer->stop();
+}
+
+void RuntimeStatisticsWidget::resetPressed() {
+    RuntimeStatistics::reset();
+    refresh();
+}
+
+void RuntimeStatisticsWidget::exportPressed() {
+    QFileDialog dialog(this);
+    dialog.setWindowTitle("Export runtime statistics as ...");
+    dialog.setFileMode(QFileDialog::AnyFile);
+    dialog.setAcceptMode(QFileDialog::AcceptSave);
+    dialog.setMimeTypeFilters({"text/csv"});
+    dialog.setDefaultSuffix("csv");
+
+    if (!dialog.exec()) {
+        return;
+    }
+
+    auto path = dialog.selectedFiles().at(0).toStdString();
+    try {
+        FileOperations::fileWriteAll(path, RuntimeStatistics::toCsv(RuntimeStatistics::getEntries()));
+    } catch (const std::exception &e) {
+        QMessageBox::critical(this,
+                              "Export failed",
+                              ("Failed to export runtime statistics to " + path + "\n" + e.what()).c_str());
+    }
+}
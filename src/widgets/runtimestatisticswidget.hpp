@@ -0,0 +1,61 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_RUNTIMESTATISTICSWIDGET_HPP
+#define QCALC_RUNTIMESTATISTICSWIDGET_HPP
+
+#include <QWidget>
+#include <QTableWidget>
+#include <QPushButton>
+#include <QTimer>
+
+/**
+ * Displays the RuntimeStatistics of script calls and addon callbacks.
+ * The table is refreshed periodically while the widget is visible.
+ */
+class RuntimeStatisticsWidget : public QWidget {
+Q_OBJECT
+public:
+    static const int REFRESH_INTERVAL = 1000; // Milliseconds
+
+    explicit RuntimeStatisticsWidget(QWidget *parent = nullptr);
+
+public slots:
+
+    void refresh();
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+
+    void resetPressed();
+
+    void exportPressed();
+
+private:
+    QTableWidget *table;
+    QPushButton *resetButton;
+    QPushButton *exportButton;
+    QTimer *refreshTimer;
+};
+
+#endif //QCALC_RUNTIMESTATISTICSWIDGET_HPP
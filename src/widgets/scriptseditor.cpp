@@ -64,6 +64,14 @@ void ScriptsEditor::setScripts(const std::map<std::string, Script> &scripts) {
             text.append(")");
         }
 
+        if (p.second.pure) {
+            text.append(" - Pure");
+        }
+
+        if (p.second.batched) {
+            text.append(" - Batched");
+        }
+
         widget->setText(text.c_str());
 
         item->setSizeHint(widget->sizeHint());
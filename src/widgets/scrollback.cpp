@@ -0,0 +1,97 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "widgets/scrollback.hpp"
+
+#include <stdexcept>
+
+Scrollback::Scrollback(size_t lineLimit)
+        : lineLimit(lineLimit) {}
+
+size_t Scrollback::append(const QString &text, bool error) {
+    auto str = text;
+    if (str.endsWith('\n')) {
+        str.chop(1);
+    }
+    if (str.isEmpty()) {
+        return 0;
+    }
+    auto lines = str.split('\n');
+    for (auto &line: lines) {
+        for (int i = 0; i < line.size() || i == 0; i += MAX_LINE_LENGTH) {
+            appendLine(line.mid(i, MAX_LINE_LENGTH), error);
+        }
+    }
+    return dropChunks();
+}
+
+size_t Scrollback::setLineLimit(size_t limit) {
+    lineLimit = limit;
+    return dropChunks();
+}
+
+const Scrollback::Line &Scrollback::at(size_t line) const {
+    if (line < firstLine || line >= firstLine + lineCount) {
+        throw std::runtime_error("Line out of range");
+    }
+    auto index = line - firstLine;
+    return chunks.at(index / CHUNK_SIZE)->at(index % CHUNK_SIZE);
+}
+
+void Scrollback::clear() {
+    firstLine += lineCount;
+    lineCount = 0;
+    chunks.clear();
+}
+
+Scrollback::Snapshot Scrollback::snapshot() const {
+    Snapshot ret;
+    ret.firstLine = firstLine;
+    for (auto &chunk: chunks) {
+        if (chunk->size() == CHUNK_SIZE) {
+            ret.chunks.emplace_back(chunk);
+        } else {
+            // The last chunk is still being appended to
+            ret.chunks.emplace_back(std::make_shared<const Chunk>(*chunk));
+        }
+    }
+    return ret;
+}
+
+void Scrollback::appendLine(const QString &text, bool error) {
+    if (chunks.empty() || chunks.back()->size() == CHUNK_SIZE) {
+        auto chunk = std::make_shared<Chunk>();
+        chunk->reserve(CHUNK_SIZE);
+        chunks.emplace_back(chunk);
+    }
+    chunks.back()->emplace_back(Line{text, error});
+    lineCount++;
+}
+
+size_t Scrollback::dropChunks() {
+    // Chunks are always full except the last one
+    size_t dropped = 0;
+    while (chunks.size() > 1 && lineCount - CHUNK_SIZE >= lineLimit) {
+        chunks.pop_front();
+        lineCount -= CHUNK_SIZE;
+        firstLine += CHUNK_SIZE;
+        dropped += CHUNK_SIZE;
+    }
+    return dropped;
+}
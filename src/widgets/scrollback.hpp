@@ -0,0 +1,109 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALCULATOR_SCROLLBACK_HPP
+#define QCALCULATOR_SCROLLBACK_HPP
+
+#include <QString>
+
+#include <deque>
+#include <vector>
+#include <memory>
+
+/**
+ * Line buffer with a bounded number of lines.
+ *
+ * Lines are stored in fixed size chunks, when the line limit is exceeded the oldest chunk is dropped.
+ * Lines are addressed by their absolute line number which keeps counting up when lines are dropped.
+ * Full chunks are never modified again which allows cheap snapshots for searching on another thread.
+ */
+class Scrollback {
+public:
+    struct Line {
+        QString text;
+        bool error = false;
+    };
+
+    typedef std::vector<Line> Chunk;
+
+    /**
+     * An immutable view of the lines at the time of the snapshot.
+     */
+    struct Snapshot {
+        size_t firstLine = 0;
+        std::vector<std::shared_ptr<const Chunk>> chunks;
+    };
+
+    static const size_t CHUNK_SIZE = 256;
+
+    /**
+     * Longer lines are split into multiple lines.
+     */
+    static const int MAX_LINE_LENGTH = 4096;
+
+    explicit Scrollback(size_t lineLimit);
+
+    /**
+     * Append the text as new lines, a single trailing newline is ignored.
+     *
+     * @param text The text to append.
+     * @param error Whether the text was written to the error stream.
+     * @return The number of lines which were dropped from the beginning of the buffer.
+     */
+    size_t append(const QString &text, bool error);
+
+    /**
+     * @param limit The minimum number of retained lines, up to CHUNK_SIZE - 1 additional lines may be retained.
+     * @return The number of lines which were dropped from the beginning of the buffer.
+     */
+    size_t setLineLimit(size_t limit);
+
+    size_t getLineLimit() const { return lineLimit; }
+
+    /**
+     * @return The number of retained lines.
+     */
+    size_t size() const { return lineCount; }
+
+    /**
+     * @return The absolute line number of the first retained line.
+     */
+    size_t getFirstLine() const { return firstLine; }
+
+    /**
+     * @param line The absolute line number which must be in the range [getFirstLine(), getFirstLine() + size()).
+     */
+    const Line &at(size_t line) const;
+
+    void clear();
+
+    Snapshot snapshot() const;
+
+private:
+    void appendLine(const QString &text, bool error);
+
+    size_t dropChunks();
+
+    std::deque<std::shared_ptr<Chunk>> chunks;
+    size_t firstLine = 0;
+    size_t lineCount = 0;
+    size_t lineLimit;
+};
+
+#endif //QCALCULATOR_SCROLLBACK_HPP
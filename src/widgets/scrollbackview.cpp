@@ -0,0 +1,308 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "widgets/scrollbackview.hpp"
+
+#include <QPainter>
+#include <QScrollBar>
+#include <QMouseEvent>
+#include <QKeyEvent>
+#include <QApplication>
+#include <QClipboard>
+
+#include <algorithm>
+
+static const int TEXT_MARGIN = 4;
+
+ScrollbackView::ScrollbackView(QWidget *parent)
+        : QAbstractScrollArea(parent),
+          scrollback(10000) {
+    setFocusPolicy(Qt::ClickFocus);
+    setFrameShape(QFrame::NoFrame);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    viewport()->setCursor(Qt::IBeamCursor);
+    updateScrollBars();
+}
+
+ScrollbackView::~ScrollbackView() {
+    stopSearch();
+}
+
+void ScrollbackView::append(const QString &text, bool error) {
+    auto *bar = verticalScrollBar();
+    bool atBottom = bar->value() == bar->maximum();
+    auto value = bar->value();
+
+    auto end = scrollback.getFirstLine() + scrollback.size();
+    auto dropped = scrollback.append(text, error);
+
+    auto fm = fontMetrics();
+    for (auto line = std::max(end, scrollback.getFirstLine());
+         line < scrollback.getFirstLine() + scrollback.size();
+         line++) {
+        maxLineWidth = std::max(maxLineWidth, fm.horizontalAdvance(scrollback.at(line).text));
+    }
+
+    updateScrollBars();
+
+    if (atBottom) {
+        bar->setValue(bar->maximum());
+    } else {
+        // Keep the visible lines in place when lines are dropped from the top
+        bar->setValue(value - static_cast<int>(std::min<size_t>(dropped, value)));
+    }
+
+    viewport()->update();
+}
+
+void ScrollbackView::clear() {
+    stopSearch();
+    scrollback.clear();
+    matches.clear();
+    hasSelection = false;
+    maxLineWidth = 0;
+    updateScrollBars();
+    viewport()->update();
+}
+
+void ScrollbackView::setLineLimit(int limit) {
+    scrollback.setLineLimit(std::max(limit, 1));
+    updateScrollBars();
+    viewport()->update();
+}
+
+int ScrollbackView::getLineLimit() const {
+    return static_cast<int>(scrollback.getLineLimit());
+}
+
+QString ScrollbackView::getText() const {
+    QString ret;
+    for (auto line = scrollback.getFirstLine(); line < scrollback.getFirstLine() + scrollback.size(); line++) {
+        if (!ret.isEmpty())
+            ret += '\n';
+        ret += scrollback.at(line).text;
+    }
+    return ret;
+}
+
+void ScrollbackView::search(const QString &text) {
+    stopSearch();
+
+    matches.clear();
+    currentMatch = 0;
+    viewport()->update();
+
+    if (text.isEmpty()) {
+        emit searchFinished(0);
+        return;
+    }
+
+    auto generation = ++searchGeneration;
+    auto snapshot = scrollback.snapshot();
+
+    searchThread = std::thread([this, snapshot, text, generation]() {
+        std::vector<size_t> result;
+        auto line = snapshot.firstLine;
+        for (auto &chunk: snapshot.chunks) {
+            if (searchGeneration != generation)
+                return;
+            for (auto &l: *chunk) {
+                if (l.text.contains(text, Qt::CaseInsensitive)) {
+                    result.emplace_back(line);
+                }
+                line++;
+            }
+        }
+
+        QMetaObject::invokeMethod(this, [this, result, generation]() {
+            if (searchGeneration != generation)
+                return;
+            matches = result;
+            if (!matches.empty()) {
+                currentMatch = matches.size() - 1;
+                scrollToLine(matches.at(currentMatch));
+            }
+            viewport()->update();
+            emit searchFinished(static_cast<int>(matches.size()));
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ScrollbackView::findPrevious() {
+    if (matches.empty())
+        return;
+    if (currentMatch > 0)
+        currentMatch--;
+    while (currentMatch + 1 < matches.size() && matches.at(currentMatch) < scrollback.getFirstLine())
+        currentMatch++;
+    scrollToLine(matches.at(currentMatch));
+    viewport()->update();
+}
+
+void ScrollbackView::findNext() {
+    if (matches.empty())
+        return;
+    if (currentMatch + 1 < matches.size())
+        currentMatch++;
+    scrollToLine(matches.at(currentMatch));
+    viewport()->update();
+}
+
+void ScrollbackView::paintEvent(QPaintEvent *event) {
+    QPainter painter(viewport());
+
+    auto lineHeight = getLineHeight();
+    auto ascent = fontMetrics().ascent();
+    auto width = viewport()->width();
+    auto xOffset = TEXT_MARGIN - horizontalScrollBar()->value();
+
+    auto first = scrollback.getFirstLine() + verticalScrollBar()->value();
+    auto end = std::min(first + getVisibleLineCount() + 1, scrollback.getFirstLine() + scrollback.size());
+
+    auto selectionBegin = std::min(selectionAnchor, selectionEnd);
+    auto selectionLast = std::max(selectionAnchor, selectionEnd);
+
+    auto matchColor = palette().color(QPalette::Highlight);
+    matchColor.setAlpha(60);
+    auto currentMatchColor = palette().color(QPalette::Highlight);
+    currentMatchColor.setAlpha(120);
+
+    for (auto line = first; line < end; line++) {
+        auto &l = scrollback.at(line);
+        QRect rect(0, static_cast<int>(line - first) * lineHeight, width, lineHeight);
+
+        bool selected = hasSelection && line >= selectionBegin && line <= selectionLast;
+        if (selected) {
+            painter.fillRect(rect, palette().color(QPalette::Highlight));
+            painter.setPen(palette().color(QPalette::HighlightedText));
+        } else {
+            if (std::binary_search(matches.begin(), matches.end(), line)) {
+                bool current = matches.at(currentMatch) == line;
+                painter.fillRect(rect, current ? currentMatchColor : matchColor);
+            }
+            painter.setPen(l.error ? QColor(Qt::red) : palette().color(QPalette::Text));
+        }
+
+        painter.drawText(xOffset, rect.top() + ascent, l.text);
+    }
+}
+
+void ScrollbackView::resizeEvent(QResizeEvent *event) {
+    auto *bar = verticalScrollBar();
+    bool atBottom = bar->value() == bar->maximum();
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+    if (atBottom)
+        bar->setValue(bar->maximum());
+}
+
+void ScrollbackView::mousePressEvent(QMouseEvent *event) {
+    if (event->button() == Qt::LeftButton) {
+        selectionAnchor = getLineAt(event->pos());
+        selectionEnd = selectionAnchor;
+        hasSelection = false;
+        viewport()->update();
+    }
+    QAbstractScrollArea::mousePressEvent(event);
+}
+
+void ScrollbackView::mouseMoveEvent(QMouseEvent *event) {
+    if (event->buttons() & Qt::LeftButton) {
+        selectionEnd = getLineAt(event->pos());
+        hasSelection = true;
+        viewport()->update();
+    }
+    QAbstractScrollArea::mouseMoveEvent(event);
+}
+
+void ScrollbackView::keyPressEvent(QKeyEvent *event) {
+    if (event->matches(QKeySequence::Copy)) {
+        copySelection();
+    } else if (event->matches(QKeySequence::SelectAll)) {
+        if (scrollback.size() > 0) {
+            selectionAnchor = scrollback.getFirstLine();
+            selectionEnd = scrollback.getFirstLine() + scrollback.size() - 1;
+            hasSelection = true;
+            viewport()->update();
+        }
+    } else {
+        QAbstractScrollArea::keyPressEvent(event);
+    }
+}
+
+int ScrollbackView::getLineHeight() const {
+    return std::max(fontMetrics().lineSpacing(), 1);
+}
+
+int ScrollbackView::getVisibleLineCount() const {
+    return viewport()->height() / getLineHeight();
+}
+
+size_t ScrollbackView::getLineAt(const QPoint &pos) const {
+    auto line = scrollback.getFirstLine()
+                + verticalScrollBar()->value()
+                + std::max(pos.y(), 0) / getLineHeight();
+    if (scrollback.size() == 0)
+        return scrollback.getFirstLine();
+    return std::min(line, scrollback.getFirstLine() + scrollback.size() - 1);
+}
+
+void ScrollbackView::updateScrollBars() {
+    auto visible = getVisibleLineCount();
+    auto *vBar = verticalScrollBar();
+    vBar->setRange(0, std::max(0, static_cast<int>(scrollback.size()) - visible));
+    vBar->setPageStep(visible);
+    vBar->setSingleStep(1);
+
+    auto *hBar = horizontalScrollBar();
+    hBar->setRange(0, std::max(0, maxLineWidth + 2 * TEXT_MARGIN - viewport()->width()));
+    hBar->setPageStep(viewport()->width());
+}
+
+void ScrollbackView::scrollToLine(size_t line) {
+    if (line < scrollback.getFirstLine())
+        return;
+    auto index = static_cast<int>(line - scrollback.getFirstLine());
+    verticalScrollBar()->setValue(index - getVisibleLineCount() / 2);
+}
+
+void ScrollbackView::stopSearch() {
+    searchGeneration++;
+    if (searchThread.joinable()) {
+        searchThread.join();
+    }
+}
+
+void ScrollbackView::copySelection() {
+    if (!hasSelection || scrollback.size() == 0)
+        return;
+
+    auto begin = std::max(std::min(selectionAnchor, selectionEnd), scrollback.getFirstLine());
+    auto last = std::min(std::max(selectionAnchor, selectionEnd),
+                         scrollback.getFirstLine() + scrollback.size() - 1);
+
+    QString text;
+    for (auto line = begin; line <= last; line++) {
+        if (line != begin)
+            text += '\n';
+        text += scrollback.at(line).text;
+    }
+    QApplication::clipboard()->setText(text);
+}
@@ -0,0 +1,118 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALCULATOR_SCROLLBACKVIEW_HPP
+#define QCALCULATOR_SCROLLBACKVIEW_HPP
+
+#include <QAbstractScrollArea>
+
+#include <thread>
+#include <atomic>
+#include <vector>
+
+#include "widgets/scrollback.hpp"
+
+/**
+ * Displays the contents of a scrollback buffer, only the lines in the visible region are painted.
+ *
+ * Lines can be selected with the mouse and copied with Ctrl+C.
+ * Searching runs on a background thread over a snapshot of the buffer.
+ */
+class ScrollbackView : public QAbstractScrollArea {
+Q_OBJECT
+signals:
+
+    /**
+     * Emitted when a search has completed.
+     *
+     * @param matches The number of matching lines.
+     */
+    void searchFinished(int matches);
+
+public:
+    explicit ScrollbackView(QWidget *parent = nullptr);
+
+    ~ScrollbackView() override;
+
+    void append(const QString &text, bool error);
+
+    void clear();
+
+    void setLineLimit(int limit);
+
+    int getLineLimit() const;
+
+    /**
+     * @return The text of all retained lines.
+     */
+    QString getText() const;
+
+    /**
+     * Start searching the retained lines for the case-insensitive text, a running search is cancelled.
+     * Matching lines are highlighted when the search has finished.
+     */
+    void search(const QString &text);
+
+    /**
+     * Scroll to the previous / next search match relative to the current match.
+     */
+    void findPrevious();
+
+    void findNext();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+    void resizeEvent(QResizeEvent *event) override;
+
+    void mousePressEvent(QMouseEvent *event) override;
+
+    void mouseMoveEvent(QMouseEvent *event) override;
+
+    void keyPressEvent(QKeyEvent *event) override;
+
+private:
+    int getLineHeight() const;
+
+    int getVisibleLineCount() const;
+
+    size_t getLineAt(const QPoint &pos) const;
+
+    void updateScrollBars();
+
+    void scrollToLine(size_t line);
+
+    void stopSearch();
+
+    void copySelection();
+
+    Scrollback scrollback;
+    int maxLineWidth = 0;
+
+    bool hasSelection = false;
+    size_t selectionAnchor = 0;
+    size_t selectionEnd = 0;
+
+    std::thread searchThread;
+    std::atomic<int> searchGeneration{0};
+    std::vector<size_t> matches;
+    size_t currentMatch = 0;
+};
+
+#endif //QCALCULATOR_SCROLLBACKVIEW_HPP
@@ -94,6 +94,10 @@ SymbolsEditor::SymbolsEditor(QWidget *parent) : QWidget(parent) {
             SIGNAL(onFunctionArgsChanged(const QString &, const std::vector<std::string> &)),
             this,
             SLOT(onFunctionArgsChanged(const QString &, const std::vector<std::string> &)));
+    connect(functionsEditor,
+            SIGNAL(onFunctionPureChanged(const QString &, bool)),
+            this,
+            SLOT(onFunctionPureChanged(const QString &, bool)));
     connect(functionsEditor,
             SIGNAL(onCurrentFunctionChanged(const QString &)),
             this,
@@ -346,6 +350,13 @@ void SymbolsEditor::onFunctionArgsChanged(const QString &name, const std::vector
     emit onSymbolsChanged(symbolTable);
 }
 
+void SymbolsEditor::onFunctionPureChanged(const QString &name, bool pure) {
+    Function f = symbolTable.getFunctions().at(name.toStdString());
+    f.pure = pure;
+    symbolTable.setFunction(name.toStdString(), f);
+    emit onSymbolsChanged(symbolTable);
+}
+
 void SymbolsEditor::onCurrentFunctionChanged(const QString &name) {
     currentFunction = name;
 }
@@ -69,6 +69,8 @@ private slots:
 
     void onFunctionArgsChanged(const QString &name, const std::vector<std::string> &args);
 
+    void onFunctionPureChanged(const QString &name, bool pure);
+
     void onCurrentFunctionChanged(const QString &name);
 
     void onUseBuiltInsChanged(bool useBuiltIns);
@@ -24,24 +24,28 @@
 #include <QLabel>
 #include <QLineEdit>
 #include <QHBoxLayout>
-#include <QScrollArea>
 #include <QSizePolicy>
-#include <QScrollBar>
 #include <QPushButton>
 #include <QTextEdit>
 #include <QCheckBox>
+#include <QShortcut>
 
-#include "io/stringutil.hpp"
+#include "widgets/scrollbackview.hpp"
 
 class TerminalWidget : public QWidget {
 Q_OBJECT
 public:
     explicit TerminalWidget(QWidget *parent = nullptr) : QWidget(parent) {
-        historyLabel = new QLabel();
+        scrollbackView = new ScrollbackView();
         singleLineContainer = new QWidget();
         promptLabel = new QLabel();
         inputEdit = new QLineEdit();
-        scroll = new QScrollArea();
+
+        searchContainer = new QWidget();
+        searchEdit = new QLineEdit();
+        searchLabel = new QLabel();
+        searchPreviousButton = new QPushButton();
+        searchNextButton = new QPushButton();
 
         multiLineContainer = new QWidget();
         multiButton = new QPushButton();
@@ -51,19 +55,21 @@ public:
         multiButton->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
         multiButton->setText("Run");
 
-        historyLabel->setTextInteractionFlags(Qt::TextInteractionFlag::LinksAccessibleByKeyboard
-                                              | Qt::TextInteractionFlag::LinksAccessibleByMouse
-                                              | Qt::TextInteractionFlag::TextSelectableByKeyboard
-                                              | Qt::TextInteractionFlag::TextSelectableByMouse);
+        scrollbackView->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
 
-        scroll->setFrameShadow(QFrame::Plain);
-        scroll->setFrameShape(QFrame::NoFrame);
+        searchEdit->setPlaceholderText("Search...");
+        searchPreviousButton->setText("Previous");
+        searchNextButton->setText("Next");
 
-        scroll->setWidget(historyLabel);
-        scroll->setAlignment(Qt::AlignmentFlag::AlignBottom);
-        scroll->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+        auto layoutSearch = new QHBoxLayout();
+        layoutSearch->setMargin(0);
+        layoutSearch->addWidget(searchEdit, 1);
+        layoutSearch->addWidget(searchLabel);
+        layoutSearch->addWidget(searchPreviousButton);
+        layoutSearch->addWidget(searchNextButton);
 
-        scroll->setWidgetResizable(true);
+        searchContainer->setLayout(layoutSearch);
+        searchContainer->setVisible(false);
 
         auto layoutMulti = new QHBoxLayout();
         layoutMulti->setMargin(0);
@@ -79,18 +85,35 @@ public:
 
         promptLabel->setText(">>>");
 
-        historyLabel->setContentsMargins(0, 0, 0, 0);
-        historyLabel->setAlignment(Qt::AlignmentFlag::AlignBottom);
-        historyLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
-        historyLabel->setTextFormat(Qt::RichText);
-
         inputEdit->setStyleSheet("QLineEdit { background-color: rgba(0, 0, 0, 0); }");
         inputEdit->setFrame(false);
 
         connect(inputEdit, SIGNAL(returnPressed()), this, SIGNAL(onReturnPressed()));
 
-        connect(scroll->verticalScrollBar(), &QScrollBar::rangeChanged, [this](int min, int max) {
-            scroll->verticalScrollBar()->setValue(max);
+        connect(searchEdit, &QLineEdit::textChanged, [this](const QString &text) {
+            searchLabel->setText(text.isEmpty() ? "" : "Searching...");
+            scrollbackView->search(text);
+        });
+        connect(searchEdit, &QLineEdit::returnPressed, scrollbackView, &ScrollbackView::findPrevious);
+        connect(searchPreviousButton, &QPushButton::clicked, scrollbackView, &ScrollbackView::findPrevious);
+        connect(searchNextButton, &QPushButton::clicked, scrollbackView, &ScrollbackView::findNext);
+        connect(scrollbackView, &ScrollbackView::searchFinished, [this](int matches) {
+            searchLabel->setText(searchEdit->text().isEmpty() ? "" : QString::number(matches) + " matches");
+        });
+
+        auto *searchShortcut = new QShortcut(QKeySequence::Find, this);
+        connect(searchShortcut, &QShortcut::activated, [this]() {
+            searchContainer->setVisible(true);
+            searchEdit->setFocus();
+            searchEdit->selectAll();
+        });
+
+        auto *closeSearchShortcut = new QShortcut(QKeySequence(Qt::Key_Escape), searchEdit);
+        closeSearchShortcut->setContext(Qt::WidgetShortcut);
+        connect(closeSearchShortcut, &QShortcut::activated, [this]() {
+            searchEdit->clear();
+            searchContainer->setVisible(false);
+            inputEdit->setFocus();
         });
 
         connect(multiCheckBox, &QCheckBox::toggled, [this](bool toggle) {
@@ -104,7 +127,8 @@ public:
         auto l = new QVBoxLayout();
         l->setMargin(6);
         l->setSpacing(0);
-        l->addWidget(scroll, 1);
+        l->addWidget(searchContainer);
+        l->addWidget(scrollbackView, 1);
         l->addWidget(singleLineContainer);
         l->addWidget(multiLineContainer);
         l->addWidget(multiCheckBox);
@@ -120,34 +144,14 @@ signals:
 public slots:
 
     void printError(const QString &err) {
-        auto str = err.toStdString();
-        StringUtil::replace_all(str, "<", "&lt;");
-        StringUtil::replace_all(str, ">", "&gt;");
-        StringUtil::replace_all(str, "\n", "<br>");
-        //Remove trailing newline
-        if (!str.empty() && str.rfind("<br>") == str.size() - 4) {
-            str = str.substr(0, str.size() - 4);
+        if (!err.isEmpty()) {
+            scrollbackView->append(err, true);
         }
-        if (!str.empty()) {
-            historyLabel->setText(historyLabel->text()
-                                  + "<br><font color=\"red\">"
-                                  + QString(str.c_str())
-                                  + "</font>");
-        }
-
     }
 
     void printOutput(const QString &out) {
-        auto str = out.toStdString();
-        StringUtil::replace_all(str, "<", "&lt;");
-        StringUtil::replace_all(str, ">", "&gt;");
-        StringUtil::replace_all(str, "\n", "<br>");
-        //Remove trailing newline
-        if (!str.empty() && str.rfind("<br>") == str.size() - 4) {
-            str = str.substr(0, str.size() - 4);
-        }
-        if (!str.empty()) {
-            historyLabel->setText(historyLabel->text() + "<br>" + QString(str.c_str()));
+        if (!out.isEmpty()) {
+            scrollbackView->append(out, false);
         }
     }
 
@@ -174,11 +178,18 @@ public slots:
     }
 
     QString getHistoryText() {
-        return historyLabel->text();
+        return scrollbackView->getText();
     }
 
-    void setHistoryText(const QString &text) {
-        historyLabel->setText(text);
+    void clearHistory() {
+        scrollbackView->clear();
+    }
+
+    /**
+     * @param lines The number of output lines which are kept in the console.
+     */
+    void setScrollbackLimit(int lines) {
+        scrollbackView->setLineLimit(lines);
     }
 
     void setMultiLineInput(bool multi) {
@@ -199,7 +210,13 @@ public slots:
 private:
     bool multiLine = false;
 
-    QLabel *historyLabel;
+    ScrollbackView *scrollbackView;
+
+    QWidget *searchContainer;
+    QLineEdit *searchEdit;
+    QLabel *searchLabel;
+    QPushButton *searchPreviousButton;
+    QPushButton *searchNextButton;
 
     QWidget *singleLineContainer;
     QLabel *promptLabel;
@@ -210,8 +227,6 @@ private:
     QTextEdit *multiEdit;
 
     QCheckBox *multiCheckBox;
-
-    QScrollArea *scroll;
 };
 
 #endif //QCALC_TERMINALWIDGET_HPP
@@ -0,0 +1,192 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "windows/archivejobdialog.hpp"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QProgressBar>
+
+#include <algorithm>
+
+static const QStringList COLUMNS = {"Job", "Status", "Progress", "Throughput", "Remaining"};
+
+static QString formatBytes(double bytes) {
+    static const char *const units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+    int unit = 0;
+    while (bytes >= 1024 && unit < 4) {
+        bytes /= 1024;
+        unit++;
+    }
+    return QString::number(bytes, 'f', unit == 0 ? 0 : 1) + " " + units[unit];
+}
+
+static QString formatTime(double seconds) {
+    if (seconds < 0)
+        return "";
+    auto s = static_cast<long>(seconds + 0.5);
+    if (s >= 3600)
+        return QString("%1:%2:%3").arg(s / 3600).arg(s / 60 % 60, 2, 10, QChar('0')).arg(s % 60, 2, 10, QChar('0'));
+    return QString("%1:%2").arg(s / 60).arg(s % 60, 2, 10, QChar('0'));
+}
+
+static QString getStateName(ArchiveJobQueue::State state) {
+    switch (state) {
+        case ArchiveJobQueue::QUEUED:
+            return "Queued";
+        case ArchiveJobQueue::RUNNING:
+            return "Running";
+        case ArchiveJobQueue::FINISHED:
+            return "Finished";
+        case ArchiveJobQueue::FAILED:
+            return "Failed";
+        case ArchiveJobQueue::CANCELLED:
+            return "Cancelled";
+        default:
+            return "";
+    }
+}
+
+static QTableWidgetItem *createItem(const QString &text, bool numeric) {
+    auto *item = new QTableWidgetItem(text);
+    item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+    if (numeric) {
+        item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    return item;
+}
+
+ArchiveJobDialog::ArchiveJobDialog(QWidget *parent) : QDialog(parent) {
+    setWindowTitle("Archive Jobs");
+
+    table = new QTableWidget(this);
+    cancelButton = new QPushButton(this);
+    clearButton = new QPushButton(this);
+    closeButton = new QPushButton(this);
+    refreshTimer = new QTimer(this);
+
+    table->setColumnCount(COLUMNS.size());
+    table->setHorizontalHeaderLabels(COLUMNS);
+    table->verticalHeader()->hide();
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    table->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->setSelectionMode(QAbstractItemView::SingleSelection);
+
+    cancelButton->setText("Cancel Job");
+    clearButton->setText("Clear Completed");
+    closeButton->setText("Close");
+
+    auto *buttonLayout = new QHBoxLayout();
+    buttonLayout->addWidget(cancelButton);
+    buttonLayout->addWidget(clearButton);
+    buttonLayout->addStretch(1);
+    buttonLayout->addWidget(closeButton);
+
+    auto *layout = new QVBoxLayout();
+    layout->addWidget(table, 1);
+    layout->addLayout(buttonLayout);
+    setLayout(layout);
+
+    resize(640, 240);
+
+    refreshTimer->setInterval(250);
+
+    connect(cancelButton, SIGNAL(clicked(bool)), this, SLOT(onCancelPressed()));
+    connect(clearButton, SIGNAL(clicked(bool)), this, SLOT(onClearPressed()));
+    connect(closeButton, SIGNAL(clicked(bool)), this, SLOT(hide()));
+    connect(refreshTimer, SIGNAL(timeout()), this, SLOT(refresh()));
+}
+
+void ArchiveJobDialog::enqueue(ArchiveJobQueue::Job job) {
+    queue.enqueue(std::move(job));
+    refresh();
+    refreshTimer->start();
+    show();
+    raise();
+    activateWindow();
+}
+
+void ArchiveJobDialog::refresh() {
+    jobs = queue.getStatus();
+
+    table->setRowCount(static_cast<int>(jobs.size()));
+    for (auto row = 0; row < static_cast<int>(jobs.size()); row++) {
+        auto &job = jobs.at(row);
+
+        auto *progressBar = dynamic_cast<QProgressBar *>(table->cellWidget(row, 2));
+        if (progressBar == nullptr) {
+            progressBar = new QProgressBar(table);
+            table->setCellWidget(row, 2, progressBar);
+        }
+        progressBar->setRange(0, 1000);
+        progressBar->setValue(job.total > 0
+                              ? static_cast<int>(1000.0 * static_cast<double>(job.processed) / static_cast<double>(job.total))
+                              : 0);
+        progressBar->setFormat(formatBytes(static_cast<double>(job.processed))
+                               + " / "
+                               + formatBytes(static_cast<double>(job.total)));
+
+        auto status = getStateName(job.state);
+        if (job.state == ArchiveJobQueue::FAILED)
+            status += ": " + QString(job.error.c_str());
+
+        table->setItem(row, 0, createItem(job.description.c_str(), false));
+        table->setItem(row, 1, createItem(status, false));
+        table->setItem(row, 3, createItem(job.state == ArchiveJobQueue::RUNNING
+                                          ? formatBytes(job.throughput) + "/s"
+                                          : "", true));
+        table->setItem(row, 4, createItem(job.state == ArchiveJobQueue::RUNNING
+                                          ? formatTime(job.remainingTime)
+                                          : "", true));
+
+        if (job.state != ArchiveJobQueue::QUEUED
+            && job.state != ArchiveJobQueue::RUNNING
+            && reportedStates.find(job.id) == reportedStates.end()) {
+            reportedStates[job.id] = job.state;
+            emit jobCompleted(job.description.c_str(), job.state, job.error.c_str());
+        }
+    }
+
+    if (queue.isIdle()) {
+        // Refresh once more after the last job completed so that the final state is displayed.
+        bool allReported = std::all_of(jobs.begin(), jobs.end(), [this](const ArchiveJobQueue::Status &job) {
+            return reportedStates.find(job.id) != reportedStates.end();
+        });
+        if (allReported)
+            refreshTimer->stop();
+    }
+}
+
+void ArchiveJobDialog::onCancelPressed() {
+    auto row = table->currentRow();
+    if (row < 0 || row >= static_cast<int>(jobs.size()))
+        return;
+    queue.cancel(jobs.at(row).id);
+    refresh();
+}
+
+void ArchiveJobDialog::onClearPressed() {
+    queue.removeCompleted();
+    for (auto row = table->rowCount() - 1; row >= 0; row--) {
+        table->removeRow(row);
+    }
+    refresh();
+}
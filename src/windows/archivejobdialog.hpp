@@ -0,0 +1,72 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QCALC_ARCHIVEJOBDIALOG_HPP
+#define QCALC_ARCHIVEJOBDIALOG_HPP
+
+#include <QDialog>
+#include <QTableWidget>
+#include <QPushButton>
+#include <QTimer>
+
+#include <map>
+
+#include "io/archivejobqueue.hpp"
+
+/**
+ * Runs archive jobs in the background and displays their progress, throughput and remaining time.
+ */
+class ArchiveJobDialog : public QDialog {
+Q_OBJECT
+signals:
+
+    /**
+     * Emitted once when a job has finished, failed or was cancelled.
+     */
+    void jobCompleted(const QString &description, int state, const QString &error);
+
+public:
+    explicit ArchiveJobDialog(QWidget *parent = nullptr);
+
+    /**
+     * Queue the job and show the dialog.
+     */
+    void enqueue(ArchiveJobQueue::Job job);
+
+private slots:
+
+    void refresh();
+
+    void onCancelPressed();
+
+    void onClearPressed();
+
+private:
+    ArchiveJobQueue queue;
+    std::vector<ArchiveJobQueue::Status> jobs;
+    std::map<int, ArchiveJobQueue::State> reportedStates;
+
+    QTableWidget *table;
+    QPushButton *cancelButton;
+    QPushButton *clearButton;
+    QPushButton *closeButton;
+    QTimer *refreshTimer;
+};
+
+#endif //QCALC_ARCHIVEJOBDIALOG_HPP
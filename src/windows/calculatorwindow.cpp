@@ -22,6 +22,7 @@
 #include <filesystem>
 #include <string>
 #include <cstdlib>
+#include <algorithm>
 
 #include <QFile>
 #include <QMessageBox>
@@ -30,6 +31,9 @@
 #include <QApplication>
 #include <QInputDialog>
 #include <QCompleter>
+#include <QTimer>
+#include <QShortcut>
+#include <QHBoxLayout>
 
 #include "io/paths.hpp"
 #include "io/serializer.hpp"
@@ -40,6 +44,7 @@
 #include "settings/settingconstants.hpp"
 
 #include "calculator/expressionparser.hpp"
+#include "calculator/scriptwatchdog.hpp"
 
 #include "windows/settingsdialog.hpp"
 #include "windows/symbolseditorwindow.hpp"
@@ -53,7 +58,11 @@
 #include "python/interpreterhandler.hpp"
 
 static const int MAX_SYMBOL_TABLE_HISTORY = 100;
-static const int MAX_HISTORY = 1000;
+static const int MAX_HISTORY = 100000;
+
+static const char *const SYMBOL_TABLE_FILTER = "Symbol tables (*.json *.qcst)";
+static const char *const SYMBOL_TABLE_JSON_FILTER = "JSON symbol table (*.json)";
+static const char *const SYMBOL_TABLE_BINARY_FILTER = "Binary symbol table (*.qcst)";
 
 CalculatorWindow::CalculatorWindow(QWidget *parent) : QMainWindow(parent) {
     setObjectName("MainWindow");
@@ -61,6 +70,7 @@ CalculatorWindow::CalculatorWindow(QWidget *parent) : QMainWindow(parent) {
     loadSettings();
 
     addonManager = AddonManager(Paths::getAddonDirectory(),
+                                Paths::getAddonIndexFile(),
                                 [this](const std::string &module, const std::string &error) {
                                     return onAddonLoadFail(module, error);
                                 },
@@ -99,6 +109,7 @@ CalculatorWindow::CalculatorWindow(QWidget *parent) : QMainWindow(parent) {
     connect(actions.actionExtractArchive, SIGNAL(triggered(bool)), this, SLOT(onActionExtractArchive()));
     connect(actions.actionCreateAddonBundle, SIGNAL(triggered(bool)), this, SLOT(onActionCreateAddonBundle()));
     connect(actions.actionClearHistory, SIGNAL(triggered(bool)), this, SLOT(onActionClearHistory()));
+    connect(actions.actionSearchHistory, SIGNAL(triggered(bool)), this, SLOT(onActionSearchHistory()));
     connect(actions.actionAboutPython, SIGNAL(triggered(bool)), this, SLOT(onActionAboutPython()));
     connect(actions.actionNewSymbols, SIGNAL(triggered(bool)), this, SLOT(onActionNewSymbolTable()));
 
@@ -112,6 +123,20 @@ CalculatorWindow::CalculatorWindow(QWidget *parent) : QMainWindow(parent) {
             this,
             SLOT(onHistoryTextDoubleClicked(const QString &)));
 
+    connect(archiveJobDialog,
+            SIGNAL(jobCompleted(const QString &, int, const QString &)),
+            this,
+            SLOT(onArchiveJobCompleted(const QString &, int, const QString &)));
+
+    connect(searchEdit, SIGNAL(textChanged(const QString &)), this, SLOT(onSearchTextChanged(const QString &)));
+    connect(searchEdit, SIGNAL(returnPressed()), this, SLOT(onSearchAccepted()));
+    connect(searchPreviousButton, SIGNAL(clicked(bool)), this, SLOT(onSearchPrevious()));
+    connect(searchNextButton, SIGNAL(clicked(bool)), this, SLOT(onSearchNext()));
+
+    auto *closeSearchShortcut = new QShortcut(QKeySequence(Qt::Key_Escape), searchEdit);
+    closeSearchShortcut->setContext(Qt::WidgetShortcut);
+    connect(closeSearchShortcut, SIGNAL(activated()), this, SLOT(closeSearch()));
+
     applySettings();
 
     loadHistory();
@@ -126,12 +151,19 @@ CalculatorWindow::CalculatorWindow(QWidget *parent) : QMainWindow(parent) {
 
     setWindowIcon(QIcon(Paths::getCalculatorIconFile().c_str()));
 
-    InterpreterHandler::initialize([this]() {
-                                       runOnMainThread([this]() {
+    std::set<std::string> enabledAddons = loadEnabledAddons(Paths::getAddonsFile().c_str());
+
+    InterpreterHandler::initialize([this, enabledAddons]() {
+                                       runOnMainThread([this, enabledAddons]() {
                                                            terminalDialog->printOutput(
                                                                    "Initialized Python " + QString(Interpreter::getVersion().c_str()));
 
-                                                           std::set<std::string> enabledAddons = loadEnabledAddons(Paths::getAddonsFile().c_str());
+                                                           auto timeSaved = InterpreterHandler::getInitCheckTimeSaved();
+                                                           if (timeSaved > 0) {
+                                                               terminalDialog->printOutput(
+                                                                       "Used cached Python init check, saved "
+                                                                       + QString::number(timeSaved) + "ms");
+                                                           }
 
                                                            //Check for enabled addons which dont exist anymore.
                                                            std::set<std::string> availableAddons;
@@ -141,6 +173,7 @@ CalculatorWindow::CalculatorWindow(QWidget *parent) : QMainWindow(parent) {
                                                                    availableAddons.insert(addon);
                                                            }
 
+                                                           // Footer addons are loaded immediately if the window has already been shown
                                                            addonManager.setActiveAddons(availableAddons);
 
                                                            settingsDialog->setEnabledAddons(addonManager.getActiveAddons());
@@ -175,10 +208,18 @@ CalculatorWindow::CalculatorWindow(QWidget *parent) : QMainWindow(parent) {
                                                            terminalDialog->activateWindow();
                                                        },
                                                        Qt::AutoConnection);
-                                   });
+                                   },
+                                   addonManager.getPrefetchModules(enabledAddons));
 }
 
 CalculatorWindow::~CalculatorWindow() {
+    if (historyJournal) {
+        try {
+            historyIndex.save(Paths::getHistoryIndexFile(), getHistoryAccessor());
+        } catch (const std::exception &) {
+            // The index is rebuilt on the next start
+        }
+    }
     addonManager.setActiveAddons({});
     InterpreterHandler::finalize();
 }
@@ -189,6 +230,19 @@ void CalculatorWindow::closeEvent(QCloseEvent *event) {
 
 void CalculatorWindow::resizeEvent(QResizeEvent *event) {}
 
+void CalculatorWindow::showEvent(QShowEvent *event) {
+    QMainWindow::showEvent(event);
+    if (footerActivationScheduled)
+        return;
+    footerActivationScheduled = true;
+    // Defer activation until the window has been painted once
+    QTimer::singleShot(0, this, [this]() {
+        if (addonManager.activateOnShow()) {
+            settingsDialog->setEnabledAddons(addonManager.getActiveAddons());
+        }
+    });
+}
+
 void CalculatorWindow::onAddonLoadFail(const std::string &moduleName, const std::string &error) {
     QMessageBox::warning(this, "Failed to load module",
                          ("Module " + moduleName + " failed to load\n\n" + error).c_str());
@@ -373,7 +427,7 @@ void CalculatorWindow::onActionOpenSymbolTable() {
     dialog.setWindowTitle("Open symbol table...");
     dialog.setFileMode(QFileDialog::ExistingFile);
     dialog.setAcceptMode(QFileDialog::AcceptOpen);
-    dialog.setMimeTypeFilters({"application/json"});
+    dialog.setNameFilters({SYMBOL_TABLE_FILTER, SYMBOL_TABLE_JSON_FILTER, SYMBOL_TABLE_BINARY_FILTER});
 
     if (!dialog.exec()) {
         return;
@@ -408,7 +462,7 @@ void CalculatorWindow::onActionSaveAsSymbolTable() {
     dialog.setWindowTitle("Save symbol table as ...");
     dialog.setFileMode(QFileDialog::AnyFile);
     dialog.setAcceptMode(QFileDialog::AcceptSave);
-    dialog.setMimeTypeFilters({"application/json"});
+    dialog.setNameFilters({SYMBOL_TABLE_JSON_FILTER, SYMBOL_TABLE_BINARY_FILTER});
 
     if (!dialog.exec()) {
         return;
@@ -420,7 +474,13 @@ void CalculatorWindow::onActionSaveAsSymbolTable() {
         return;
     }
 
-    saveSymbolTable(list[0].toStdString());
+    // The format is selected by the file extension when saving
+    auto path = list[0].toStdString();
+    if (std::filesystem::path(path).extension().empty()) {
+        path += dialog.selectedNameFilter() == SYMBOL_TABLE_BINARY_FILTER ? ".qcst" : ".json";
+    }
+
+    saveSymbolTable(path);
 }
 
 void CalculatorWindow::onActionEditSymbolTable() {
@@ -463,8 +523,8 @@ void CalculatorWindow::onActionCompressDirectory() {
     dialog.setFileMode(QFileDialog::Directory);
 
     if (dialog.exec() == QFileDialog::Accepted) {
-        auto directory = dialog.selectedFiles().at(0);
-        auto directoryBase = std::filesystem::path(directory.toStdString()).parent_path().string();
+        auto directory = dialog.selectedFiles().at(0).toStdString();
+        auto directoryName = std::filesystem::path(directory).filename().string();
 
         dialog.setWindowTitle("Select output file...");
         dialog.setAcceptMode(QFileDialog::AcceptSave);
@@ -473,25 +533,29 @@ void CalculatorWindow::onActionCompressDirectory() {
 
         for (;;) {
             if (dialog.exec() == QFileDialog::Accepted) {
-                auto outputFile = dialog.selectedFiles().at(0);
-
-                Archive archive;
-                auto files = FileOperations::findFilesInDirectory(directory.toStdString(), "", true);
-                for (auto &file: files) {
-                    auto name = file.substr(directoryBase.size() + 1);
-                    archive.addEntry(name, FileOperations::fileReadAllVector(file));
-                }
+                auto outputFile = dialog.selectedFiles().at(0).toStdString();
 
+                Archive::Format format;
+                Archive::CompressionOptions options;
                 try {
-                    auto format = Archive::getFormatFromExtension(
-                            std::filesystem::path(outputFile.toStdString()).extension().string());
-                    archive.save(outputFile.toStdString(), format);
-                    QMessageBox::information(this, "Compression successful",
-                                             "Successfully compressed " + directory + " to " + outputFile);
-                    break;
+                    format = Archive::getFormatFromFilename(outputFile);
+                    options.compression = Archive::getCompressionFromFilename(outputFile);
                 } catch (const std::exception &e) {
                     QMessageBox::warning(this, "Compression failed", "Failed to save file: " + QString(e.what()));
+                    continue;
                 }
+
+                ArchiveJobQueue::Job job;
+                job.description = "Compress " + directory + " to " + outputFile;
+                job.outputFile = outputFile;
+                job.run = [directory, directoryName, outputFile, format, options](
+                        const Archive::ProgressCallback &progress) {
+                    Archive archive;
+                    archive.addDirectory(directoryName, directory);
+                    archive.save(outputFile, format, options, progress);
+                };
+                archiveJobDialog->enqueue(std::move(job));
+                break;
             } else {
                 QMessageBox::information(this, "Compression cancelled", "The compression has been cancelled.");
                 break;
@@ -510,25 +574,21 @@ void CalculatorWindow::onActionExtractArchive() {
     dialog.setMimeTypeFilters(Archive::getFormatMimeTypes());
 
     if (dialog.exec() == QFileDialog::Accepted) {
-        auto archiveFile = dialog.selectedFiles().at(0);
+        auto archiveFile = dialog.selectedFiles().at(0).toStdString();
         dialog.setWindowTitle("Select output directory...");
         dialog.setAcceptMode(QFileDialog::AcceptSave);
         dialog.setFileMode(QFileDialog::Directory);
         dialog.setMimeTypeFilters({});
 
         if (dialog.exec() == QFileDialog::Accepted) {
-            auto targetDirectory = dialog.selectedFiles()[0];
-            try {
-                Archive::extractToDisk(archiveFile.toStdString(),
-                                       targetDirectory.toStdString(),
-                                       [](const std::string &str) {});
-                QMessageBox::information(this, "Extraction successful",
-                                         "Successfully extracted " + archiveFile + " to " + targetDirectory);
-            } catch (const std::exception &e) {
-                QMessageBox::warning(this,
-                                     "Extraction failed",
-                                     e.what());
-            }
+            auto targetDirectory = dialog.selectedFiles()[0].toStdString();
+
+            ArchiveJobQueue::Job job;
+            job.description = "Extract " + archiveFile + " to " + targetDirectory;
+            job.run = [archiveFile, targetDirectory](const Archive::ProgressCallback &progress) {
+                Archive::extractToDisk(archiveFile, targetDirectory, progress);
+            };
+            archiveJobDialog->enqueue(std::move(job));
         } else {
             QMessageBox::information(this, "Extraction cancelled", "The extraction has been cancelled.");
         }
@@ -590,21 +650,29 @@ void CalculatorWindow::onActionCreateAddonBundle() {
 
     for (;;) {
         if (dialog.exec() == QFileDialog::Accepted) {
-            auto outputFile = dialog.selectedFiles().at(0);
-            auto outputPath = std::filesystem::path(outputFile.toStdString());
+            auto outputFile = dialog.selectedFiles().at(0).toStdString();
+
+            Archive::Format format;
+            Archive::CompressionOptions options;
             try {
-                auto format = Archive::getFormatFromExtension(outputPath.extension().string());
-                auto archive = AddonManager::createInstallableBundle(bundleEntries);
-                archive.save(outputFile.toStdString(), format);
-                QMessageBox::information(this,
-                                         "Saving successful",
-                                         "Successfully saved addon bundle to " + outputFile);
-                break;
-            } catch (std::runtime_error &e) {
+                format = Archive::getFormatFromFilename(outputFile);
+                options.compression = Archive::getCompressionFromFilename(outputFile);
+            } catch (const std::exception &e) {
                 QMessageBox::warning(this,
                                      "Saving failed",
                                      (std::string("Failed to save addon bundle: ") + e.what()).c_str());
+                continue;
             }
+
+            ArchiveJobQueue::Job job;
+            job.description = "Create addon bundle " + outputFile;
+            job.outputFile = outputFile;
+            job.run = [bundleEntries, outputFile, format, options](const Archive::ProgressCallback &progress) {
+                auto archive = AddonManager::createInstallableBundle(bundleEntries);
+                archive.save(outputFile, format, options, progress);
+            };
+            archiveJobDialog->enqueue(std::move(job));
+            break;
         } else {
             QMessageBox::information(this, "Cancelled saving", "Saving was cancelled.");
             break;
@@ -612,6 +680,14 @@ void CalculatorWindow::onActionCreateAddonBundle() {
     }
 }
 
+void CalculatorWindow::onArchiveJobCompleted(const QString &description, int state, const QString &error) {
+    if (state == ArchiveJobQueue::FINISHED) {
+        QMessageBox::information(this, "Archive job finished", "Successfully completed: " + description);
+    } else if (state == ArchiveJobQueue::FAILED) {
+        QMessageBox::warning(this, "Archive job failed", description + " failed: " + error);
+    }
+}
+
 const SymbolTable &CalculatorWindow::getSymbolTable() {
     return symbolTable;
 }
@@ -646,6 +722,10 @@ void CalculatorWindow::onSettingsAccepted() {
 
     settings.update(SETTING_PYTHON_MODULE_PATHS.key, settingsDialog->getPythonModPaths());
     settings.update(SETTING_PYTHON_PATH.key, settingsDialog->getPythonPath());
+    settings.update(SETTING_CONSOLE_SCROLLBACK.key, settingsDialog->getConsoleScrollback());
+    settings.update(SETTING_SCRIPT_CALL_BUDGET.key, settingsDialog->getScriptCallBudget());
+    settings.update(SETTING_EVALUATION_BUDGET.key, settingsDialog->getEvaluationBudget());
+    settings.update(SETTING_SCRIPT_WORKERS.key, settingsDialog->getScriptWorkers());
 
     saveSettings();
     saveHistory();
@@ -664,6 +744,12 @@ void CalculatorWindow::onSettingsAccepted() {
     decimal::context.round(settings.value(SETTING_ROUNDING).toInt());
     decimal::context.emax(settings.value(SETTING_EXPONENT_MAX).toInt());
     decimal::context.emin(settings.value(SETTING_EXPONENT_MIN).toInt());
+    ExprtkModule::setContext(decimal::context);
+
+    terminalDialog->setScrollbackLimit(settings.value(SETTING_CONSOLE_SCROLLBACK).toInt());
+
+    ScriptWatchdog::setCallBudget(settings.value(SETTING_SCRIPT_CALL_BUDGET).toInt());
+    ScriptWatchdog::setEvaluationBudget(settings.value(SETTING_EVALUATION_BUDGET).toInt());
 
     saveEnabledAddons(settingsDialog->getEnabledAddons());
 
@@ -684,6 +770,10 @@ void CalculatorWindow::onSettingsCancelled() {
 
     settingsDialog->setPythonModPaths(settings.value(SETTING_PYTHON_MODULE_PATHS).toStringList());
     settingsDialog->setPythonPath(settings.value(SETTING_PYTHON_PATH).toString());
+    settingsDialog->setConsoleScrollback(settings.value(SETTING_CONSOLE_SCROLLBACK).toInt());
+    settingsDialog->setScriptCallBudget(settings.value(SETTING_SCRIPT_CALL_BUDGET).toInt());
+    settingsDialog->setEvaluationBudget(settings.value(SETTING_EVALUATION_BUDGET).toInt());
+    settingsDialog->setScriptWorkers(settings.value(SETTING_SCRIPT_WORKERS).toInt());
 
     settingsDialog->setEnabledAddons(addonManager.getActiveAddons());
 }
@@ -691,7 +781,14 @@ void CalculatorWindow::onSettingsCancelled() {
 void CalculatorWindow::onActionClearHistory() {
     if (QMessageBox::question(this, "Clear History", "Do you want to clear the history?") == QMessageBox::Yes) {
         history.clear();
+        historyIndex.clear();
         historyWidget->clear();
+        if (searchContainer->isVisible()) {
+            onSearchTextChanged(searchEdit->text());
+        }
+        if (historyJournal) {
+            historyJournal->clear();
+        }
     }
 }
 
@@ -733,37 +830,43 @@ void CalculatorWindow::insertInputText(const QString &v) {
 }
 
 QString CalculatorWindow::evaluateExpression(const QString &expression) {
+    QString ret;
+    auto exprSymbols = symbolTable;
     try {
         decimal::context.clear_status();
 
-        auto exprSymbols = symbolTable;
+        if (addonManager.activateForExpression(expression.toStdString())) {
+            settingsDialog->setEnabledAddons(addonManager.getActiveAddons());
+        }
+
         auto v = ExpressionParser::evaluate(expression.toStdString(), exprSymbols);
 
-        QString ret = v.format("f").c_str();
+        ret = v.format("f").c_str();
+    } catch (const std::exception &e) {
+        inputMessage->setText(e.what());
+        return "";
+    }
 
-        history.emplace_back(std::make_pair(expression.toStdString(), ret.toStdString()));
-        saveHistory();
+    if (!exprSymbols.equals(symbolTable)) {
+        onSymbolTableChanged(exprSymbols);
+    }
 
-        if (!exprSymbols.equals(symbolTable)) {
-            onSymbolTableChanged(exprSymbols);
-        }
+    // Journal failures are reported by appendHistory and do not discard the evaluation
+    appendHistory(expression.toStdString(), ret.toStdString());
 
-        emit signalExpressionEvaluated(expression, ret);
+    emit signalExpressionEvaluated(expression, ret);
 
-        input->update();
+    input->update();
 
-        return ret;
-    } catch (const std::exception &e) {
-        inputMessage->setText(e.what());
-    }
-    return "";
+    return ret;
 }
 
 void CalculatorWindow::loadSettings() {
     std::string settingsFilePath = Paths::getSettingsFile();
     if (QFile(settingsFilePath.c_str()).exists()) {
         try {
-            settings = Serializer::deserializeSettings(FileOperations::fileReadAll(settingsFilePath));
+            FileOperations::MappedFile file(settingsFilePath);
+            settings = Serializer::deserializeSettings(file.view());
         } catch (const std::runtime_error &e) {
             QMessageBox::warning(this, "Failed to load settings", e.what());
             settings = {};
@@ -805,6 +908,12 @@ void CalculatorWindow::applySettings() {
     decimal::context.round(settings.value(SETTING_ROUNDING).toInt());
     decimal::context.emax(settings.value(SETTING_EXPONENT_MAX).toInt());
     decimal::context.emin(settings.value(SETTING_EXPONENT_MIN).toInt());
+    ExprtkModule::setContext(decimal::context);
+
+    terminalDialog->setScrollbackLimit(settings.value(SETTING_CONSOLE_SCROLLBACK).toInt());
+
+    ScriptWatchdog::setCallBudget(settings.value(SETTING_SCRIPT_CALL_BUDGET).toInt());
+    ScriptWatchdog::setEvaluationBudget(settings.value(SETTING_EVALUATION_BUDGET).toInt());
 
     symbolsDialog->setSymbols(symbolTable, symbolsModified, currentSymbolTablePath);
 
@@ -819,12 +928,17 @@ void CalculatorWindow::applySettings() {
 
     settingsDialog->setPythonModPaths(settings.value(SETTING_PYTHON_MODULE_PATHS).toStringList());
     settingsDialog->setPythonPath(settings.value(SETTING_PYTHON_PATH).toString());
+    settingsDialog->setConsoleScrollback(settings.value(SETTING_CONSOLE_SCROLLBACK).toInt());
+    settingsDialog->setScriptCallBudget(settings.value(SETTING_SCRIPT_CALL_BUDGET).toInt());
+    settingsDialog->setEvaluationBudget(settings.value(SETTING_EVALUATION_BUDGET).toInt());
+    settingsDialog->setScriptWorkers(settings.value(SETTING_SCRIPT_WORKERS).toInt());
 }
 
 std::set<std::string> CalculatorWindow::loadEnabledAddons(const QString &enabledAddonsFilePath) {
     if (QFile(enabledAddonsFilePath).exists()) {
         try {
-            return Serializer::deserializeSet(FileOperations::fileReadAll(enabledAddonsFilePath.toStdString()));
+            FileOperations::MappedFile file(enabledAddonsFilePath.toStdString());
+            return Serializer::deserializeSet(file.view());
         }
         catch (const std::runtime_error &e) {
             QMessageBox::warning(this, "Failed to load enabled addons", e.what());
@@ -978,6 +1092,11 @@ void CalculatorWindow::setupMenuBar() {
     actions.actionClearHistory->setObjectName("actions.actionClearHistory");
     actions.actionClearHistory->setShortcut(QKeySequence(Qt::CTRL + Qt::Key_X));
 
+    actions.actionSearchHistory = new QAction(this);
+    actions.actionSearchHistory->setText("Search History");
+    actions.actionSearchHistory->setObjectName("actions.actionSearchHistory");
+    actions.actionSearchHistory->setShortcut(QKeySequence(Qt::CTRL + Qt::Key_R));
+
     actions.actionAboutPython = new QAction(this);
     actions.actionAboutPython->setText("About Python");
     actions.actionAboutPython->setObjectName("actions.actionAboutPython");
@@ -995,6 +1114,7 @@ void CalculatorWindow::setupMenuBar() {
 
     actions.menuFile->addAction(actions.actionSettings);
     actions.menuFile->addSeparator();
+    actions.menuFile->addAction(actions.actionSearchHistory);
     actions.menuFile->addAction(actions.actionClearHistory);
     actions.menuFile->addSeparator();
     actions.menuFile->addAction(actions.actionExit);
@@ -1022,6 +1142,29 @@ void CalculatorWindow::setupLayout() {
 
     historyWidget = new HistoryWidget(this);
     historyWidget->setObjectName("widget_history");
+    historyWidget->setMaxEntries(MAX_HISTORY);
+
+    searchContainer = new QWidget(this);
+    searchEdit = new QLineEdit(searchContainer);
+    searchLabel = new QLabel(searchContainer);
+    searchPreviousButton = new QPushButton(searchContainer);
+    searchNextButton = new QPushButton(searchContainer);
+
+    searchEdit->setObjectName("lineEdit_search");
+    searchEdit->setPlaceholderText("Search history...");
+    searchPreviousButton->setText("Previous");
+    searchPreviousButton->setToolTip("Older match (Ctrl+R)");
+    searchNextButton->setText("Next");
+    searchNextButton->setToolTip("Newer match");
+
+    auto *searchLayout = new QHBoxLayout();
+    searchLayout->setContentsMargins(8, 4, 8, 4);
+    searchLayout->addWidget(searchEdit, 1);
+    searchLayout->addWidget(searchLabel);
+    searchLayout->addWidget(searchPreviousButton);
+    searchLayout->addWidget(searchNextButton);
+    searchContainer->setLayout(searchLayout);
+    searchContainer->setVisible(false);
 
     input = new QLineEdit(this);
     input->setObjectName("lineEdit_input");
@@ -1049,6 +1192,7 @@ void CalculatorWindow::setupLayout() {
     line->setFrameShadow(QFrame::Raised);
 
     l->addWidget(historyWidget);
+    l->addWidget(searchContainer);
     l->addWidget(line);
     l->addWidget(input);
     l->addWidget(inputMessage);
@@ -1064,12 +1208,6 @@ void CalculatorWindow::setupLayout() {
 
     rootWidget->setLayout(l);
 
-    auto *footerWidget = new QWidget(this);
-    footerWidget->setLayout(new QVBoxLayout);
-    footerWidget->setObjectName("footerWidget");
-    footerWidget->hide();
-    l->addWidget(footerWidget);
-
     setCentralWidget(rootWidget);
 
     completerModel = new QStringListModel();
@@ -1088,6 +1226,7 @@ void CalculatorWindow::setupDialogs() {
     symbolsDialog = new SymbolsEditorWindow(symbolTable, actions);
     terminalDialog = new PythonConsoleWindow(actions);
     settingsDialog = new SettingsDialog(addonManager, this);
+    archiveJobDialog = new ArchiveJobDialog(this);
 
     connect(symbolsDialog,
             SIGNAL(symbolsChanged(const SymbolTable &)),
@@ -1125,7 +1264,8 @@ void CalculatorWindow::updateSymbolHistoryMenu() {
 
 bool CalculatorWindow::loadSymbolTable(const std::string &path) {
     try {
-        auto syms = Serializer::deserializeTable(FileOperations::fileReadAll(path));
+        FileOperations::MappedFile file(path);
+        auto syms = Serializer::deserializeTable(file.view());
 
         std::set<std::string> addons = addonManager.getActiveAddons();
         addonManager.setActiveAddons({});
@@ -1154,7 +1294,10 @@ bool CalculatorWindow::loadSymbolTable(const std::string &path) {
 
 bool CalculatorWindow::saveSymbolTable(const std::string &path) {
     try {
-        FileOperations::fileWriteAll(path, Serializer::serializeTable(symbolTable));
+        auto data = Serializer::isBinaryTableFilename(path)
+                    ? Serializer::serializeTableBinary(symbolTable)
+                    : Serializer::serializeTable(symbolTable);
+        FileOperations::fileWriteAll(path, data);
 
         removeSymbolTablePath(path);
         symbolTablePathHistory.insert(symbolTablePathHistory.begin(), path);
@@ -1181,41 +1324,152 @@ bool CalculatorWindow::saveSymbolTable(const std::string &path) {
 }
 
 void CalculatorWindow::saveHistory() {
-    if (!settings.value(SETTING_SAVE_HISTORY).toInt() || history.empty())
+    if (!settings.value(SETTING_SAVE_HISTORY).toInt()) {
+        historyJournal.reset();
+        return;
+    }
+    if (historyJournal)
         return;
-    std::string outputStr;
-    auto counter = 0;
-    const auto counterMax = MAX_HISTORY;
-    for (auto it = history.rbegin(); it != history.rend() && counter < counterMax; it++, counter++) {
-        auto &pair = *it;
-        std::string str = pair.first + "\n" + pair.second + "\n";
-        outputStr += str;
+    historyJournal = std::make_unique<HistoryJournal>(Paths::getHistoryJournalFile(), MAX_HISTORY);
+    if (!history.empty()) {
+        historyJournal->replace(std::vector<HistoryJournal::Entry>(history.begin(), history.end()));
     }
-    FileOperations::fileWriteAll(Paths::getHistoryFile(), outputStr);
 }
 
 void CalculatorWindow::loadHistory() {
     if (!settings.value(SETTING_SAVE_HISTORY).toInt())
         return;
-    if (std::filesystem::exists(Paths::getHistoryFile())) {
-        auto str = FileOperations::fileReadAll(Paths::getHistoryFile());
 
+    historyJournal = std::make_unique<HistoryJournal>(Paths::getHistoryJournalFile(), MAX_HISTORY);
+
+    std::vector<HistoryJournal::Entry> entries;
+    if (!std::filesystem::exists(Paths::getHistoryJournalFile())
+        && std::filesystem::exists(Paths::getHistoryFile())) {
+        // Convert the history file of previous versions which stores the newest entry first
+        auto str = FileOperations::fileReadAll(Paths::getHistoryFile());
         std::vector<std::string> lines = StringUtil::splitString(str, '\n');
         for (auto i = 0; lines.size() > 1 && i < lines.size() - 1; i += 2) {
-            auto line = lines.at(i);
-            auto nextLine = lines.at(i + 1);
+            auto &line = lines.at(i);
+            auto &nextLine = lines.at(i + 1);
             if (!line.empty() && !nextLine.empty()) {
-                history.insert(history.begin(), std::make_pair(line, nextLine));
+                entries.emplace_back(line, nextLine);
             }
         }
+        std::reverse(entries.begin(), entries.end());
+        historyJournal->replace(entries);
+        std::filesystem::remove(Paths::getHistoryFile());
+    } else {
+        entries = historyJournal->load();
+    }
 
-        historyWidget->clear();
-        for (auto &pair: history) {
-            historyWidget->addContent(pair.first.c_str(), pair.second.c_str());
+    history = std::deque<std::pair<std::string, std::string>>(entries.begin(), entries.end());
+
+    if (!historyIndex.load(Paths::getHistoryIndexFile(), history.size(), getHistoryAccessor())) {
+        historyIndex.rebuild(history.size(), getHistoryAccessor());
+    }
+
+    std::vector<HistoryModel::Entry> modelEntries;
+    modelEntries.reserve(history.size());
+    for (auto &pair: history) {
+        modelEntries.emplace_back(HistoryModel::Entry{pair.first.c_str(), pair.second.c_str()});
+    }
+    historyWidget->setContent(modelEntries);
+}
+
+void CalculatorWindow::appendHistory(const std::string &expression, const std::string &result) {
+    history.emplace_back(expression, result);
+    historyIndex.append(expression, result);
+    if (history.size() > static_cast<size_t>(MAX_HISTORY)) {
+        history.pop_front();
+        historyIndex.removeFront(1);
+    }
+    if (searchContainer->isVisible()) {
+        onSearchTextChanged(searchEdit->text());
+    }
+    if (historyJournal) {
+        std::string error;
+        try {
+            historyJournal->append(expression, result);
+            error = historyJournal->takeError();
+        } catch (const std::exception &e) {
+            error = e.what();
+        }
+        if (!error.empty()) {
+            // Shown after the evaluation has completed
+            QTimer::singleShot(0, this, [this, error]() {
+                QMessageBox::warning(this, "Failed to save history", error.c_str());
+            });
         }
     }
 }
 
+HistoryIndex::Accessor CalculatorWindow::getHistoryAccessor() const {
+    return [this](size_t position) -> const HistoryIndex::Entry & {
+        return history.at(position);
+    };
+}
+
+void CalculatorWindow::onActionSearchHistory() {
+    if (searchContainer->isVisible() && searchEdit->hasFocus()) {
+        onSearchPrevious();
+        return;
+    }
+    searchContainer->setVisible(true);
+    searchEdit->setFocus();
+    searchEdit->selectAll();
+    onSearchTextChanged(searchEdit->text());
+}
+
+void CalculatorWindow::onSearchTextChanged(const QString &text) {
+    searchMatches = historyIndex.find(text.toStdString(), getHistoryAccessor());
+    searchMatch = searchMatches.empty() ? 0 : searchMatches.size() - 1;
+    historyWidget->setHighlightedRows(std::vector<int>(searchMatches.begin(), searchMatches.end()));
+    showSearchMatch();
+}
+
+void CalculatorWindow::onSearchPrevious() {
+    if (searchMatches.empty())
+        return;
+    searchMatch = searchMatch == 0 ? searchMatches.size() - 1 : searchMatch - 1;
+    showSearchMatch();
+}
+
+void CalculatorWindow::onSearchNext() {
+    if (searchMatches.empty())
+        return;
+    searchMatch = searchMatch + 1 >= searchMatches.size() ? 0 : searchMatch + 1;
+    showSearchMatch();
+}
+
+void CalculatorWindow::onSearchAccepted() {
+    if (searchMatches.empty())
+        return;
+    auto expression = history.at(searchMatches.at(searchMatch)).first;
+    closeSearch();
+    onHistoryTextDoubleClicked(expression.c_str());
+}
+
+void CalculatorWindow::closeSearch() {
+    searchContainer->setVisible(false);
+    searchMatches.clear();
+    searchMatch = 0;
+    historyWidget->setHighlightedRows({});
+    historyWidget->setCurrentRow(-1);
+    input->setFocus();
+}
+
+void CalculatorWindow::showSearchMatch() {
+    if (searchMatches.empty()) {
+        searchLabel->setText(searchEdit->text().isEmpty() ? "" : "No matches");
+        historyWidget->setCurrentRow(-1);
+        return;
+    }
+    searchLabel->setText(QString::number(searchMatches.size() - searchMatch)
+                         + " of "
+                         + QString::number(searchMatches.size()));
+    historyWidget->setCurrentRow(static_cast<int>(searchMatches.at(searchMatch)));
+}
+
 void CalculatorWindow::clearResultFromInputText() {
     if (inputTextContainsExpressionResult) {
         inputTextContainsExpressionResult = false;
@@ -27,9 +27,13 @@
 #include <QComboBox>
 
 #include <bitset>
+#include <deque>
+#include <memory>
 #include <set>
 
 #include "addon/addonmanager.hpp"
+#include "io/historyjournal.hpp"
+#include "io/historyindex.hpp"
 #include "settings/settings.hpp"
 
 #include "calculator/symboltable.hpp"
@@ -40,6 +44,7 @@
 #include "windows/symbolseditorwindow.hpp"
 #include "windows/pythonconsolewindow.hpp"
 #include "windows/settingsdialog.hpp"
+#include "windows/archivejobdialog.hpp"
 #include "windows/calculatorwindowactions.hpp"
 
 class CalculatorWindow : public QMainWindow {
@@ -54,6 +59,8 @@ public:
 
     void resizeEvent(QResizeEvent *event) override;
 
+    void showEvent(QShowEvent *event) override;
+
     void onAddonLoadFail(const std::string &moduleName, const std::string &error);
 
     void onAddonUnloadFail(const std::string &moduleName, const std::string &error);
@@ -104,6 +111,8 @@ public slots:
 
     void onActionCreateAddonBundle();
 
+    void onArchiveJobCompleted(const QString &description, int state, const QString &error);
+
     void onHistoryTextDoubleClicked(const QString &text);
 
     void onSettingsAccepted();
@@ -112,6 +121,18 @@ public slots:
 
     void onActionClearHistory();
 
+    void onActionSearchHistory();
+
+    void onSearchTextChanged(const QString &text);
+
+    void onSearchPrevious();
+
+    void onSearchNext();
+
+    void onSearchAccepted();
+
+    void closeSearch();
+
     void onActionNewSymbolTable();
 
     void insertInputText(const QString &text);
@@ -157,10 +178,20 @@ private:
 
     bool saveSymbolTable(const std::string &path);
 
+    /**
+     * Open the history journal if saving the history is enabled, or close it if saving is disabled.
+     * When the journal is opened it is replaced with the current history.
+     */
     void saveHistory();
 
     void loadHistory();
 
+    void appendHistory(const std::string &expression, const std::string &result);
+
+    HistoryIndex::Accessor getHistoryAccessor() const;
+
+    void showSearchMatch();
+
     void clearResultFromInputText();
 
     void runOnMainThread(const std::function<void()> &func, Qt::ConnectionType type);
@@ -173,9 +204,16 @@ private:
     QLineEdit *input{};
     QLabel *inputMessage{};
 
+    QWidget *searchContainer{};
+    QLineEdit *searchEdit{};
+    QLabel *searchLabel{};
+    QPushButton *searchPreviousButton{};
+    QPushButton *searchNextButton{};
+
     PythonConsoleWindow *terminalDialog = nullptr;
     SymbolsEditorWindow *symbolsDialog = nullptr;
     SettingsDialog *settingsDialog = nullptr;
+    ArchiveJobDialog *archiveJobDialog = nullptr;
 
     AddonManager addonManager;
 
@@ -188,7 +226,11 @@ private:
     std::vector<std::string> symbolTablePathHistory;
     std::string currentSymbolTablePath; // If the currently active symboltable was loaded from a file or saved to a file this path contains the path of the symbol table file.
 
-    std::vector<std::pair<std::string, std::string>> history;
+    std::deque<std::pair<std::string, std::string>> history;
+    std::unique_ptr<HistoryJournal> historyJournal;
+    HistoryIndex historyIndex;
+    std::vector<size_t> searchMatches;
+    size_t searchMatch = 0;
 
     bool inputTextContainsExpressionResult = false;
     int inputTextHistoryIndex = 0;
@@ -201,6 +243,8 @@ private:
     QString completerWord;
 
     bool symbolsModified = false;
+
+    bool footerActivationScheduled = false;
 };
 
 #endif // QCALC_MAINWINDOW_HPP
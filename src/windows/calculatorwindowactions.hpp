@@ -28,6 +28,7 @@ struct CalculatorWindowActions {
     QAction *actionExit{};
 
     QAction *actionClearHistory{};
+    QAction *actionSearchHistory{};
 
     QAction *actionOpenTerminal{};
 
@@ -24,11 +24,13 @@
 #include <QAction>
 #include <QMenu>
 #include <QMenuBar>
+#include <QStatusBar>
 
 #include "widgets/terminalwidget.hpp"
 #include "windows/calculatorwindowactions.hpp"
 
 #include "python/interpreter.hpp"
+#include "python/codecache.hpp"
 
 #include "io/paths.hpp"
 
@@ -60,6 +62,8 @@ public:
         setWindowTitle("Python Console");
 
         setWindowIcon(QIcon(Paths::getTerminalIconFile().c_str()));
+
+        updateCodeCacheStatistics();
     }
 
 signals:
@@ -76,12 +80,27 @@ public slots:
         term->printOutput(out);
     }
 
+    void setScrollbackLimit(int lines) {
+        term->setScrollbackLimit(lines);
+    }
+
 private slots:
 
     void onTerminalReturnPressed() {
         term->printOutput(">>> " + term->getInputText() + "\n");
         emit evaluatePython(term->getInputText().toStdString(), term->getMultiLineInput() ? Interpreter::FILE_INPUT : Interpreter::SINGLE_INPUT);
         term->setInputText("");
+        updateCodeCacheStatistics();
+    }
+
+    void updateCodeCacheStatistics() {
+        auto stats = CodeCache::getStatistics();
+        statusBar()->showMessage("Code cache: "
+                                 + QString::number(stats.entries) + "/" + QString::number(CodeCache::CAPACITY)
+                                 + " entries, "
+                                 + QString::number(stats.hits) + " hits, "
+                                 + QString::number(stats.misses) + " misses ("
+                                 + QString::number(stats.hitRate() * 100, 'f', 1) + "% hit rate)");
     }
 
 private:
@@ -24,7 +24,6 @@
 #include <QHBoxLayout>
 #include <QFileDialog>
 
-#include <fstream>
 
 #include "windows/addoninstalldialog.hpp"
 
@@ -173,6 +172,38 @@ std::string SettingsDialog::getPythonPath() {
     return pythonTab->getPythonPath();
 }
 
+void SettingsDialog::setConsoleScrollback(int lines) {
+    pythonTab->setConsoleScrollback(lines);
+}
+
+int SettingsDialog::getConsoleScrollback() {
+    return pythonTab->getConsoleScrollback();
+}
+
+void SettingsDialog::setScriptCallBudget(int milliseconds) {
+    pythonTab->setScriptCallBudget(milliseconds);
+}
+
+int SettingsDialog::getScriptCallBudget() {
+    return pythonTab->getScriptCallBudget();
+}
+
+void SettingsDialog::setEvaluationBudget(int milliseconds) {
+    pythonTab->setEvaluationBudget(milliseconds);
+}
+
+int SettingsDialog::getEvaluationBudget() {
+    return pythonTab->getEvaluationBudget();
+}
+
+void SettingsDialog::setScriptWorkers(int workers) {
+    pythonTab->setScriptWorkers(workers);
+}
+
+int SettingsDialog::getScriptWorkers() {
+    return pythonTab->getScriptWorkers();
+}
+
 void SettingsDialog::onModuleEnableChanged(AddonItemWidget *item) {
     std::string name = item->getModuleName().toStdString();
     bool enabled = item->getModuleEnabled();
@@ -235,8 +266,7 @@ void SettingsDialog::onInstallAddonPressed() {
         auto file = d->selectedFiles().first().toStdString();
         delete d;
         try {
-            std::ifstream ifs(file);
-            auto installedAddonCount = addonManager.installAddonBundle(ifs,
+            auto installedAddonCount = addonManager.installAddonBundle(file,
                                                                        [this](const std::string &title,
                                                                               const std::string &text,
                                                                               std::vector<std::string> &value) {
@@ -79,6 +79,22 @@ public:
 
     std::string getPythonPath();
 
+    void setConsoleScrollback(int lines);
+
+    int getConsoleScrollback();
+
+    void setScriptCallBudget(int milliseconds);
+
+    int getScriptCallBudget();
+
+    void setEvaluationBudget(int milliseconds);
+
+    int getEvaluationBudget();
+
+    void setScriptWorkers(int workers);
+
+    int getScriptWorkers();
+
 private slots:
 
     void onModuleEnableChanged(AddonItemWidget *item);
@@ -0,0 +1,136 @@
+/**
+ *  QCalc - Extensible programming calculator
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/**
+ * Checks that archives which contain only files, only in memory entries, or a directory tree
+ * can be saved and read back.
+ * Archive::save used to wait forever for the directory traversal when no directory was added.
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+
+#include "io/archive.hpp"
+#include "io/archivereader.hpp"
+
+static void writeFile(const std::filesystem::path &path, const std::string &contents) {
+    std::ofstream stream(path, std::ios::binary);
+    stream.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+}
+
+static void check(bool condition, const std::string &message) {
+    if (!condition)
+        throw std::runtime_error(message);
+}
+
+static std::string withoutTrailingSlash(std::string path) {
+    if (!path.empty() && path.back() == '/')
+        path.pop_back();
+    return path;
+}
+
+int main() {
+    auto directory = std::filesystem::temp_directory_path() / "qcalc_archivetest";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    try {
+        std::string small = "print('addon')\n";
+        std::string large(3 * 1024 * 1024 + 17, 'x');
+        writeFile(directory / "addon.py", small);
+        writeFile(directory / "data.bin", large);
+
+        auto filesOnly = (directory / "files.tar").string();
+        Archive files;
+        files.addFile("addon.py", (directory / "addon.py").string());
+        files.addFile("data/data.bin", (directory / "data.bin").string());
+        files.save(filesOnly, Archive::getFormatFromFilename(filesOnly));
+
+        ArchiveReader filesReader(filesOnly);
+        check(filesReader.readEntry("addon.py") == small, "addon.py does not match");
+        check(filesReader.readEntry("data/data.bin") == large, "data/data.bin does not match");
+
+        auto entriesOnly = (directory / "entries.tar").string();
+        Archive entries;
+        entries.addEntry("addon_bundle.json", {'{', '}'});
+        entries.save(entriesOnly, Archive::getFormatFromFilename(entriesOnly));
+
+        ArchiveReader entriesReader(entriesOnly);
+        check(entriesReader.readEntry("addon_bundle.json") == "{}", "addon_bundle.json does not match");
+
+        // The large file spans several blocks of the file stream, the pattern detects reordered blocks
+        std::string pattern;
+        for (size_t i = 0; i < 5 * 1024 * 1024 + 3; i++) {
+            pattern.push_back(static_cast<char>((i * 31 + i / 4096) % 251));
+        }
+        auto tree = directory / "tree";
+        std::filesystem::create_directories(tree / "lib" / "nested");
+        std::filesystem::create_directories(tree / "lib" / "empty");
+        writeFile(tree / "addon.py", small);
+        writeFile(tree / "lib" / "nested" / "pattern.bin", pattern);
+        writeFile(tree / "lib" / "nested" / "empty.txt", "");
+
+        std::map<std::string, std::string> expectedFiles = {
+                {"tree/addon.py", small},
+                {"tree/lib/nested/pattern.bin", pattern},
+                {"tree/lib/nested/empty.txt", ""}
+        };
+        std::set<std::string> expectedDirectories = {"tree", "tree/lib", "tree/lib/nested", "tree/lib/empty"};
+
+        auto directoryArchive = (directory / "directory.tar").string();
+        Archive directoryEntries;
+        directoryEntries.addDirectory("tree", tree.string());
+        directoryEntries.save(directoryArchive, Archive::getFormatFromFilename(directoryArchive));
+
+        ArchiveReader directoryReader(directoryArchive);
+        std::set<std::string> foundFiles;
+        std::set<std::string> foundDirectories;
+        for (auto &entry: directoryReader.getEntries()) {
+            auto path = withoutTrailingSlash(entry.path);
+            if (entry.directory) {
+                check(foundDirectories.insert(path).second, "Duplicate directory " + path);
+            } else {
+                check(foundFiles.insert(path).second, "Duplicate file " + path);
+                auto it = expectedFiles.find(path);
+                check(it != expectedFiles.end(), "Unexpected file " + path);
+                check(directoryReader.readEntry(entry.path) == it->second, path + " does not match");
+            }
+        }
+        check(foundFiles.size() == expectedFiles.size(), "Files are missing from the directory archive");
+        check(foundDirectories == expectedDirectories, "Directories are missing from the directory archive");
+
+        auto extracted = directory / "extracted";
+        std::filesystem::create_directories(extracted);
+        Archive::extractToDisk(directoryArchive, extracted.string());
+        check(std::filesystem::is_directory(extracted / "tree" / "lib" / "empty"), "The empty directory was not extracted");
+    } catch (const std::exception &e) {
+        fprintf(stderr, "%s\n", e.what());
+        std::filesystem::remove_all(directory);
+        return 1;
+    }
+
+    std::filesystem::remove_all(directory);
+    return 0;
+}